@@ -0,0 +1,148 @@
+/**
+ * @file chip_fuzzer.cpp
+ * @brief Coverage-guided fuzzing entry point for the CHIP-8 core (libFuzzer or AFL++).
+ *
+ * Each input is decoded as
+ *
+ *     byte 0         quirk profile (value % 3: VIP, SCHIP, XO-CHIP)
+ *     byte 1         number of frames to run
+ *     2 * frames     16-bit key mask per frame (little endian, bit k = key k held)
+ *     remaining      ROM image loaded at 0x200
+ *
+ * One pristine Chip per quirk profile is built on first use and snapshotted right after
+ * the fonts are loaded. Every iteration restores that snapshot in place instead of
+ * constructing a new Chip, so the hot loop does no heap allocation and no state leaks
+ * between inputs.
+ *
+ * The core is built with CHIP8_CHECKED_ACCESS=1, the same addressing as release builds
+ * plus traps. A MachineFault (stack under/overflow, I-relative access past the end of
+ * memory) is defined ROM behaviour and ends the run; the harness only checks that the
+ * fault names the opcode stored at its PC. Any other exception leaves the harness and is
+ * reported as a crash. Sanitizers catch real memory errors and undefined behaviour.
+ * The incremental state hash is also checked against a full rehash after every run.
+ */
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#include "../src/hardware/chip.h"
+#include "../src/hardware/memory_access.h"
+
+namespace {
+    constexpr int FUZZ_IPF = 10;            // instructions per frame, matches the emulator default
+    constexpr std::size_t HEADER_SIZE = 2;
+
+    struct FuzzTarget {
+        std::shared_ptr<Chip8::Chip> chip;
+        Chip8::Chip::Snapshot pristine;
+    };
+
+    /**
+     * @brief Returns the reusable Chip for a quirk profile, creating it on first use.
+     */
+    FuzzTarget& target_for(Chip8::QuirkProfile profile) {
+        static std::array<std::unique_ptr<FuzzTarget>, 3> targets;
+        std::unique_ptr<FuzzTarget>& target = targets[static_cast<std::size_t>(profile)];
+        if (!target) {
+            target = std::make_unique<FuzzTarget>();
+            target->chip = std::make_shared<Chip8::Chip>();
+            target->chip->set_quirk_profile(profile);
+            target->chip->init_gfx();
+            target->chip->init_instr_dispatcher();
+            target->chip->load_fonts_in_memory();
+            target->chip->save_snapshot(target->pristine);
+        }
+        return *target;
+    }
+
+    void apply_key_mask(Chip8::Chip& chip, uint16_t mask) {
+        for (uint8_t key = 0; key < 16; key++) {
+            if (mask & (1u << key)) {
+                if (chip.is_waiting_for_key() && !chip.is_key_pressed(key))
+                    chip.complete_key_wait(key);
+                chip.add_key_state(key);
+            } else {
+                chip.remove_key_state(key);
+            }
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+    if (size < HEADER_SIZE)
+        return 0;
+
+    const auto profile = static_cast<Chip8::QuirkProfile>(data[0] % 3);
+    const std::size_t frames = data[1];
+    const std::size_t keys_size = frames * 2;
+    if (size < HEADER_SIZE + keys_size)
+        return 0;
+
+    const uint8_t* keys = data + HEADER_SIZE;
+    const uint8_t* rom = keys + keys_size;
+    const std::size_t rom_size = size - HEADER_SIZE - keys_size;
+    if (rom_size == 0 || rom_size > Chip8::Chip::max_rom_size)
+        return 0;
+
+    FuzzTarget& target = target_for(profile);
+    Chip8::Chip& chip = *target.chip;
+    chip.restore_snapshot(target.pristine);
+    chip.load_rom(rom, rom_size);
+
+    try {
+        for (std::size_t frame = 0; frame < frames; frame++) {
+            apply_key_mask(chip, static_cast<uint16_t>(keys[frame * 2] | (keys[frame * 2 + 1] << 8)));
+            for (int i = 0; i < FUZZ_IPF && !chip.is_waiting_for_key(); i++) {
+                chip.cycle();
+            }
+            chip.decrement_timers();
+        }
+    }
+    catch (const Chip8::MachineFault& fault) {
+        // ROM fault trapped by CheckedAccess, see file comment
+        const uint16_t fetched = static_cast<uint16_t>((chip.memory[fault.pc] << 8)
+            | chip.memory[static_cast<uint16_t>(fault.pc + 1)]);
+        if (fault.opcode != fetched)
+            std::abort();   // the trap blamed the wrong instruction
+    }
+
+    uint64_t incremental = chip.state_hash();
+    chip.rehash_state();
+    if (chip.state_hash() != incremental)
+        std::abort();   // a memory or gfx write bypassed write_memory/write_pixel
+    return 0;
+}
+
+#ifdef CHIP8_FUZZ_STANDALONE
+// Replay driver for compilers without libFuzzer: runs every file given on the command line,
+// or stdin when none is given. Under afl-clang-fast the stdin path becomes a persistent loop.
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+#ifndef __AFL_LOOP
+#define __AFL_LOOP(n) (first_pass ? (first_pass = false, true) : false)
+#endif
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            std::ifstream file(argv[i], std::ios::binary);
+            std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+            std::cout << "Ran " << argv[i] << " (" << input.size() << " bytes)" << std::endl;
+        }
+        return 0;
+    }
+
+    [[maybe_unused]] bool first_pass = true;
+    while (__AFL_LOOP(10000)) {
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    return 0;
+}
+#endif
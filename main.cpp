@@ -1,16 +1,32 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <format>
+#include <optional>
+#include <vector>
 #include <SDL2/SDL.h>
 
 #include <SDL2/SDL_timer.h>
 #include "src/hardware/chip.h"
+#include "src/hardware/memory_access.h"
 
 #include <type_traits>
 
 #include "src/Platform.h"
+#include "src/database/rom_database.h"
 
 #include "src/gui/gui.h"
+#include "src/metrics/metrics_exporter.h"
+#include "src/net/netplay.h"
+#include "src/session/session.h"
+#include "src/video/video_recorder.h"
+#include "src/log/log.h"
+
+constexpr int DEFAULT_IPF = 10;    // used when neither the CLI nor the ROM database sets it
+constexpr int MAX_IPF = 1000;      // XO-CHIP games commonly run at 100-1000
+constexpr int DEFAULT_VIDEO_SCALE = 8;
+constexpr int MAX_RUN_AHEAD = 6;   // each frame of run-ahead costs a whole extra emulated frame
 
 template<typename T>
 bool __checkType(const T& value) {
@@ -23,114 +39,548 @@ bool __checkType(const T& value) {
 
 int main(int argc, char *argv[])
 {
-    if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
-        std::cerr << "Error initializing SDL: " << SDL_GetError() << std::endl;
-        return 1;
-    }
+    // Startup phases, printed with --timing. SDL subsystems are only initialized once the
+    // mode is known: none when headless, video + events (+ audio unless --no-audio) otherwise.
+    std::chrono::time_point startup_begin = std::chrono::steady_clock::now();
+    std::chrono::time_point phase_begin = startup_begin;
+    std::vector<std::pair<std::string, std::chrono::microseconds>> startup_phases;
+    auto mark_phase = [&](const std::string& name) {
+        std::chrono::time_point now = std::chrono::steady_clock::now();
+        startup_phases.emplace_back(name, std::chrono::duration_cast<std::chrono::microseconds>(now - phase_begin));
+        phase_begin = now;
+    };
 
     // default values
     std::string rom_path;
-    std::ifstream rom_file;
-    int ipf;
+    bool headless = false;
+    unsigned long headless_frames = 0;
+    bool audio_enabled = true;
+    bool print_timing = false;
+    std::string db_path = Chip8::RomDatabase::DEFAULT_PATH;
+    std::string video_path;
+    Chip8::VideoFormat video_format = Chip8::VideoFormat::Y4M;
+    int video_scale = DEFAULT_VIDEO_SCALE;
+    std::string trace_path;
+    bool debug = false;
+    std::optional<std::pair<int, int>> ipf_range;   // adaptive IPF bounds
+    std::optional<int> target_ips;                  // instructions per second target
+    std::optional<uint64_t> rng_seed;               // CXNN seed, fixed by default
+    std::optional<Chip8::ScaleFilter> scale_filter; // software scaling into the window surface
+    std::optional<Chip8::TerminalGlyphs> terminal_glyphs;   // render to the terminal, no window
+    std::string serve_endpoint;                     // spectator server: <port> or unix:<path>
+    bool serve_input = false;                       // let one spectator drive the keypad
+    bool perf_overlay = false;                      // start with the F3 overlay shown
+    std::optional<Chip8::SpeedControl> speed;       // fast-forward / slow motion, timers stay at 60 Hz
+    unsigned run_ahead = 0;                         // frames shown ahead of the real machine
+    unsigned latency_samples = 0;                   // input-to-photon harness, 0 = off
+    uint8_t latency_key = 0x5;                      // CHIP-8 key it presses
+    std::optional<Chip8::NetplayOptions> netplay_options;  // two-player rollback netplay over UDP
+    std::string metrics_endpoint;                   // Prometheus metrics: <port> or file:<path>
+    std::chrono::seconds metrics_interval = Chip8::MetricsExporter::default_interval;
+    bool metrics_opcodes = false;                   // per-opcode counts, the one per-instruction metric
+    bool intro = false;         // started without a ROM: wait for one to be dropped on the window
+
+    // explicit values always win over the ROM database (also for ROMs dropped later)
+    std::optional<int> cli_ipf;
+    std::optional<Chip8::QuirkProfile> cli_quirks;
 
     try {
-        switch (argc) {
+        switch (std::min(argc, 3)) {
+            case 2:
             case 3: {
-                // CLI mode
-                rom_path = argv[1];
-                rom_file.open(rom_path, std::ios::in | std::ios::binary | std::ios::ate);  // pointing seeker at end
-                ipf = std::stoi(argv[2]);
-
-                if (!rom_file.is_open())
-                    throw std::runtime_error("<rom_path> file could not be opened.");
-                if (rom_file.tellg() > 4096)
-                    throw std::runtime_error("<rom_path> file size is too big for Chip-8 rom");
-                if (rom_file.tellg() < 0)
-                    throw std::runtime_error("<rom_path> file size is negative");
-                if (!__checkType(ipf))
-                    throw std::runtime_error("<ipf> must be a digit");
-                if (ipf < 1 || ipf > 30)
-                    throw std::runtime_error("<ipf> must be a digit between 1 and 30 inclusively");
+                // CLI mode: <rom_path> [ipf] [options]
+                rom_path = argv[1];   // read, looked up and loaded by the Session
+
+                int first_option = 2;
+                if (argc > 2 && std::string(argv[2]).rfind("--", 0) != 0) {
+                    cli_ipf = std::stoi(argv[2]);
+                    first_option = 3;
+                    if (!__checkType(*cli_ipf))
+                        throw std::runtime_error("<ipf> must be a digit");
+                    if (*cli_ipf < 1 || *cli_ipf > MAX_IPF)
+                        throw std::runtime_error(std::format("<ipf> must be a digit between 1 and {} inclusively", MAX_IPF));
+                }
+
+                // options
+                for (int i = first_option; i < argc; i++) {
+                    std::string option = argv[i];
+                    if (option == "--headless" && i + 1 < argc) {
+                        headless = true;
+                        headless_frames = std::stoul(argv[++i]);
+                    }
+                    else if (option == "--no-audio") {
+                        audio_enabled = false;
+                    }
+                    else if (option == "--timing") {
+                        print_timing = true;
+                    }
+                    else if (option == "--quirks" && i + 1 < argc) {
+                        cli_quirks = Chip8::parse_quirk_profile(argv[++i]);
+                        if (!cli_quirks)
+                            throw std::runtime_error("--quirks must be one of vip, schip, xochip");
+                    }
+                    else if (option == "--db" && i + 1 < argc) {
+                        db_path = argv[++i];
+                    }
+                    else if (option == "--record-video" && i + 1 < argc) {
+                        video_path = argv[++i];
+                        std::optional<Chip8::VideoFormat> format = Chip8::video_format_from_path(video_path);
+                        if (!format)
+                            throw std::runtime_error("--record-video file must end in .y4m, .raw, .rgb or .gif");
+                        video_format = *format;
+                    }
+                    else if (option == "--record-scale" && i + 1 < argc) {
+                        video_scale = std::stoi(argv[++i]);
+                    }
+                    else if (option == "--trace" && i + 1 < argc) {
+                        trace_path = argv[++i];
+                    }
+                    else if (option == "--debug") {
+                        debug = true;
+                    }
+                    else if (option == "--ipf-range" && i + 1 < argc) {
+                        std::string range = argv[++i];
+                        std::size_t colon = range.find(':');
+                        if (colon == std::string::npos)
+                            throw std::runtime_error("--ipf-range must be <min>:<max>");
+                        ipf_range = {std::stoi(range.substr(0, colon)), std::stoi(range.substr(colon + 1))};
+                        if (ipf_range->first < 1 || ipf_range->second > MAX_IPF || ipf_range->first > ipf_range->second)
+                            throw std::runtime_error(std::format("--ipf-range bounds must satisfy 1 <= min <= max <= {}", MAX_IPF));
+                    }
+                    else if (option == "--log-level" && i + 1 < argc) {
+                        std::optional<Chip8::LogLevel> level = Chip8::Log::parse_level(argv[++i]);
+                        if (!level)
+                            throw std::runtime_error("--log-level must be one of trace, debug, info, warn, error, off");
+                        Chip8::Log::set_level(*level);
+                    }
+                    else if (option == "--seed" && i + 1 < argc) {
+                        rng_seed = std::stoull(argv[++i], nullptr, 0);  // decimal or 0x hex
+                    }
+                    else if (option == "--scale-filter" && i + 1 < argc) {
+                        scale_filter = Chip8::parse_scale_filter(argv[++i]);
+                        if (!scale_filter)
+                            throw std::runtime_error("--scale-filter must be one of nearest, scale2x, scale3x");
+                    }
+                    else if (option == "--serve" && i + 1 < argc) {
+                        serve_endpoint = argv[++i];
+                    }
+                    else if (option == "--serve-input") {
+                        serve_input = true;
+                    }
+                    else if (option == "--metrics" && i + 1 < argc) {
+                        metrics_endpoint = argv[++i];
+                    }
+                    else if (option == "--metrics-opcodes") {
+                        metrics_opcodes = true;
+                    }
+                    else if (option == "--metrics-interval" && i + 1 < argc) {
+                        metrics_interval = std::chrono::seconds{std::stoi(argv[++i])};
+                        if (metrics_interval.count() < 1)
+                            throw std::runtime_error("--metrics-interval must be at least 1 second");
+                    }
+                    else if (option == "--speed" && i + 1 < argc) {
+                        speed = Chip8::SpeedControl::parse(argv[++i]);
+                        if (!speed)
+                            throw std::runtime_error(std::format("--speed must be between {} and {}, or unlimited",
+                                Chip8::SpeedControl::min_multiplier, Chip8::SpeedControl::max_multiplier));
+                    }
+                    else if (option == "--run-ahead" && i + 1 < argc) {
+                        int frames = std::stoi(argv[++i]);
+                        if (frames < 0 || frames > MAX_RUN_AHEAD)
+                            throw std::runtime_error(std::format("--run-ahead must be between 0 and {}", MAX_RUN_AHEAD));
+                        run_ahead = static_cast<unsigned>(frames);
+                    }
+                    else if (option == "--latency-probe" && i + 1 < argc) {
+                        int samples = std::stoi(argv[++i]);
+                        if (samples < 1)
+                            throw std::runtime_error("--latency-probe needs at least 1 sample");
+                        latency_samples = static_cast<unsigned>(samples);
+                    }
+                    else if (option == "--probe-key" && i + 1 < argc) {
+                        int key = std::stoi(argv[++i], nullptr, 16);
+                        if (key < 0 || key > 0xF)
+                            throw std::runtime_error("--probe-key must be a CHIP-8 key 0-F");
+                        latency_key = static_cast<uint8_t>(key);
+                    }
+                    else if (option == "--netplay" && i + 1 < argc) {
+                        // <local port>:<peer host>:<peer port>
+                        std::string peers = argv[++i];
+                        std::size_t first = peers.find(':');
+                        std::size_t last = peers.rfind(':');
+                        if (first == std::string::npos || first == last)
+                            throw std::runtime_error("--netplay must be <local port>:<peer host>:<peer port>");
+                        int local_port = std::stoi(peers.substr(0, first));
+                        int peer_port = std::stoi(peers.substr(last + 1));
+                        if (local_port < 1 || local_port > 65535 || peer_port < 1 || peer_port > 65535)
+                            throw std::runtime_error("--netplay ports must be between 1 and 65535");
+                        if (!netplay_options)
+                            netplay_options.emplace();
+                        netplay_options->local_port = static_cast<uint16_t>(local_port);
+                        netplay_options->peer_host = peers.substr(first + 1, last - first - 1);
+                        netplay_options->peer_port = static_cast<uint16_t>(peer_port);
+                    }
+                    else if (option == "--net-input-delay" && i + 1 < argc) {
+                        int frames = std::stoi(argv[++i]);
+                        if (frames < 0 || frames > static_cast<int>(Chip8::Netplay::max_input_delay))
+                            throw std::runtime_error(std::format("--net-input-delay must be between 0 and {}", Chip8::Netplay::max_input_delay));
+                        if (!netplay_options)
+                            netplay_options.emplace();
+                        netplay_options->input_delay = static_cast<unsigned>(frames);
+                    }
+                    else if (option == "--net-delay" && i + 1 < argc) {
+                        int delay = std::stoi(argv[++i]);
+                        if (delay < 0 || delay > 1000)
+                            throw std::runtime_error("--net-delay must be between 0 and 1000 ms");
+                        if (!netplay_options)
+                            netplay_options.emplace();
+                        netplay_options->added_delay = std::chrono::milliseconds{delay};
+                    }
+                    else if (option == "--net-loss" && i + 1 < argc) {
+                        int percent = std::stoi(argv[++i]);
+                        if (percent < 0 || percent > 90)
+                            throw std::runtime_error("--net-loss must be between 0 and 90 percent");
+                        if (!netplay_options)
+                            netplay_options.emplace();
+                        netplay_options->loss_percent = static_cast<unsigned>(percent);
+                    }
+                    else if (option == "--perf-overlay") {
+                        perf_overlay = true;
+                    }
+                    else if (option == "--terminal" && i + 1 < argc) {
+                        terminal_glyphs = Chip8::parse_terminal_glyphs(argv[++i]);
+                        if (!terminal_glyphs)
+                            throw std::runtime_error("--terminal must be one of braille, halfblock");
+                    }
+                    else if (option == "--ips" && i + 1 < argc) {
+                        target_ips = std::stoi(argv[++i]);
+                        if (*target_ips < 1 || *target_ips > MAX_IPF * 60)
+                            throw std::runtime_error(std::format("--ips must be between 1 and {}", MAX_IPF * 60));
+                    }
+                    else {
+                        throw std::runtime_error(std::format("Unknown or incomplete option {}", option));
+                    }
+                }
+                if (ipf_range && target_ips)
+                    throw std::runtime_error("--ipf-range and --ips cannot be combined");
+                if (terminal_glyphs && (headless || debug))
+                    throw std::runtime_error("--terminal cannot be combined with --headless or --debug");
+                if (serve_input && serve_endpoint.empty())
+                    throw std::runtime_error("--serve-input needs --serve");
+                if (latency_samples && (headless || terminal_glyphs || debug))
+                    throw std::runtime_error("--latency-probe needs the window, not --headless, --terminal or --debug");
+                if (latency_samples && (ipf_range || target_ips))
+                    throw std::runtime_error("--latency-probe needs a fixed IPF, not --ipf-range or --ips");
+                if (netplay_options && netplay_options->peer_host.empty())
+                    throw std::runtime_error("--net-input-delay, --net-delay and --net-loss need --netplay");
+                if (netplay_options && (headless || debug || latency_samples))
+                    throw std::runtime_error("--netplay needs a display, not --headless, --debug or --latency-probe");
+                if (netplay_options && (ipf_range || target_ips || speed || run_ahead))
+                    throw std::runtime_error("--netplay needs a fixed IPF at 1x, not --ipf-range, --ips, --speed or --run-ahead");
+                if (netplay_options && serve_input)
+                    throw std::runtime_error("--netplay cannot be combined with --serve-input");
+                if (run_ahead && headless)
+                    throw std::runtime_error("--run-ahead needs a display, it has no effect with --headless");
+                if (speed && headless)
+                    throw std::runtime_error("--speed has no effect with --headless, which always runs unthrottled");
+                if (metrics_opcodes && metrics_endpoint.empty())
+                    throw std::runtime_error("--metrics-opcodes needs --metrics");
+                if (headless && headless_frames == 0)
+                    throw std::runtime_error("--headless <frames> must run at least one frame");
                 break;
             }
             case 1: {
-                // gui mode
-                rom_path = "placeholder_text"; // REMOVE LATER
-                ipf = 10; // placeholder ipf   // REMOVE LATER
-
-                std::unique_ptr<Chip8::Gui> intro_gui = std::make_unique<Chip8::Gui>
-                ("SELECT_YOUR_ROM",621,
-                457, true);
-
-                // intro SDL display loop
-                SDL_Event e;
-                bool intro_quit = false;
-                while (!intro_quit) {
-                    while (SDL_PollEvent(&e)) {
-                        if (e.type == SDL_QUIT)
-                            intro_quit = true;
-                    }
-                }
+                // gui mode: the window opens on the intro screen and the session loads
+                // whatever ROM is dropped on it
+                intro = true;
                 break;
             }
             default: {
-                throw std::runtime_error("Incorrect number of arguments. Correct usage: ./chip-8-emulator <ROM_file> <ipf>");
+                throw std::runtime_error("Incorrect number of arguments. Correct usage: ./chip-8-emulator <ROM_file> [ipf] [--headless <frames>] [--quirks vip|schip|xochip] [--db <programs.json>] [--no-audio] [--timing] [--record-video <file.y4m|.raw|.gif>] [--record-scale <n>] [--trace <file>] [--debug] [--ipf-range <min>:<max>] [--ips <n>] [--seed <n>] [--log-level <level>] [--scale-filter nearest|scale2x|scale3x] [--terminal braille|halfblock] [--serve <port|unix:path>] [--serve-input] [--perf-overlay] [--speed <0.25-16|unlimited>] [--run-ahead <frames>] [--latency-probe <samples>] [--probe-key <0-F>] [--netplay <port>:<peer host>:<port>] [--net-input-delay <frames>] [--net-delay <ms>] [--net-loss <percent>] [--metrics <port|file:path>] [--metrics-interval <s>] [--metrics-opcodes]");
             }
         }
-        std::cout << "-------------------------------------------------------" << std::endl;
-        std::cout << std::format("Running {}",argv[0]) << std::endl;
-        std::cout << std::format("---> ROM: {}", rom_path) << std::endl;
-        std::cout << std::format("---> ipf: {}", ipf) << std::endl;
-        std::cout << "-------------------------------------------------------" << std::endl;
     }
     catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
         return 0;
     }
 
+    mark_phase("arguments");
+
     // Prepare the hardware and gui layer -> dependency injection into platform layer
     std::shared_ptr<Chip8::Chip> chip8_hardware = std::make_shared<Chip8::Chip>(); // DONT FORGET TO ADD WEAK_PTRS
 
-    // Initialize hardware functionalities
-    chip8_hardware->init_instr_dispatcher();
+    // Initialize hardware functionalities; the quirk profile is the ROM's, set when it loads
+    chip8_hardware->set_quirk_profile(cli_quirks.value_or(Chip8::QuirkProfile::SCHIP));
     chip8_hardware->init_gfx();
+    if (rng_seed)
+        chip8_hardware->seed_random(*rng_seed);
 
-    // Create a game GUI and the platform
-    std::shared_ptr<Chip8::Gui> game_gui = std::make_shared<Chip8::Gui>("CHIP-8",2000,2000, false);
+    // Create the platform; the game GUI is attached once video is up (never when headless)
     std::unique_ptr<Chip8::Platform> chip8_platform =
-        std::make_unique<Chip8::Platform>(chip8_hardware, game_gui, ipf);
+        std::make_unique<Chip8::Platform>(chip8_hardware, nullptr, cli_ipf.value_or(DEFAULT_IPF));
+    if (speed)
+        chip8_platform->set_speed(*speed);
+    chip8_platform->set_run_ahead(run_ahead);
+
+    // Every ROM goes through the session, the one on the command line and the ones dropped
+    // later alike: ROM database settings, CLI overrides on top, recompiled code if it matches
+    Chip8::SessionOptions session_options{DEFAULT_IPF, MAX_IPF, cli_ipf, cli_quirks, ipf_range, target_ips,
+        !debug && trace_path.empty() && latency_samples == 0 && !netplay_options};
+    Chip8::Session session(chip8_hardware, *chip8_platform, db_path, session_options);
+    mark_phase("ROM database");
+
+    std::shared_ptr<Chip8::VideoRecorder> video_recorder;
+    if (!video_path.empty()) {
+        try {
+            video_recorder = std::make_shared<Chip8::VideoRecorder>(video_path, video_format, video_scale);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        chip8_platform->attach_recorder(video_recorder);
+    }
+
+    if (!serve_endpoint.empty()) {
+        try {
+            chip8_platform->attach_spectator_server(std::make_shared<Chip8::SpectatorServer>(serve_endpoint, serve_input));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    std::unique_ptr<Chip8::MetricsExporter> metrics_exporter;
+    if (!metrics_endpoint.empty()) {
+        try {
+            metrics_exporter = std::make_unique<Chip8::MetricsExporter>(chip8_platform->metrics(), metrics_endpoint, metrics_interval);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        chip8_platform->count_opcodes(metrics_opcodes);
+    }
+
+    // Execution trace: dumped on exit, on F12 and if the process crashes
+    std::shared_ptr<Chip8::TraceBuffer> trace_buffer;
+    if (!trace_path.empty()) {
+        trace_buffer = std::make_shared<Chip8::TraceBuffer>();
+        trace_buffer->install_crash_handler(trace_path);
+        chip8_hardware->attach_tracer(trace_buffer);
+        chip8_platform->set_trace_path(trace_path);
+    }
+
+    // Debugger console on stdin; costs nothing per instruction until a command is typed
+    std::shared_ptr<Chip8::Debugger> debugger;
+    if (debug) {
+        debugger = std::make_shared<Chip8::Debugger>(chip8_hardware);
+        chip8_platform->attach_debugger(debugger);
+        debugger->start_console();
+    }
+
+    mark_phase("chip + platform");
 
     // Initialize platform layer
-    chip8_platform->add_subsystem(SDL_INIT_VIDEO);
-    chip8_platform->add_subsystem(SDL_INIT_EVENTS);
+    if (terminal_glyphs) {
+        // no window: SDL only for sound
+        if (audio_enabled) {
+            chip8_platform->add_subsystem(SDL_INIT_AUDIO);
+            chip8_platform->init_sdl();
+        }
+    }
+    else if (!headless) {
+        chip8_platform->add_subsystem(SDL_INIT_VIDEO);
+        chip8_platform->add_subsystem(SDL_INIT_EVENTS);
+        if (audio_enabled)
+            chip8_platform->add_subsystem(SDL_INIT_AUDIO);
 
-    std::cout << ">>> Added SDL Video and Events Subsystems" << std::endl;
-    chip8_platform->add_subsystem(SDL_INIT_AUDIO);
+        if (chip8_platform->init_sdl() != 0) {
+            std::cerr << "Error initializing SDL: " << SDL_GetError() << std::endl;
+            return 1;
+        }
+        std::cout << ">>> Initialized Video and Events." << std::endl;
+        mark_phase("SDL video + events");
 
-    chip8_platform->init_sdl();
-    std::cout << ">>> Initialized Video and Events." << std::endl;
+        // window and renderer creation overlaps with the audio device opening on its worker thread
+        chip8_platform->attach_gui(std::make_shared<Chip8::Gui>("CHIP-8",2000,2000, intro, scale_filter));
+        chip8_platform->set_perf_overlay_visible(perf_overlay);
+        mark_phase("window + renderer");
+    }
 
     // Load the Fonts
     chip8_hardware->load_fonts_in_memory();
     std::cout << ">>> Loaded Fonts in Memory!" << std::endl;
 
-    // Load the ROM
-    if (chip8_hardware->load_rom(&rom_file) != 0) {
-        std::cout << std::format("The file {} did not load properly.\n", rom_path) << std::endl;
-        return -1;
+    // The audio device must be open before a load drops the previous ROM's sound
+    chip8_platform->wait_for_audio();
+    mark_phase("fonts + wait for audio");
+
+    // Load the ROM (the intro screen waits for one to be dropped instead)
+    if (!intro) {
+        Chip8::LoadedRom loaded{};
+        try {
+            loaded = session.load(rom_path);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+
+        std::cout << "-------------------------------------------------------" << std::endl;
+        std::cout << std::format("Running {}",argv[0]) << std::endl;
+        std::cout << std::format("---> ROM: {}", loaded.path) << std::endl;
+        if (loaded.settings)
+            std::cout << std::format("---> database: {} ({})", loaded.settings->title,
+                Chip8::RomDatabase::platform_name(loaded.settings->platform)) << std::endl;
+        if (target_ips)
+            std::cout << std::format("---> ips: {}", *target_ips) << std::endl;
+        else if (ipf_range)
+            std::cout << std::format("---> ipf: {} (adaptive {}..{})", loaded.ipf, ipf_range->first, ipf_range->second) << std::endl;
+        else
+            std::cout << std::format("---> ipf: {}", loaded.ipf) << std::endl;
+        std::cout << std::format("---> quirks: {}", Chip8::quirk_profile_name(loaded.quirks)) << std::endl;
+        // Recompiled ROM (CHIP8_AOT_SOURCE builds); tracing and debugging need the interpreter
+        if (loaded.recompiled)
+            std::cout << "---> running recompiled code" << std::endl;
+        else if (Chip8::Aot::compiled_program() && session_options.allow_aot)
+            std::cout << "---> recompiled code is for another ROM or quirk profile, interpreting" << std::endl;
+        std::cout << "-------------------------------------------------------" << std::endl;
+    }
+    mark_phase("ROM load");
+
+    if (print_timing) {
+        std::cout << "Startup timing:" << std::endl;
+        for (const auto& [name, duration] : startup_phases) {
+            std::cout << std::format("    {:<28}{:>10.3f} ms", name, duration.count() / 1000.0) << std::endl;
+        }
+        if (audio_enabled && !headless) {
+            std::cout << std::format("    {:<28}{:>10.3f} ms", "(audio worker thread)",
+                chip8_platform->audio_startup_time().count() / 1000.0) << std::endl;
+        }
+        std::chrono::duration<double, std::milli> total = std::chrono::steady_clock::now() - startup_begin;
+        std::cout << std::format("    {:<28}{:>10.3f} ms", "total", total.count()) << std::endl;
     }
-    rom_file.close();   // Closes the file after loading
 
     // START THE GAME
     std::cout << ">>> CHIP-8 Initializing...\n" << std::endl;
 
-    bool running = true;
-    while (running && chip8_platform->check_valid()) {
-        chip8_platform->run_frame();
+    // A ROM fault trapped by a CHIP8_CHECKED_ACCESS build ends the run through the normal teardown
+    int exit_code = 0;
+    auto report_fault = [&exit_code](const Chip8::MachineFault& fault) {
+        std::cerr << std::format("Error: ROM fault, {}", fault.what()) << std::endl;
+        exit_code = 1;
+    };
+
+    if (headless) {
+        // Unthrottled run for a fixed number of frames, reports the achieved frame rate
+        std::chrono::time_point start = std::chrono::steady_clock::now();
+        unsigned long frames = 0;
+        try {
+            while (frames < headless_frames && chip8_platform->check_valid()) {
+                chip8_platform->run_frame();
+                frames++;
+            }
+        }
+        catch (const Chip8::MachineFault& fault) {
+            report_fault(fault);
+        }
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        std::cout << std::format(">>> Headless: {} frames in {:.3f}s ({:.0f} fps)",
+            frames, seconds.count(), frames / seconds.count()) << std::endl;
+        std::cout << std::format(">>> State hash: {:016x}", chip8_hardware->state_hash()) << std::endl;
+        if (ipf_range)
+            std::cout << std::format(">>> Adaptive ipf settled at {}", chip8_platform->ipf_controller().ipf()) << std::endl;
+    }
+
+    // Last, so the startup output above stays on the normal screen
+    if (terminal_glyphs)
+        chip8_platform->attach_terminal(std::make_shared<Chip8::TerminalGui>(*terminal_glyphs));
+
+    // Synthetic presses start once frames are about to run
+    std::shared_ptr<Chip8::LatencyProbe> latency_probe;
+    if (latency_samples) {
+        latency_probe = std::make_shared<Chip8::LatencyProbe>(latency_key, latency_samples);
+        try {
+            chip8_platform->attach_latency_probe(latency_probe);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // Both players start from the freshly loaded ROM; frames only run once the peer answers
+    std::shared_ptr<Chip8::Netplay> netplay;
+    if (netplay_options) {
+        try {
+            netplay = std::make_shared<Chip8::Netplay>(*netplay_options,
+                Chip8::Netplay::sync_value(chip8_hardware->state_hash(),
+                    static_cast<unsigned>(session.current()->ipf), session.current()->quirks));
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        chip8_platform->attach_netplay(netplay);
+    }
+
+    // ROMs dropped on the window replace the running one without reopening anything
+    bool running = !headless;
+    while (running && !chip8_platform->should_quit && !(latency_probe && latency_probe->finished())) {
+        if (std::optional<std::string> dropped = chip8_platform->take_dropped_file()) {
+            try {
+                Chip8::LoadedRom loaded = session.load(*dropped);
+                std::cout << std::format(">>> Switched to {} ({}, ipf {}) in {:.3f} ms", loaded.path,
+                    loaded.settings ? loaded.settings->title : "not in database", loaded.ipf,
+                    loaded.load_time.count() / 1000.0) << std::endl;
+            }
+            catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+        }
+
+        try {
+            if (chip8_hardware->get_rom_loaded())
+                chip8_platform->run_frame();
+            else
+                chip8_platform->idle_frame();
+        }
+        catch (const Chip8::MachineFault& fault) {
+            report_fault(fault);
+            break;
+        }
+    }
+
+    chip8_platform->attach_terminal(nullptr);   // back to the normal screen before the summary
+
+    if (latency_probe) {
+        chip8_platform->attach_latency_probe(nullptr);
+        std::cout << latency_probe->report();
+    }
+
+    if (netplay) {
+        chip8_platform->attach_netplay(nullptr);
+        if (!netplay->error().empty())
+            std::cerr << "Error: " << netplay->error() << std::endl;
+        std::cout << netplay->summary();
+        netplay.reset();    // says goodbye to the peer
+    }
+
+    if (video_recorder) {
+        video_recorder->finish();   // drains the encoder queue
+        std::cout << std::format(">>> Recorded {} frames to {}", video_recorder->frames_encoded(), video_path) << std::endl;
+    }
+
+    if (trace_buffer && trace_buffer->dump(trace_path)) {
+        std::cout << std::format(">>> Wrote execution trace ({} instructions) to {}", trace_buffer->total(), trace_path) << std::endl;
     }
 
+    metrics_exporter.reset();   // last file write, before logging stops
+    Chip8::Log::shutdown();     // writes out whatever is still queued
     std::cout << "...Terminated CHIP-8\n" << std::endl;
 
     // End of all SDL subsystems + destruct layer
-    return 0;
+    return exit_code;
 }
\ No newline at end of file
@@ -1,37 +1,44 @@
 #include "Platform.h"
 
+#include <algorithm>
+#include <cmath>
 #include <format>
-#include <iostream>
+#include <stdexcept>
 #include <thread>
 #include <map>
 
 #include <SDL.h>
 
 #include "SDL.h"
+#include "log/log.h"
 
 namespace Chip8 {
-    Platform::Platform(std::shared_ptr<Chip8::Chip> chip8_instance, std::shared_ptr<Gui>
-    gui_instance, unsigned ipf) :  // initialize list and kep mappings
-    sdl_subsystems_(std::make_unique<std::vector<uint32_t>>()),
-    key_mapping(
-        std::make_unique<std::map<uint8_t, uint8_t>>(
-            std::initializer_list<std::pair<const uint8_t, uint8_t>>{
+    namespace {
+        std::map<SDL_Keycode, uint8_t> default_key_mapping() {
+            return {
                 {  '1', 0x1 }, {  '2', 0x2 }, {  '3', 0x3 }, {  '4', 0xC },
                 { 'q', 0x4 }, { 'w', 0x5 }, { 'e', 0x6 }, { 'r', 0xD },
                 { 'a', 0x7 }, { 's', 0x8 }, { 'd', 0x9 }, { 'f', 0xE },
                 { 'z', 0xA }, { 'x', 0x0 }, { 'c', 0xB }, { 'v', 0xF }
-            }
-        )
-    ),
+            };
+        }
+    }
+
+    Platform::Platform(std::shared_ptr<Chip8::Chip> chip8_instance, std::shared_ptr<Gui>
+    gui_instance, unsigned ipf) :  // initialize list and kep mappings
+    sdl_subsystems_(std::make_unique<std::vector<uint32_t>>()),
+    key_mapping(std::make_unique<std::map<SDL_Keycode, uint8_t>>(default_key_mapping())),
     chip8_{ chip8_instance },
-    gui_ { gui_instance }
+    gui_ { gui_instance },
+    ipf_controller_{ IpfController::fixed(ipf) }
     {
+        frame_metrics_ = &metrics_.make_shard();
         if (!chip8_) {
-            std::cerr << "Platform: Invalid instantiation of Platform Layer\n" << std::endl;
+            LOG_ERROR(PLATFORM, "invalid instantiation of the platform layer (no chip)");
             return;
         }
         if (ipf < 0) {
-            std::cerr << "Platform: Invalid IPF (Instructions Per Frame) value\n" << std::endl;
+            LOG_ERROR(PLATFORM, "invalid IPF (instructions per frame) value");
             return;
         }
         chip8_->init_instr_dispatcher();
@@ -40,22 +47,319 @@ namespace Chip8 {
     }
 
     Platform::~Platform() {
+        wait_for_audio();
+        if (audio_device != 0) SDL_CloseAudioDevice(audio_device);
         for (uint32_t subsystem : *(this->sdl_subsystems_)) {
             SDL_QuitSubSystem(subsystem);
         }
         SDL_Quit(); // Gui has proper destructor ~Gui() and Chip is smart pointers = safe destruction
     }
 
+    /**
+     * @brief Initializes only the SDL subsystems registered with add_subsystem.
+     *
+     * Video and events are brought up on the calling thread, since windows must be created
+     * there. Audio (driver probing and opening the device are the slowest part of startup)
+     * is initialized on a worker thread; call wait_for_audio() before running frames.
+     *
+     * @return 0 on success, -1 if a main-thread subsystem failed to start.
+     */
     int Platform::init_sdl(void)
     {
+        bool wants_audio = false;
         for (uint32_t subsystem : *(this->sdl_subsystems_)) {
+            if (subsystem == SDL_INIT_AUDIO) {
+                wants_audio = true;
+                continue;
+            }
             if (SDL_InitSubSystem(subsystem) != 0) return -1;
         }
 
-        init_sdl_audio();
+        if (wants_audio) {
+            audio_ready_ = std::async(std::launch::async, [this]() {
+                std::chrono::time_point start = std::chrono::steady_clock::now();
+                int status = (SDL_InitSubSystem(SDL_INIT_AUDIO) == 0) ? init_sdl_audio() : -1;
+                audio_startup_time_ = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start);
+                return status;
+            });
+        }
         return 0;
     }
 
+    /**
+     * @brief Attaches the game window once the video subsystem is up.
+     *
+     * @param gui_instance Gui to render into (nullptr to run headless).
+     */
+    void Platform::attach_gui(std::shared_ptr<Gui> gui_instance) {
+        gui_ = std::move(gui_instance);
+    }
+
+    /**
+     * @brief Renders to the terminal and reads keys from it, for hosts without a display.
+     *
+     * Used instead of a Gui; frames are paced exactly like windowed runs.
+     *
+     * @param terminal Terminal backend (nullptr to detach).
+     */
+    void Platform::attach_terminal(std::shared_ptr<TerminalGui> terminal) {
+        terminal_ = std::move(terminal);
+        terminal_key_hold_.fill(0);
+    }
+
+    /**
+     * @brief Routes execution through a debugger (breakpoints, watchpoints, stepping).
+     *
+     * @param debugger Debugger consulted each frame (nullptr to detach).
+     */
+    void Platform::attach_debugger(std::shared_ptr<Debugger> debugger) {
+        debugger_ = std::move(debugger);
+    }
+
+    /**
+     * @brief Debugger variant of the instruction loop of run_frame.
+     *
+     * Only used while the debugger is engaged, so the plain loop stays free of checks.
+     */
+    void Platform::run_debug_cycles() {
+        debugger_->process_commands();
+        if (gui_) read_input();     // keep the window responsive while paused
+
+        for (unsigned i = 0; i < ipf_; ++i) {
+            if (i > 0 && gui_) read_input();
+            if (chip8_->is_waiting_for_key()) continue;
+            if (debugger_->stop_before(chip8_->program_ctr)) break;
+            chip8_->cycle();
+            debugger_->after_cycle();
+        }
+    }
+
+    void Platform::set_trace_path(const std::string& path) {
+        trace_path_ = path;
+    }
+
+    /**
+     * @brief Runs the loaded ROM through code linked in from chip8_recompile.
+     *
+     * The program must have been generated from the loaded ROM with the active quirk profile.
+     *
+     * @param program Compiled program, nullptr to go back to the interpreter.
+     */
+    void Platform::attach_aot(const Aot::Program* program) {
+        aot_ = program;
+        aot_invalidated_ = false;
+    }
+
+    /**
+     * @brief Drops everything the previous ROM left in the platform before another one
+     * is loaded into the same Chip; the window, textures and audio device stay open.
+     *
+     * Key bindings go back to the hex keypad, recompiled code is detached, host-side key
+     * holds are forgotten and the audio callback is silenced with its XO-CHIP pattern
+     * cleared. IPF is set separately with set_ipf_controller.
+     */
+    void Platform::reset_for_new_rom() {
+        *key_mapping = default_key_mapping();
+        attach_aot(nullptr);
+        terminal_key_hold_.fill(0);
+        remote_keys_ = 0;
+
+        if (curr_audio_data) {
+            SDL_LockAudioDevice(audio_device);
+            curr_audio_data->tone_on = false;
+            curr_audio_data->pattern_on = false;
+            curr_audio_data->pattern.fill(0);
+            curr_audio_data->pattern_pos = 0.0;
+            curr_audio_data->phase = 0.0;
+            SDL_UnlockAudioDevice(audio_device);
+        }
+    }
+
+    /**
+     * @brief The ROM file dropped on the window since the last call, if any.
+     */
+    std::optional<std::string> Platform::take_dropped_file() {
+        std::optional<std::string> file = std::move(dropped_file_);
+        dropped_file_.reset();
+        return file;
+    }
+
+    /**
+     * @brief One frame with nothing loaded: keeps the window responsive and shows the
+     * intro background until a ROM is dropped on it.
+     */
+    void Platform::idle_frame() {
+        if (gui_) {
+            read_input();
+            gui_->present_intro();
+        }
+        std::this_thread::sleep_for(cycle_period);
+    }
+
+    void Platform::set_perf_overlay_visible(bool visible) {
+        perf_visible_ = visible;
+    }
+
+    void Platform::set_speed(const SpeedControl& speed) {
+        speed_ = speed;
+    }
+
+    /**
+     * @brief Enables run-ahead: every displayed frame is emulated this many frames past
+     * the real one with the keys held now, then the machine is rolled back.
+     *
+     * Hides the input lag ROMs have built in (reacting to a key only on the next frame or
+     * later) at the cost of emulating 1 + frames frames per frame.
+     *
+     * @param frames Frames to look ahead, 0 turns it off.
+     */
+    void Platform::set_run_ahead(unsigned frames) {
+        run_ahead_frames_ = frames;
+    }
+
+    /**
+     * @brief Measures input-to-photon latency with synthetic presses, see LatencyProbe.
+     *
+     * Needs the window (presses go through the SDL event queue) and the interpreter: the
+     * probe compares the framebuffer after every instruction slot.
+     */
+    void Platform::attach_latency_probe(std::shared_ptr<LatencyProbe> probe) {
+        probe_ = std::move(probe);
+        if (!probe_)
+            return;
+        auto host_key = std::find_if(key_mapping->begin(), key_mapping->end(),
+            [this](const auto& mapping) { return mapping.second == probe_->chip8_key(); });
+        if (host_key == key_mapping->end())
+            throw std::runtime_error(std::format("no host key is mapped to CHIP-8 key {:X}", probe_->chip8_key()));
+        probe_->start(host_key->first);
+    }
+
+    /**
+     * @brief Plays against a peer over UDP, see Netplay. From now on this player's keys
+     * go to the peer, and the Chip only sees both players' keys at frame boundaries.
+     *
+     * Needs a fixed IPF and the interpreter: both machines must run exactly the same
+     * instructions every frame.
+     *
+     * @param netplay Session bound to the peer (nullptr to detach).
+     */
+    void Platform::attach_netplay(std::shared_ptr<Netplay> netplay) {
+        netplay_ = std::move(netplay);
+        netplay_keys_ = 0;
+        if (netplay_ && !netplay_snapshots_)
+            netplay_snapshots_ = std::make_unique<std::array<Chip::Snapshot, Netplay::max_rollback>>();
+    }
+
+    /**
+     * @brief Speed hotkeys: F5 slower, F6 faster, F7 back to 1x, F8 unlimited on/off.
+     */
+    void Platform::change_speed(SDL_Keycode key) {
+        switch (key) {
+            case SDLK_F5: speed_.slower(); break;
+            case SDLK_F6: speed_.faster(); break;
+            case SDLK_F7: speed_.set(1.0); break;
+            case SDLK_F8:
+                if (speed_.unlimited()) speed_.set(1.0);
+                else speed_.set_unlimited();
+                break;
+            default: return;
+        }
+        LOG_INFO(PLATFORM, "speed {}", speed_.name());
+    }
+
+    /**
+     * @brief Counters and histograms of this run, for an exporter to read from any thread.
+     */
+    Metrics& Platform::metrics() {
+        return metrics_;
+    }
+
+    /**
+     * @brief Turns per-opcode counting in Chip::cycle on or off.
+     *
+     * Recompiled (AOT) frames do not go through cycle and are not broken down by opcode.
+     */
+    void Platform::count_opcodes(bool enabled) {
+        chip8_->opcode_counts = enabled ? frame_metrics_->enable_opcode_counts() : nullptr;
+    }
+
+    /**
+     * @brief Replaces the fixed IPF given to the constructor (adaptive or IPS target modes).
+     */
+    void Platform::set_ipf_controller(const IpfController& controller) {
+        ipf_controller_ = controller;
+        ipf_ = ipf_controller_.ipf();
+    }
+
+    const IpfController& Platform::ipf_controller() const {
+        return ipf_controller_;
+    }
+
+    /**
+     * @brief Records every frame from now on, windowed or headless.
+     *
+     * @param recorder Recorder fed once per frame (nullptr stops recording).
+     */
+    void Platform::attach_recorder(std::shared_ptr<VideoRecorder> recorder) {
+        recorder_ = std::move(recorder);
+    }
+
+    /**
+     * @brief Streams every frame to spectators and takes keys from their controller.
+     *
+     * @param server Running spectator server (nullptr to detach).
+     */
+    void Platform::attach_spectator_server(std::shared_ptr<SpectatorServer> server) {
+        spectators_ = std::move(server);
+        remote_keys_ = 0;
+    }
+
+    /**
+     * @brief Applies the controlling spectator's key mask, if it changed.
+     *
+     * Only keys that changed are touched, so the local keyboard keeps working. A remote
+     * release completes an FX0A wait, like an SDL key-up does.
+     */
+    void Platform::apply_remote_keys() {
+        std::optional<uint16_t> mask = spectators_->take_key_mask();
+        if (!mask || *mask == remote_keys_)
+            return;
+
+        for (uint8_t key = 0; key < 16; key++) {
+            const bool was_down = (remote_keys_ >> key) & 1u;
+            const bool down = (*mask >> key) & 1u;
+            if (down && !was_down) {
+                chip8_->add_key_state(key);
+            }
+            else if (!down && was_down) {
+                if (chip8_->waiting_reg != 0xFF)
+                    chip8_->complete_key_wait(key);
+                chip8_->remove_key_state(key);
+            }
+        }
+        remote_keys_ = *mask;
+    }
+
+    /**
+     * @brief Blocks until the audio worker started by init_sdl has finished.
+     *
+     * @return 0 if audio is ready or was never requested, -1 if it failed (the game runs muted).
+     */
+    int Platform::wait_for_audio() {
+        if (!audio_ready_.valid()) return 0;
+        int status = audio_ready_.get();
+        if (status != 0) {
+            LOG_WARN(AUDIO, "audio unavailable, running without sound");
+            curr_audio_data.reset();
+        }
+        return status;
+    }
+
+    std::chrono::microseconds Platform::audio_startup_time() const {
+        return audio_startup_time_;
+    }
+
     int Platform::init_sdl_audio(void)
     {
         curr_audio_data = std::make_unique<AudioData>();
@@ -66,6 +370,11 @@ namespace Chip8 {
         curr_audio_data->tone_on     = false;
         curr_audio_data->phase_increment =
             (2.0 * M_PI * curr_audio_data->frequency) / curr_audio_data->sample_rate;
+        curr_audio_data->pattern.fill(0);
+        curr_audio_data->pattern_on  = false;
+        curr_audio_data->pattern_pos = 0.0;
+        curr_audio_data->pattern_step = 0.0;
+        curr_audio_data->metrics     = &metrics_.make_shard();
 
         want_audio_spec = std::make_unique<SDL_AudioSpec>();
         want_audio_spec->freq = curr_audio_data->sample_rate;
@@ -87,11 +396,11 @@ namespace Chip8 {
         this->have_audio_spec = std::make_unique<SDL_AudioSpec>(have);
 
         if (dev == 0) {
-            std::cerr << "SDL_OpenDeviceError" << SDL_GetError();
-            SDL_Quit();
+            LOG_ERROR(AUDIO, "SDL_OpenAudioDevice failed: {}", SDL_GetError());
             return -1;
         }
 
+        audio_device = dev;
         SDL_PauseAudioDevice(dev, 0);
         return 0;
     }
@@ -102,7 +411,7 @@ namespace Chip8 {
             sdl_subsystems_->begin(),
             sdl_subsystems_->end(),
             subsystem_code
-            ) != sdl_subsystems_->end()) {    // If code is not already in subsystems
+            ) == sdl_subsystems_->end()) {    // If code is not already in subsystems
             sdl_subsystems_->push_back(subsystem_code);
             return 0;
         }
@@ -121,6 +430,19 @@ namespace Chip8 {
                     SDL_Quit();
                     should_quit = true;
                 }
+                if (this->curr_key_input_event.key.keysym.sym == SDLK_F3) {
+                    perf_visible_ = !perf_visible_;
+                }
+                if (!netplay_) {
+                    change_speed(this->curr_key_input_event.key.keysym.sym);    // both sides run at 1x
+                }
+                if (this->curr_key_input_event.key.keysym.sym == SDLK_F12 && chip8_->get_tracer()) {
+                    if (chip8_->get_tracer()->dump(trace_path_))
+                        LOG_INFO(PLATFORM, "dumped execution trace to {}", trace_path_);
+                }
+                if (probe_ && probe_->is_probe_press(this->curr_key_input_event.key.keysym.sym)) {
+                    start_probe_sample();   // before the key is applied: the counterfactual runs without it
+                }
                 if (is_valid_key(this->curr_key_input_event.key.keysym)) {
                     this->add_key_state(this->curr_key_input_event.key.keysym);
                 }
@@ -129,7 +451,7 @@ namespace Chip8 {
             case SDL_KEYUP:
                 // If key is off then take the key off
                 if (is_valid_key(curr_key_input_event.key.keysym)) {
-                    if (chip8_->waiting_reg != 0xFF) {
+                    if (chip8_->waiting_reg != 0xFF && !netplay_) {
                         chip8_->complete_key_wait(
                             key_mapping->find(curr_key_input_event.key.keysym.sym)->second
                         );
@@ -138,6 +460,15 @@ namespace Chip8 {
                 }
                 break;
 
+            case SDL_DROPFILE:
+                // picked up by the session between frames (hot-swap); netplay peers must keep the same ROM
+                if (netplay_)
+                    LOG_WARN(PLATFORM, "ignoring {}: cannot switch ROMs during netplay", curr_key_input_event.drop.file);
+                else
+                    dropped_file_ = std::string(curr_key_input_event.drop.file);
+                SDL_free(curr_key_input_event.drop.file);
+                break;
+
             case SDL_QUIT:
                 // Prompts SDL to close the window and program
                 SDL_Quit();
@@ -153,21 +484,86 @@ namespace Chip8 {
         return 0;
     }
 
+    /**
+     * @brief Once-per-frame input of terminal runs, through the same key_mapping as SDL.
+     *
+     * Each typed key presses its CHIP-8 key for TERMINAL_KEY_HOLD_FRAMES frames. When the
+     * hold runs out the key is released, completing an FX0A wait like an SDL key-up does.
+     */
+    void Platform::read_terminal_input() {
+        terminal_keys_.clear();
+        if (!terminal_->poll_keys(terminal_keys_))
+            should_quit = true;
+
+        for (SDL_Keycode keycode : terminal_keys_) {
+            auto mapping = key_mapping->find(keycode);
+            if (mapping == key_mapping->end())
+                continue;
+            if (!netplay_)
+                chip8_->add_key_state(mapping->second);
+            terminal_key_hold_[mapping->second] = TERMINAL_KEY_HOLD_FRAMES;
+        }
+
+        if (netplay_) {
+            netplay_keys_ = 0;
+            for (uint8_t key = 0; key < terminal_key_hold_.size(); key++) {
+                if (terminal_key_hold_[key] > 0 && --terminal_key_hold_[key] > 0)
+                    netplay_keys_ |= static_cast<uint16_t>(1u << key);
+            }
+            return;
+        }
+
+        for (uint8_t key = 0; key < terminal_key_hold_.size(); key++) {
+            if (terminal_key_hold_[key] == 0 || --terminal_key_hold_[key] > 0)
+                continue;
+            if (chip8_->waiting_reg != 0xFF)
+                chip8_->complete_key_wait(key);
+            chip8_->remove_key_state(key);
+        }
+    }
+
+    /**
+     * @brief Binds the semantic keys of a ROM database entry to host keys.
+     *
+     * Arrows drive up/down/left/right, space and enter are A and B, and i/k/j/l are
+     * the second player's directions. The hex keypad mapping stays available.
+     *
+     * @param rom_keys CHIP-8 key per RomKey (RomSettings::unbound_key if unused).
+     */
+    void Platform::add_rom_key_bindings(const std::array<uint8_t, RomKeyCount>& rom_keys) {
+        static constexpr std::array<SDL_Keycode, RomKeyCount> host_keys = {
+            SDLK_UP, SDLK_DOWN, SDLK_LEFT, SDLK_RIGHT, SDLK_SPACE, SDLK_RETURN, 'i', 'k', 'j', 'l'
+        };
+        for (std::size_t k = 0; k < rom_keys.size(); k++) {
+            if (rom_keys[k] != RomSettings::unbound_key) {
+                (*key_mapping)[host_keys[k]] = rom_keys[k];
+            }
+        }
+    }
+
     bool Platform::is_valid_key(SDL_Keysym keysym) {
-        std::map<uint8_t, uint8_t>::iterator mapping = key_mapping->find(keysym.sym);
+        std::map<SDL_Keycode, uint8_t>::iterator mapping = key_mapping->find(keysym.sym);
         return !(mapping == key_mapping->end());
     }
 
     int Platform::add_key_state(SDL_Keysym keysym) {
         // add to key_states
         uint8_t key = this->key_mapping->at(keysym.sym);
-        chip8_->add_key_state(key);
+        if (netplay_)
+            netplay_keys_ |= static_cast<uint16_t>(1u << key);
+        else
+            chip8_->add_key_state(key);
         return 0;
     }
 
     int Platform::remove_key_state(SDL_Keysym keysym) {
         // remove from key_states
         uint8_t key = this->key_mapping->at(keysym.sym);
+        if (netplay_) {
+            const bool held = (netplay_keys_ >> key) & 1u;
+            netplay_keys_ &= static_cast<uint16_t>(~(1u << key));
+            return held ? 1 : 0;
+        }
         return chip8_->remove_key_state(key);
     }
 
@@ -187,8 +583,24 @@ namespace Chip8 {
         Sint16* buf = reinterpret_cast<Sint16*>(stream);    // convert the stream to 16-bit samples
         int samples = len / sizeof(Sint16);  // number of 16-bit samples
 
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        const std::chrono::duration<double> buffer_length(static_cast<double>(samples) / audio_data->sample_rate);
+        if (audio_data->last_callback.time_since_epoch().count() != 0 && now - audio_data->last_callback > buffer_length * 1.5)
+            audio_data->metrics->add(Counter::AUDIO_UNDERRUNS);
+        audio_data->last_callback = now;
+
         for (int i = 0; i < samples; i++) {
-            if (audio_data->tone_on) {
+            if (audio_data->tone_on && audio_data->pattern_on) {
+                // XO-CHIP: play the 1-bit pattern as a square-ish wave
+                int bit = static_cast<int>(audio_data->pattern_pos);
+                bool high = (audio_data->pattern[bit >> 3] >> (7 - (bit & 7))) & 0x1;
+                buf[i] = static_cast<Sint16>(high ? audio_data->amplitude : -audio_data->amplitude);
+
+                audio_data->pattern_pos += audio_data->pattern_step;
+                if (audio_data->pattern_pos >= 128.0) {
+                    audio_data->pattern_pos = std::fmod(audio_data->pattern_pos, 128.0);
+                }
+            } else if (audio_data->tone_on) {
                 // Generate a sine wave at the current phase
                 double value = std::sin(audio_data->phase);
                 buf[i] = static_cast<Sint16>(audio_data->amplitude * value);
@@ -213,51 +625,379 @@ namespace Chip8 {
         curr_audio_data->tone_on = false;
     }
 
+    /**
+     * @brief Hands a new XO-CHIP audio pattern / pitch over to the audio callback.
+     *
+     * The playback rate is 4000 * 2^((pitch - 64) / 48) bits per second.
+     * The audio device is locked so the callback never sees a half-copied pattern.
+     */
+    void Platform::update_audio_pattern() {
+        double rate = 4000.0 * std::pow(2.0, (chip8_->audio_pitch - 64) / 48.0);
+
+        SDL_LockAudioDevice(audio_device);
+        curr_audio_data->pattern = chip8_->audio_pattern;
+        curr_audio_data->pattern_on = true;
+        curr_audio_data->pattern_step = rate / curr_audio_data->sample_rate;
+        SDL_UnlockAudioDevice(audio_device);
+
+        chip8_->audio_pattern_dirty = false;
+    }
+
     bool Platform::check_valid() {
         // true if rom loaded and no quitting key has been pressed
         return chip8_->get_rom_loaded() && !should_quit;
     }
 
-    void Platform::run_frame() {
-        std::chrono::time_point frame_start_time = std::chrono::steady_clock::now();
+    /**
+     * @brief One emulated frame: IPF budget, instructions, timers, recorder and spectators.
+     *
+     * @param executed Incremented by the instructions actually run.
+     * @return The frame's report for the IPF controller, host_load not yet filled in.
+     */
+    FrameReport Platform::emulate_frame(uint32_t& executed) {
+        ipf_ = ipf_controller_.next_budget();
+        const uint32_t polls_before = chip8_->delay_timer_polls;
+        const uint32_t sets_before = chip8_->delay_timer_sets;
 
         // Run instructions per frame as specified;
-        for (int i = 0; i < ipf_; ++i) {
-            read_input();
-            if (!chip8_->is_waiting_for_key()) { // skip cycle if waiting for a key
+        uint32_t ran = 0;
+        if (debugger_ && debugger_->engaged()) {
+            run_debug_cycles();
+            ran = debugger_->is_paused() ? 0 : ipf_;
+        }
+        else if (probe_) {
+            ran = run_probe_cycles();
+        }
+        else if (aot_) {
+            if (gui_) read_input();     // once per frame: compiled code runs the frame in one go
+            ran = ipf_ - Aot::run(*chip8_, *aot_, ipf_, aot_invalidated_);
+        }
+        else {
+            for (unsigned i = 0; i < ipf_; ++i) {
+                if (gui_) read_input();
+                if (!chip8_->is_waiting_for_key()) { // skip cycle if waiting for a key
+                    chip8_->cycle();
+                    ran++;
+                }
+
+            }
+        }
+
+        // Time stands still while the debugger holds the machine
+        if (!debugger_ || !debugger_->is_paused())
+            chip8_->decrement_timers();
+
+        frame_metrics_->add(Counter::FRAMES_EMULATED);
+        frame_metrics_->add(Counter::INSTRUCTIONS_EXECUTED, ran);
+        executed += ran;
+
+        if (recorder_) recorder_->push_frame(chip8_->gfx);
+        if (spectators_) spectators_->publish(chip8_->gfx);
+
+        return FrameReport{ipf_, chip8_->delay_timer_polls - polls_before, chip8_->delay_timer_sets - sets_before,
+            chip8_->is_waiting_for_key() || (debugger_ && debugger_->is_paused()), 0.0};
+    }
+
+    /**
+     * @brief Netplay variant of emulate_frame: takes the peer's packets, runs again every
+     * frame that ran on a wrong prediction of its keys, then the next frame if the peer
+     * is close enough behind.
+     *
+     * Keys are read once, before the frame, and go to Netplay instead of the Chip. Frames
+     * run again after a rollback are not counted, recorded or streamed a second time.
+     */
+    FrameReport Platform::emulate_netplay_frame(uint32_t& executed) {
+        if (gui_) read_input();
+        netplay_->receive();
+
+        if (std::optional<uint32_t> from = netplay_->take_rollback()) {
+            chip8_->restore_snapshot((*netplay_snapshots_)[*from % Netplay::max_rollback]);
+            for (uint32_t frame = *from; frame < netplay_->frame(); frame++) {
+                run_netplay_frame(frame);
+            }
+        }
+
+        uint32_t ran = 0;
+        const bool advanced = netplay_->can_advance();
+        if (advanced) {
+            netplay_->set_local_input(netplay_keys_);
+            ran = run_netplay_frame(netplay_->frame());
+            netplay_->advance();
+        }
+        netplay_->send();
+        if (netplay_->finished())
+            should_quit = true;
+
+        if (advanced) {
+            frame_metrics_->add(Counter::FRAMES_EMULATED);
+            frame_metrics_->add(Counter::INSTRUCTIONS_EXECUTED, ran);
+            executed += ran;
+            if (recorder_) recorder_->push_frame(chip8_->gfx);
+            if (spectators_) spectators_->publish(chip8_->gfx);
+        }
+        return FrameReport{ipf_, 0, 0, !advanced, 0.0};
+    }
+
+    /**
+     * @brief Runs netplay frame from its keys after snapshotting the state before it, the
+     * point a later rollback to this frame restores.
+     *
+     * @return Instructions executed.
+     */
+    uint32_t Platform::run_netplay_frame(uint32_t frame) {
+        chip8_->save_snapshot((*netplay_snapshots_)[frame % Netplay::max_rollback]);
+        apply_key_mask(netplay_->input(frame));
+
+        uint32_t ran = 0;
+        for (unsigned i = 0; i < ipf_; ++i) {
+            if (!chip8_->is_waiting_for_key()) {
                 chip8_->cycle();
+                ran++;
             }
+        }
+        chip8_->decrement_timers();
+
+        if (frame % Netplay::hash_interval == 0)
+            netplay_->record_hash(frame, chip8_->state_hash());
+        return ran;
+    }
 
+    /**
+     * @brief Sets the whole keypad to mask; a release completes an FX0A wait, like an SDL
+     * key-up does. Diffs against the Chip's own key state, which rolls back with it.
+     */
+    void Platform::apply_key_mask(uint16_t mask) {
+        const uint16_t held = chip8_->key_mask;
+        for (uint8_t key = 0; key < 16; key++) {
+            const bool was_down = (held >> key) & 1u;
+            const bool down = (mask >> key) & 1u;
+            if (down && !was_down) {
+                chip8_->add_key_state(key);
+            }
+            else if (!down && was_down) {
+                if (chip8_->waiting_reg != 0xFF)
+                    chip8_->complete_key_wait(key);
+                chip8_->remove_key_state(key);
+            }
         }
+    }
 
-        // DRAW PIXEL in gui as a rectangle (or square to be exact)
-        gui_->clear();
-            for (int x = 0; x < 64; x++) {
-                for (int y = 0; y < 32; y++) {
-                    if (chip8_->gfx->at(x).at(y)) // if y exists then, pixel is valid
-                        gui_->draw_pixel(x,y,true);
+    /**
+     * @brief Emulates run_ahead_frames_ frames past the real one, composites the last of
+     * them into frame_pixels_ and rolls the machine back.
+     *
+     * Nothing outside the Chip sees these frames: no input is polled (a key event taken
+     * here would be rolled back too), and the tracer, opcode counters, recorder,
+     * spectators, metrics and the IPF controller are left out.
+     */
+    void Platform::run_ahead() {
+        speculate([this] {
+            bool invalidated = aot_invalidated_;    // a rollback also undoes self-modification
+            bool probing = probe_ && probe_->tracking();
+            std::size_t slot = 0;
+            for (unsigned frame = 0; frame < run_ahead_frames_; frame++) {
+                if (aot_) {
+                    Aot::run(*chip8_, *aot_, ipf_, invalidated);
+                }
+                else {
+                    for (unsigned i = 0; i < ipf_; ++i) {
+                        if (!chip8_->is_waiting_for_key())
+                            chip8_->cycle();
+                        if (probing && probe_->check_ahead(slot++, chip8_->framebuffer_hash()))
+                            probing = false;    // the press shows up in the predicted frame
+                    }
                 }
+                chip8_->decrement_timers();
             }
-        gui_->present_idle();
+            compositor_.composite(chip8_->gfx, frame_pixels_.data());
+        });
+    }
 
-        chip8_->decrement_timers();
+    /**
+     * @brief Runs body on the Chip and rolls everything it did back afterwards.
+     *
+     * The tracer and opcode counters are detached meanwhile, so speculative instructions
+     * never show up in traces or metrics.
+     */
+    void Platform::speculate(const std::function<void()>& body) {
+        if (!speculation_checkpoint_)
+            speculation_checkpoint_ = std::make_unique<Chip::Checkpoint>();
+        std::shared_ptr<TraceBuffer> tracer = chip8_->get_tracer();
+        std::atomic<uint64_t>* opcode_counts = chip8_->opcode_counts;
+        chip8_->attach_tracer(nullptr);
+        chip8_->opcode_counts = nullptr;
+        chip8_->begin_checkpoint(*speculation_checkpoint_);
+
+        body();
+
+        chip8_->rollback_checkpoint();
+        chip8_->opcode_counts = opcode_counts;
+        chip8_->attach_tracer(std::move(tracer));
+    }
 
-        // Plays sound based on condition
-        if (chip8_->sound_timer > 0 && !curr_audio_data->tone_on) {
-            play_sound();
+    /**
+     * @brief Latency probe variant of the instruction loop: the same work, plus one
+     * framebuffer comparison per instruction slot while a press is being tracked.
+     *
+     * @return Instructions executed.
+     */
+    uint32_t Platform::run_probe_cycles() {
+        uint32_t ran = 0;
+        for (unsigned i = 0; i < ipf_; ++i) {
+            probe_slots_left_ = ipf_ - i;
+            if (gui_) read_input();
+            if (!chip8_->is_waiting_for_key()) {
+                chip8_->cycle();
+                ran++;
+            }
+            if (probe_->tracking())
+                probe_->check(chip8_->framebuffer_hash());
+        }
+        probe_slots_left_ = 0;
+        return ran;
+    }
+
+    /**
+     * @brief The probe's press was just dequeued: records the counterfactual, i.e. the
+     * framebuffer hash after every instruction slot of the next lookahead frames as they
+     * would run without the press.
+     */
+    void Platform::start_probe_sample() {
+        if (probe_slots_left_ == 0) {
+            probe_->discard();      // outside the probe loop (no ROM yet, debugger): no slot to align to
+            return;
         }
-        else if (chip8_->sound_timer == 0 && curr_audio_data->tone_on) {
-            disable_sound();
+
+        probe_->on_seen();
+        std::vector<uint64_t>& expected = probe_->expected_hashes();
+        expected.clear();
+        speculate([this, &expected] {
+            unsigned slots = probe_slots_left_;
+            for (unsigned frame = 0; frame < probe_->lookahead_frames(); frame++) {
+                for (unsigned i = 0; i < slots; ++i) {
+                    if (!chip8_->is_waiting_for_key())
+                        chip8_->cycle();
+                    expected.push_back(chip8_->framebuffer_hash());
+                }
+                chip8_->decrement_timers();
+                slots = ipf_;
+            }
+        });
+    }
+
+    /**
+     * @brief One host frame: as many emulated frames as the speed asks for, then one
+     * render, sound update and the pacing sleep.
+     *
+     * Intermediate frames of a fast-forward are emulated but never drawn. The IPF
+     * controller only sees host load at 1x; at other speeds its frames count as unpaced.
+     */
+    void Platform::run_frame() {
+        std::chrono::time_point frame_start_time = std::chrono::steady_clock::now();
+        if (terminal_) read_terminal_input();
+        if (spectators_) apply_remote_keys();
+
+        uint32_t executed = 0;
+
+        // Headless: no rendering, sound or frame pacing, run as fast as possible
+        if (!gui_ && !terminal_) {
+            ipf_controller_.end_frame(emulate_frame(executed));
+            if (debugger_ && debugger_->is_paused())
+                std::this_thread::sleep_for(cycle_period);  // wait for console commands without spinning
+            return;
+        }
+
+        // The debugger steps real frames, whatever the speed
+        const bool debugging = debugger_ && debugger_->engaged();
+        const bool paced = speed_.normal() || debugging;
+        std::optional<FrameReport> last_report;
+        if (paced) {
+            last_report = netplay_ ? emulate_netplay_frame(executed) : emulate_frame(executed);
+        }
+        else if (speed_.unlimited()) {
+            // Leave room for drawing the last frame within the display refresh
+            const std::chrono::microseconds budget = std::max(cycle_period - last_render_time_, cycle_period / 4);
+            do {
+                ipf_controller_.end_frame(emulate_frame(executed));
+            } while (!should_quit && std::chrono::steady_clock::now() - frame_start_time < budget);
+        }
+        else {
+            for (int frames = speed_.frames_this_tick(); frames > 0 && !should_quit; frames--) {
+                ipf_controller_.end_frame(emulate_frame(executed));
+            }
+        }
+
+        // Run-ahead composites the predicted frame itself; it counts as emulation time
+        const bool run_ahead_frame = run_ahead_frames_ > 0 && !debugging && !speed_.unlimited();
+        if (run_ahead_frame)
+            run_ahead();
+
+        // Composite both bitplanes into the 4-color palette and draw them in one texture upload
+        std::chrono::time_point render_start = std::chrono::steady_clock::now();
+        if (!run_ahead_frame)
+            compositor_.composite(chip8_->gfx, frame_pixels_.data());
+        std::chrono::time_point present_start = render_start;
+        if (gui_) {
+            const uint32_t* overlay = nullptr;
+            if (perf_visible_) {
+                perf_.set_ipf(ipf_);
+                perf_.set_audio_underruns(static_cast<uint32_t>(metrics_.total(Counter::AUDIO_UNDERRUNS)));
+                perf_.draw(perf_pixels_.data());
+                overlay = perf_pixels_.data();
+            }
+            gui_->clear();
+            gui_->render_frame(frame_pixels_.data(), overlay);
+            present_start = std::chrono::steady_clock::now();
+            gui_->present_idle();
+            if (probe_) probe_->on_present();
+        }
+        else {
+            terminal_->render_frame(frame_pixels_.data());
+            present_start = std::chrono::steady_clock::now();
+        }
+
+        // Plays sound based on condition
+        if (curr_audio_data) {
+            if (chip8_->audio_pattern_dirty) {
+                update_audio_pattern();
+            }
+            if (chip8_->sound_timer > 0 && !curr_audio_data->tone_on) {
+                play_sound();
+            }
+            else if (chip8_->sound_timer == 0 && curr_audio_data->tone_on) {
+                disable_sound();
+            }
         }
 
         // Compute remaining time
         std::chrono::time_point<std::chrono::steady_clock> frame_end_time = std::chrono::steady_clock::now();
-        std::chrono::microseconds elapsed = std::chrono::duration_cast<std::chrono::milliseconds>
+        std::chrono::microseconds elapsed = std::chrono::duration_cast<std::chrono::microseconds>
         (frame_end_time - frame_start_time);
-        std::chrono::microseconds time_to_wait = cycle_period - elapsed;
+        last_render_time_ = std::chrono::duration_cast<std::chrono::microseconds>(frame_end_time - render_start);
+        const std::chrono::microseconds tick_period = paced ? cycle_period : speed_.tick_period(cycle_period);
+        std::chrono::microseconds time_to_wait = speed_.unlimited() && !paced ? std::chrono::microseconds{0} : tick_period - elapsed;
+
+        if (last_report) {
+            last_report->host_load = static_cast<double>(elapsed.count()) / cycle_period.count();
+            ipf_controller_.end_frame(*last_report);
+        }
+        frame_metrics_->observe(Histogram::FRAME_WORK, elapsed);
+        if (!speed_.unlimited() && elapsed > tick_period)
+            frame_metrics_->add(Counter::DEADLINE_MISSES);
 
         // Sleep until time is up
         std::this_thread::sleep_for(time_to_wait);
+
+        // Where this frame's time went, for the F3 overlay
+        auto us = [](auto duration) { return std::chrono::duration_cast<std::chrono::microseconds>(duration); };
+        std::chrono::time_point sleep_end = std::chrono::steady_clock::now();
+        if (time_to_wait.count() > 0)
+            frame_metrics_->observe(Histogram::SLEEP_OVERSHOOT, us(sleep_end - frame_end_time) - time_to_wait);
+        perf_.record(FrameTiming{us(render_start - frame_start_time), us(present_start - render_start),
+            us(frame_end_time - present_start), us(sleep_end - frame_end_time),
+            last_frame_start_.time_since_epoch().count() ? us(frame_start_time - last_frame_start_) : cycle_period,
+            executed});
+        last_frame_start_ = frame_start_time;
     }
 
 } // Chip8
\ No newline at end of file
@@ -1,15 +1,33 @@
 #ifndef PLATFORM_H
 #define PLATFORM_H
 
+#include <atomic>
 #include <chrono>
+#include <functional>
+#include <future>
+#include <optional>
+#include <string>
 #include <vector>
 #include <map>
 
 #include <SDL_audio.h>
 #include <SDL_events.h>
 
+#include "aot/aot_runtime.h"
+#include "database/rom_database.h"
+#include "debugger/debugger.h"
+#include "gui/compositor.h"
 #include "gui/gui.h"
+#include "gui/perf_overlay.h"
+#include "gui/terminal_gui.h"
 #include "hardware/chip.h"
+#include "metrics/metrics.h"
+#include "net/netplay.h"
+#include "net/spectator_server.h"
+#include "timing/ipf_controller.h"
+#include "timing/latency_probe.h"
+#include "timing/speed_control.h"
+#include "video/video_recorder.h"
 
 namespace Chip8 {
 
@@ -19,10 +37,10 @@ public:
     const std::unique_ptr<std::vector<uint32_t>> sdl_subsystems_; // smart_ptr to vector of subsys
 
     const uint8_t key_input_range = 15; // 0 - 15 or 0x0 to 0xF
-    const std::unique_ptr<std::map<uint8_t, uint8_t>> key_mapping;
+    const std::unique_ptr<std::map<SDL_Keycode, uint8_t>> key_mapping; // host key -> CHIP-8 key
 
     const std::shared_ptr<Chip> chip8_; // actual hardware
-    const std::shared_ptr<Gui> gui_; // gui layer
+    std::shared_ptr<Gui> gui_; // gui layer (nullptr when running headless)
     bool should_quit{false};
     const int center_row = 16; // halfway (32/2)
     const int center_col = 32;
@@ -31,6 +49,27 @@ public:
     gui_instance, unsigned ipf);
     ~Platform();
     int init_sdl();
+    void attach_gui(std::shared_ptr<Gui> gui_instance);
+    void attach_terminal(std::shared_ptr<TerminalGui> terminal);  // render to the terminal instead of a window
+    void attach_recorder(std::shared_ptr<VideoRecorder> recorder);
+    void attach_spectator_server(std::shared_ptr<SpectatorServer> server);
+    void set_trace_path(const std::string& path);   // where F12 dumps the execution trace
+    void attach_debugger(std::shared_ptr<Debugger> debugger);
+    void attach_aot(const Aot::Program* program);     // run the ROM through recompiled code
+    void set_ipf_controller(const IpfController& controller);
+    void set_speed(const SpeedControl& speed);      // also F5 slower, F6 faster, F7 1x, F8 unlimited
+    void set_run_ahead(unsigned frames);            // show the frame this many frames ahead, 0 = off
+    void attach_latency_probe(std::shared_ptr<LatencyProbe> probe);
+    void attach_netplay(std::shared_ptr<Netplay> netplay);     // two-player rollback over UDP
+    void reset_for_new_rom();
+    std::optional<std::string> take_dropped_file();
+    void idle_frame();
+    void set_perf_overlay_visible(bool visible);   // also toggled with F3
+    Metrics& metrics();
+    void count_opcodes(bool enabled);                // per-opcode metrics (interpreter only)
+    const IpfController& ipf_controller() const;
+    int wait_for_audio();
+    std::chrono::microseconds audio_startup_time() const;
 
     const uint16_t SAMPLE_RATE = 44100;
     const uint16_t BUFFER_SIZE = 4096;
@@ -39,6 +78,7 @@ public:
     int add_subsystem(uint32_t subsystem_code);
 
     int read_input();
+    void add_rom_key_bindings(const std::array<uint8_t, RomKeyCount>& rom_keys);
 
     bool is_valid_key(SDL_Keysym keysym);
     int add_key_state(SDL_Keysym keysym);
@@ -48,6 +88,7 @@ public:
     static void audio_callback(void *userdata, Uint8 *stream, int len);
     void play_sound();
     void disable_sound();
+    void update_audio_pattern();
 
     int create_window_layer(); // TODO
 
@@ -56,13 +97,63 @@ public:
     void run_frame();
 
 private:
-    unsigned ipf_;
+    unsigned ipf_;                  // budget of the current frame, set by ipf_controller_
+    IpfController ipf_controller_;
     const unsigned cycle_hz = 60;
     std::chrono::microseconds cycle_period;
     std::chrono::microseconds last_cycle_time;
 
     std::unique_ptr<SDL_AudioSpec> want_audio_spec;
     std::unique_ptr<SDL_AudioSpec> have_audio_spec;
+    SDL_AudioDeviceID audio_device{0};
+    std::future<int> audio_ready_;                  // audio subsystem + device, opened off the main thread
+    std::chrono::microseconds audio_startup_time_{0};
+
+    Compositor compositor_;
+    Compositor::Frame frame_pixels_{};
+    std::shared_ptr<VideoRecorder> recorder_;
+    std::string trace_path_;
+    std::shared_ptr<Debugger> debugger_;
+    const Aot::Program* aot_{nullptr};
+    std::shared_ptr<TerminalGui> terminal_;
+    std::shared_ptr<SpectatorServer> spectators_;
+    std::optional<std::string> dropped_file_;      // SDL_DROPFILE path not yet taken
+    PerfOverlay perf_;
+    bool perf_visible_{false};
+    std::array<uint32_t, PerfOverlay::width * PerfOverlay::height> perf_pixels_{};
+    std::chrono::steady_clock::time_point last_frame_start_{};
+    SpeedControl speed_;
+    std::chrono::microseconds last_render_time_{0};  // render + present + sound of the last host frame
+    unsigned run_ahead_frames_{0};
+    std::unique_ptr<Chip::Checkpoint> speculation_checkpoint_;   // run-ahead and latency counterfactuals
+    std::shared_ptr<LatencyProbe> probe_;
+    unsigned probe_slots_left_{0};                  // instruction slots left in the frame, inside the probe loop
+    std::shared_ptr<Netplay> netplay_;
+    std::unique_ptr<std::array<Chip::Snapshot, Netplay::max_rollback>> netplay_snapshots_;  // by frame
+    uint16_t netplay_keys_{0};                      // this player's keys; the Chip sees Netplay::input
+    Metrics metrics_;
+    MetricsShard* frame_metrics_{nullptr};          // written by the emulation thread only
+    uint16_t remote_keys_{0};                       // keypad as last set by the controlling spectator
+    std::array<uint8_t, 16> terminal_key_hold_{};  // frames each CHIP-8 key stays down, terminal input
+    std::vector<SDL_Keycode> terminal_keys_;
+
+    // Terminals report presses and autorepeats but no releases: a key is held this many
+    // frames after its last press, which bridges the autorepeat interval of held keys
+    static constexpr uint8_t TERMINAL_KEY_HOLD_FRAMES = 10;
+    bool aot_invalidated_{false};                  // the ROM rewrote compiled code
+
+    FrameReport emulate_frame(uint32_t& executed);
+    FrameReport emulate_netplay_frame(uint32_t& executed);
+    uint32_t run_netplay_frame(uint32_t frame);
+    void apply_key_mask(uint16_t mask);
+    void speculate(const std::function<void()>& body);
+    void run_ahead();
+    uint32_t run_probe_cycles();
+    void start_probe_sample();
+    void run_debug_cycles();
+    void change_speed(SDL_Keycode key);
+    void read_terminal_input();
+    void apply_remote_keys();
 
     struct AudioData {
         double phase;           // current phase (in 2pi) of the oscillator
@@ -71,6 +162,17 @@ private:
         bool tone_on;           // whether to emit tone or silence
         int sample_rate;        // default: 48000
         int amplitude;          // max amplitude for 16-bits
+
+        // XO-CHIP pattern playback (replaces the sine tone once a pattern is loaded)
+        std::array<uint8_t, 16> pattern; // 128 1-bit samples
+        bool pattern_on;
+        double pattern_pos;     // current bit position [0, 128)
+        double pattern_step;    // pattern bits advanced per output sample
+
+        // Underrun detection: a callback arriving later than the previous buffer lasted
+        // means the device ran dry in between
+        std::chrono::steady_clock::time_point last_callback;
+        MetricsShard* metrics;  // the audio thread's own shard
     };
 
     std::unique_ptr<AudioData> curr_audio_data;
@@ -0,0 +1,36 @@
+#include "aot_runtime.h"
+
+namespace Chip8::Aot {
+#ifndef CHIP8_HAS_AOT
+    const Program* compiled_program() {
+        return nullptr;
+    }
+#endif
+
+    /**
+     * @brief Runs up to budget instructions through the compiled code.
+     *
+     * Addresses the recompiler never reached (computed jumps into unexplored code, code
+     * outside the ROM) run one instruction at a time on the interpreter, as does
+     * everything once the program has modified its own code.
+     *
+     * @param chip Machine to run.
+     * @param program Compiled form of the loaded ROM.
+     * @param budget Instructions to execute this frame.
+     * @param invalidated Set (and then honoured) once compiled code was overwritten.
+     * @return Instructions left unexecuted because the chip is waiting for a key.
+     */
+    int run(Chip& chip, const Program& program, int budget, bool& invalidated) {
+        while (budget > 0 && !chip.is_waiting_for_key()) {
+            BlockFn block = invalidated ? nullptr : program.lookup(chip.program_ctr);
+            if (!block) {
+                chip.cycle();
+                --budget;
+                continue;
+            }
+            if (!block(chip, budget))
+                invalidated = true;
+        }
+        return budget;
+    }
+} // Chip8::Aot
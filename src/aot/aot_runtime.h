@@ -0,0 +1,65 @@
+#ifndef AOT_RUNTIME_H
+#define AOT_RUNTIME_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../hardware/chip.h"
+#include "../hardware/memory_access.h"
+
+namespace Chip8::Aot {
+
+/**
+ * Native code for one straight-line run of a ROM, produced by chip8_recompile.
+ *
+ * Entered at any instruction of the run (the PC picks the label), it executes
+ * instructions until the budget is spent or control leaves the run, then stores the
+ * PC and remaining budget back. Returns false if the program wrote over its own code,
+ * after which the compiled code must not be used anymore.
+ */
+using BlockFn = bool (*)(Chip& chip, int& budget);
+
+/**
+ * A ROM compiled ahead of time. Only valid for the exact ROM and quirk profile it was
+ * generated from.
+ */
+struct Program {
+    const char* rom_sha1;               // hex digest of the source ROM
+    QuirkProfile quirks;
+    BlockFn (*lookup)(uint16_t pc);     // run containing the instruction at pc, nullptr if none
+    const uint64_t* code_map;           // one bit per byte that holds compiled instructions
+    std::size_t code_map_words;
+};
+
+/**
+ * @brief The program linked in with CHIP8_AOT_SOURCE, nullptr in regular builds.
+ */
+const Program* compiled_program();
+
+int run(Chip& chip, const Program& program, int budget, bool& invalidated);
+
+/**
+ * @brief Whether a store of length bytes at addr hits compiled code (self-modifying code).
+ */
+inline bool touches_code(const Program& program, uint16_t addr, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        uint16_t byte = static_cast<uint16_t>(addr + i);
+        std::size_t word = byte >> 6;
+        if (word < program.code_map_words && (program.code_map[word] >> (byte & 63u)) & 1u)
+            return true;
+    }
+    return false;
+}
+
+} // Chip8::Aot
+
+// Helpers for generated code: every instruction label checks the budget first.
+#define CHIP8_AOT_STEP(addr) \
+    if (left == 0) { c.program_ctr = (addr); budget = 0; return true; } \
+    --left
+#define CHIP8_AOT_EXIT(pc) \
+    do { c.program_ctr = static_cast<uint16_t>(pc); budget = left; return true; } while (0)
+#define CHIP8_AOT_INVALIDATE(pc) \
+    do { c.program_ctr = static_cast<uint16_t>(pc); budget = left; return false; } while (0)
+
+#endif //AOT_RUNTIME_H
@@ -0,0 +1,187 @@
+#include "json.h"
+
+#include <cstdlib>
+#include <format>
+#include <stdexcept>
+
+namespace Chip8 {
+    namespace {
+        class JsonParser {
+        public:
+            explicit JsonParser(const std::string& text) : text_(text) {}
+
+            JsonValue parse_document() {
+                JsonValue value = parse_value();
+                skip_whitespace();
+                if (pos_ != text_.size()) fail("trailing characters");
+                return value;
+            }
+
+        private:
+            const std::string& text_;
+            std::size_t pos_ = 0;
+
+            [[noreturn]] void fail(const char* what) const {
+                throw std::runtime_error(std::format("JSON parse error at offset {}: {}", pos_, what));
+            }
+
+            void skip_whitespace() {
+                while (pos_ < text_.size() &&
+                       (text_[pos_] == ' ' || text_[pos_] == '\n' || text_[pos_] == '\r' || text_[pos_] == '\t')) {
+                    pos_++;
+                }
+            }
+
+            char peek() {
+                skip_whitespace();
+                if (pos_ >= text_.size()) fail("unexpected end of input");
+                return text_[pos_];
+            }
+
+            void expect(char c) {
+                if (peek() != c) fail("unexpected character");
+                pos_++;
+            }
+
+            bool consume_literal(const char* literal) {
+                std::size_t length = std::char_traits<char>::length(literal);
+                if (text_.compare(pos_, length, literal) != 0) return false;
+                pos_ += length;
+                return true;
+            }
+
+            JsonValue parse_value() {
+                JsonValue value;
+                char c = peek();
+                if (c == '{') {
+                    value.type = JsonValue::Type::Object;
+                    pos_++;
+                    if (peek() == '}') { pos_++; return value; }
+                    while (true) {
+                        if (peek() != '"') fail("expected object key");
+                        std::string key = parse_string();
+                        expect(':');
+                        value.object.emplace_back(std::move(key), parse_value());
+                        if (peek() == ',') { pos_++; continue; }
+                        expect('}');
+                        return value;
+                    }
+                }
+                if (c == '[') {
+                    value.type = JsonValue::Type::Array;
+                    pos_++;
+                    if (peek() == ']') { pos_++; return value; }
+                    while (true) {
+                        value.array.push_back(parse_value());
+                        if (peek() == ',') { pos_++; continue; }
+                        expect(']');
+                        return value;
+                    }
+                }
+                if (c == '"') {
+                    value.type = JsonValue::Type::String;
+                    value.string = parse_string();
+                    return value;
+                }
+                if (consume_literal("true"))  { value.type = JsonValue::Type::Bool; value.boolean = true;  return value; }
+                if (consume_literal("false")) { value.type = JsonValue::Type::Bool; value.boolean = false; return value; }
+                if (consume_literal("null"))  { return value; }
+
+                // number
+                const char* begin = text_.c_str() + pos_;
+                char* end = nullptr;
+                value.number = std::strtod(begin, &end);
+                if (end == begin) fail("unexpected character");
+                value.type = JsonValue::Type::Number;
+                pos_ += end - begin;
+                return value;
+            }
+
+            void append_utf8(std::string& out, uint32_t code_point) {
+                if (code_point < 0x80) {
+                    out.push_back(static_cast<char>(code_point));
+                } else if (code_point < 0x800) {
+                    out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+                    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                } else if (code_point < 0x10000) {
+                    out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+                    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                } else {
+                    out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+                    out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+                    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+                }
+            }
+
+            uint32_t parse_hex4() {
+                if (pos_ + 4 > text_.size()) fail("truncated \\u escape");
+                uint32_t value = 0;
+                for (int i = 0; i < 4; i++) {
+                    char c = text_[pos_++];
+                    value <<= 4;
+                    if (c >= '0' && c <= '9') value |= c - '0';
+                    else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+                    else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+                    else fail("invalid \\u escape");
+                }
+                return value;
+            }
+
+            std::string parse_string() {
+                expect('"');
+                std::string out;
+                while (true) {
+                    if (pos_ >= text_.size()) fail("unterminated string");
+                    char c = text_[pos_++];
+                    if (c == '"') return out;
+                    if (c != '\\') { out.push_back(c); continue; }
+
+                    if (pos_ >= text_.size()) fail("unterminated escape");
+                    char escape = text_[pos_++];
+                    switch (escape) {
+                        case '"': out.push_back('"'); break;
+                        case '\\': out.push_back('\\'); break;
+                        case '/': out.push_back('/'); break;
+                        case 'b': out.push_back('\b'); break;
+                        case 'f': out.push_back('\f'); break;
+                        case 'n': out.push_back('\n'); break;
+                        case 'r': out.push_back('\r'); break;
+                        case 't': out.push_back('\t'); break;
+                        case 'u': {
+                            uint32_t code_point = parse_hex4();
+                            if (code_point >= 0xD800 && code_point < 0xDC00 && consume_literal("\\u")) {
+                                uint32_t low = parse_hex4();    // surrogate pair
+                                code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                            }
+                            append_utf8(out, code_point);
+                            break;
+                        }
+                        default: fail("invalid escape");
+                    }
+                }
+            }
+        };
+    }
+
+    const JsonValue* JsonValue::get(const std::string& key) const {
+        if (type != Type::Object) return nullptr;
+        for (const auto& [name, value] : object) {
+            if (name == key) return &value;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Parses a complete JSON document.
+     *
+     * @param text JSON source.
+     * @throws std::runtime_error with the byte offset if the document is malformed.
+     * @return Root value.
+     */
+    JsonValue parse_json(const std::string& text) {
+        return JsonParser(text).parse_document();
+    }
+
+} // Chip8
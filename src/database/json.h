@@ -0,0 +1,32 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Chip8 {
+
+    /**
+     * Just enough JSON to read the chip-8-database files: a DOM value and a
+     * recursive descent parser. Objects keep their keys in file order.
+     */
+    struct JsonValue {
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        Type type = Type::Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<JsonValue> array;
+        std::vector<std::pair<std::string, JsonValue>> object;
+
+        const JsonValue* get(const std::string& key) const; // nullptr if absent or not an object
+        bool is(Type t) const { return type == t; }
+    };
+
+    JsonValue parse_json(const std::string& text);  // throws std::runtime_error on malformed input
+
+} // Chip8
+
+#endif //JSON_H
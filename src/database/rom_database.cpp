@@ -0,0 +1,231 @@
+#include "rom_database.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "json.h"
+
+namespace Chip8 {
+    namespace {
+        struct PlatformInfo {
+            const char* name;
+            RomPlatform platform;
+            QuirkProfile quirks;
+            uint16_t default_ipf;   // chip-8-database platforms.json "defaultTickrate"
+        };
+
+        constexpr PlatformInfo PLATFORMS[] = {
+            { "originalChip8", RomPlatform::OriginalChip8, QuirkProfile::VIP,    15 },
+            { "hybridVIP",     RomPlatform::HybridVip,     QuirkProfile::VIP,    15 },
+            { "modernChip8",   RomPlatform::ModernChip8,   QuirkProfile::SCHIP,  12 },
+            { "chip8x",        RomPlatform::Chip8x,        QuirkProfile::VIP,    15 },
+            { "chip48",        RomPlatform::Chip48,        QuirkProfile::SCHIP,  30 },
+            { "superchip1",    RomPlatform::Superchip1,    QuirkProfile::SCHIP,  30 },
+            { "superchip",     RomPlatform::Superchip,     QuirkProfile::SCHIP,  30 },
+            { "megachip8",     RomPlatform::Megachip8,     QuirkProfile::SCHIP,  1000 },
+            { "xochip",        RomPlatform::XoChip,        QuirkProfile::XOCHIP, 100 },
+        };
+
+        constexpr const char* KEY_NAMES[RomKeyCount] = {
+            "up", "down", "left", "right", "a", "b", "player2Up", "player2Down", "player2Left", "player2Right"
+        };
+
+        const PlatformInfo* find_platform(const std::string& name) {
+            for (const PlatformInfo& info : PLATFORMS) {
+                if (name == info.name) return &info;
+            }
+            return nullptr;
+        }
+
+        bool digest_less(const uint8_t* a, const uint8_t* b) {
+            return std::memcmp(a, b, 20) < 0;
+        }
+    }
+
+    RomDatabase::RomDatabase(std::string json_path) :
+    json_path_(std::move(json_path)),
+    index_path_(json_path_ + ".idx")
+    {}
+
+    /**
+     * @brief Loads the database, preferring the cached binary index.
+     *
+     * The index is used as long as it was built from a programs.json of the same size
+     * and modification time; otherwise it is rebuilt from the JSON file. If only the
+     * index exists (JSON removed), it is used as is. An unreadable index is only a stale
+     * cache and rebuilt like one.
+     *
+     * @return True if settings are available for lookup.
+     */
+    bool RomDatabase::load() {
+        std::error_code error;
+        bool has_json = std::filesystem::exists(json_path_, error);
+
+        uint64_t source_size = 0;
+        int64_t source_mtime = 0;
+        if (has_json) {
+            source_size = std::filesystem::file_size(json_path_, error);
+            source_mtime = std::filesystem::last_write_time(json_path_, error).time_since_epoch().count();
+        }
+
+        try {
+            if (load_index(source_size, source_mtime)) return true;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "RomDatabase: ignoring unreadable " << index_path_ << ": " << e.what() << std::endl;
+            records_.clear();
+        }
+        if (!has_json) return false;
+
+        try {
+            return build_index(source_size, source_mtime);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "RomDatabase: could not read " << json_path_ << ": " << e.what() << std::endl;
+            records_.clear();
+            return false;
+        }
+    }
+
+    bool RomDatabase::load_index(uint64_t source_size, int64_t source_mtime) {
+        std::ifstream index_file(index_path_, std::ios::in | std::ios::binary);
+        if (!index_file.is_open()) return false;
+
+        IndexHeader header{};
+        if (!index_file.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (std::memcmp(header.magic, "C8DB", 4) != 0 || header.version != INDEX_VERSION) return false;
+
+        // a truncated or corrupt count must not size the allocation
+        std::error_code error;
+        uint64_t index_size = std::filesystem::file_size(index_path_, error);
+        if (error || index_size != sizeof(header) + uint64_t{header.count} * sizeof(IndexRecord)) return false;
+
+        records_.resize(header.count);
+        if (!index_file.read(reinterpret_cast<char*>(records_.data()), header.count * sizeof(IndexRecord))) {
+            records_.clear();
+            return false;
+        }
+
+        // stale index: still readable, but the caller rebuilds it when the JSON is present
+        return source_size == 0 || (header.source_size == source_size && header.source_mtime == source_mtime);
+    }
+
+    /**
+     * @brief Parses programs.json and writes the sorted binary index next to it.
+     *
+     * Every (program, rom hash) pair becomes one record. The first listed platform decides
+     * the quirk profile and, without an explicit tickrate, the instructions per frame.
+     */
+    bool RomDatabase::build_index(uint64_t source_size, int64_t source_mtime) {
+        std::ifstream json_file(json_path_, std::ios::in | std::ios::binary);
+        if (!json_file.is_open()) return false;
+        std::stringstream buffer;
+        buffer << json_file.rdbuf();
+
+        JsonValue programs = parse_json(buffer.str());
+        if (!programs.is(JsonValue::Type::Array))
+            throw std::runtime_error("programs.json must contain an array of programs");
+
+        records_.clear();
+        for (const JsonValue& program : programs.array) {
+            const JsonValue* title = program.get("title");
+            const JsonValue* roms = program.get("roms");
+            if (!roms || !roms->is(JsonValue::Type::Object)) continue;
+
+            for (const auto& [hash, rom] : roms->object) {
+                Sha1Digest digest;
+                if (!sha1_from_hex(hash, digest)) continue;
+
+                IndexRecord record{};
+                std::memcpy(record.sha1, digest.data(), 20);
+                std::memset(record.keys, RomSettings::unbound_key, sizeof(record.keys));
+                record.quirks = static_cast<uint8_t>(QuirkProfile::SCHIP);
+                if (title && title->is(JsonValue::Type::String)) {
+                    std::strncpy(record.title, title->string.c_str(), sizeof(record.title) - 1);
+                }
+
+                const JsonValue* platforms = rom.get("platforms");
+                if (platforms && platforms->is(JsonValue::Type::Array) && !platforms->array.empty()) {
+                    if (const PlatformInfo* info = find_platform(platforms->array.front().string)) {
+                        record.platform = static_cast<uint8_t>(info->platform);
+                        record.quirks = static_cast<uint8_t>(info->quirks);
+                        record.ipf = info->default_ipf;
+                    }
+                }
+
+                const JsonValue* tickrate = rom.get("tickrate");
+                if (tickrate && tickrate->is(JsonValue::Type::Number) && tickrate->number >= 1) {
+                    record.ipf = static_cast<uint16_t>(std::min(tickrate->number, 65535.0));
+                }
+
+                if (const JsonValue* keys = rom.get("keys")) {
+                    for (int k = 0; k < RomKeyCount; k++) {
+                        const JsonValue* chip_key = keys->get(KEY_NAMES[k]);
+                        if (chip_key && chip_key->is(JsonValue::Type::Number)
+                            && chip_key->number >= 0 && chip_key->number <= 15) {
+                            record.keys[k] = static_cast<uint8_t>(chip_key->number);
+                        }
+                    }
+                }
+                records_.push_back(record);
+            }
+        }
+
+        std::sort(records_.begin(), records_.end(), [](const IndexRecord& a, const IndexRecord& b) {
+            return digest_less(a.sha1, b.sha1);
+        });
+
+        // Cache the parsed result; failing to write it only costs startup time next run
+        IndexHeader header{};
+        std::memcpy(header.magic, "C8DB", 4);
+        header.version = INDEX_VERSION;
+        header.source_size = source_size;
+        header.source_mtime = source_mtime;
+        header.count = static_cast<uint32_t>(records_.size());
+
+        std::ofstream index_file(index_path_, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (index_file.is_open()) {
+            index_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            index_file.write(reinterpret_cast<const char*>(records_.data()), records_.size() * sizeof(IndexRecord));
+        } else {
+            std::cerr << "RomDatabase: could not write index " << index_path_ << std::endl;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Finds the settings of a ROM by content hash.
+     *
+     * @param digest SHA-1 of the ROM file.
+     * @return Settings, or std::nullopt if the ROM is not in the database.
+     */
+    std::optional<RomSettings> RomDatabase::lookup(const Sha1Digest& digest) const {
+        auto it = std::lower_bound(records_.begin(), records_.end(), digest.data(),
+            [](const IndexRecord& record, const uint8_t* key) { return digest_less(record.sha1, key); });
+        if (it == records_.end() || std::memcmp(it->sha1, digest.data(), 20) != 0) return std::nullopt;
+
+        RomSettings settings;
+        settings.title = std::string(it->title, strnlen(it->title, sizeof(it->title)));
+        settings.platform = static_cast<RomPlatform>(it->platform);
+        settings.quirks = static_cast<QuirkProfile>(it->quirks);
+        settings.ipf = it->ipf;
+        std::copy(std::begin(it->keys), std::end(it->keys), settings.keys.begin());
+        return settings;
+    }
+
+    std::size_t RomDatabase::size() const {
+        return records_.size();
+    }
+
+    const char* RomDatabase::platform_name(RomPlatform platform) {
+        for (const PlatformInfo& info : PLATFORMS) {
+            if (info.platform == platform) return info.name;
+        }
+        return "unknown";
+    }
+
+} // Chip8
@@ -0,0 +1,87 @@
+#ifndef ROM_DATABASE_H
+#define ROM_DATABASE_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "sha1.h"
+#include "../hardware/quirks.h"
+
+namespace Chip8 {
+
+    // Target platforms as named by the chip-8-database ("platforms" field)
+    enum class RomPlatform : uint8_t {
+        Unknown, OriginalChip8, HybridVip, ModernChip8, Chip8x, Chip48, Superchip1, Superchip, Megachip8, XoChip
+    };
+
+    // Semantic keys of the chip-8-database "keys" field
+    enum RomKey : uint8_t {
+        Up, Down, Left, Right, A, B, Player2Up, Player2Down, Player2Left, Player2Right, RomKeyCount
+    };
+
+    struct RomSettings {
+        std::string title;
+        RomPlatform platform = RomPlatform::Unknown;
+        QuirkProfile quirks = QuirkProfile::SCHIP;
+        uint16_t ipf = 0;                           // instructions per frame ("tickrate")
+        std::array<uint8_t, RomKeyCount> keys{};    // CHIP-8 key per RomKey, unbound_key if absent
+
+        static constexpr uint8_t unbound_key = 0xFF;
+    };
+
+    /**
+     * Per-ROM settings looked up by SHA-1 of the ROM contents.
+     *
+     * The source is programs.json from the community chip-8-database. Parsing it
+     * takes a while, so the result is cached next to it as a compact binary index
+     * (<programs.json>.idx, sorted 64-byte records) that is rebuilt only when the
+     * JSON file changes. Lookups are a binary search over the loaded records.
+     */
+    class RomDatabase {
+    public:
+        static constexpr const char* DEFAULT_PATH = "chip8-database/database/programs.json";
+
+        explicit RomDatabase(std::string json_path = DEFAULT_PATH);
+
+        bool load();    // false if neither a valid index nor the JSON file is available
+        std::optional<RomSettings> lookup(const Sha1Digest& digest) const;
+        std::size_t size() const;
+
+        static const char* platform_name(RomPlatform platform);
+
+    private:
+        struct IndexHeader {
+            char magic[4];          // "C8DB"
+            uint32_t version;
+            uint64_t source_size;   // programs.json size and mtime the index was built from
+            int64_t source_mtime;
+            uint32_t count;
+            uint32_t reserved;
+        };
+
+        struct IndexRecord {
+            uint8_t sha1[20];
+            uint16_t ipf;
+            uint8_t platform;
+            uint8_t quirks;
+            uint8_t keys[RomKeyCount];
+            char title[30];         // NUL padded, truncated
+        };
+        static_assert(sizeof(IndexRecord) == 64, "index records are one cache line");
+
+        static constexpr uint32_t INDEX_VERSION = 1;
+
+        std::string json_path_;
+        std::string index_path_;
+        std::vector<IndexRecord> records_;
+
+        bool load_index(uint64_t source_size, int64_t source_mtime);
+        bool build_index(uint64_t source_size, int64_t source_mtime);
+    };
+
+} // Chip8
+
+#endif //ROM_DATABASE_H
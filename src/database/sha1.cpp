@@ -0,0 +1,108 @@
+#include "sha1.h"
+
+#include <cstring>
+
+namespace Chip8 {
+    namespace {
+        inline uint32_t rotl(uint32_t value, int bits) {
+            return (value << bits) | (value >> (32 - bits));
+        }
+
+        void process_block(const uint8_t* block, std::array<uint32_t, 5>& h) {
+            uint32_t w[80];
+            for (int i = 0; i < 16; i++) {
+                w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16)
+                     | (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+            }
+            for (int i = 16; i < 80; i++) {
+                w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+            }
+
+            uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+            for (int i = 0; i < 80; i++) {
+                uint32_t f, k;
+                if (i < 20)      { f = (b & c) | (~b & d);          k = 0x5A827999; }
+                else if (i < 40) { f = b ^ c ^ d;                   k = 0x6ED9EBA1; }
+                else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+                else             { f = b ^ c ^ d;                   k = 0xCA62C1D6; }
+
+                uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+                e = d; d = c; c = rotl(b, 30); b = a; a = temp;
+            }
+            h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+        }
+    }
+
+    /**
+     * @brief Computes the SHA-1 digest of a buffer.
+     *
+     * @param data Bytes to hash.
+     * @param length Number of bytes.
+     * @return 20-byte digest.
+     */
+    Sha1Digest sha1(const uint8_t* data, std::size_t length) {
+        std::array<uint32_t, 5> h = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+
+        std::size_t full_blocks = length / 64;
+        for (std::size_t i = 0; i < full_blocks; i++) {
+            process_block(data + i * 64, h);
+        }
+
+        // pad: 0x80, zeros, 64-bit big-endian bit length
+        uint8_t tail[128] = {};
+        std::size_t remaining = length - full_blocks * 64;
+        std::memcpy(tail, data + full_blocks * 64, remaining);
+        tail[remaining] = 0x80;
+        std::size_t tail_size = (remaining < 56) ? 64 : 128;
+        uint64_t bit_length = static_cast<uint64_t>(length) * 8;
+        for (int i = 0; i < 8; i++) {
+            tail[tail_size - 1 - i] = static_cast<uint8_t>(bit_length >> (i * 8));
+        }
+        for (std::size_t offset = 0; offset < tail_size; offset += 64) {
+            process_block(tail + offset, h);
+        }
+
+        Sha1Digest digest;
+        for (int i = 0; i < 5; i++) {
+            digest[i * 4]     = static_cast<uint8_t>(h[i] >> 24);
+            digest[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+            digest[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+            digest[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+        }
+        return digest;
+    }
+
+    std::string sha1_to_hex(const Sha1Digest& digest) {
+        static const char* digits = "0123456789abcdef";
+        std::string hex;
+        hex.reserve(40);
+        for (uint8_t byte : digest) {
+            hex.push_back(digits[byte >> 4]);
+            hex.push_back(digits[byte & 0xF]);
+        }
+        return hex;
+    }
+
+    /**
+     * @brief Parses a 40 character hex string (any case) into a digest.
+     *
+     * @return False if the string is not a valid SHA-1 hex digest.
+     */
+    bool sha1_from_hex(const std::string& hex, Sha1Digest& digest) {
+        if (hex.size() != 40) return false;
+        auto nibble = [](char c) -> int {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+        for (std::size_t i = 0; i < 20; i++) {
+            int high = nibble(hex[i * 2]);
+            int low = nibble(hex[i * 2 + 1]);
+            if (high < 0 || low < 0) return false;
+            digest[i] = static_cast<uint8_t>((high << 4) | low);
+        }
+        return true;
+    }
+
+} // Chip8
@@ -0,0 +1,24 @@
+#ifndef SHA1_H
+#define SHA1_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Chip8 {
+
+    using Sha1Digest = std::array<uint8_t, 20>;
+
+    /**
+     * Minimal SHA-1 (FIPS 180-1), used to identify ROMs the same way the
+     * community chip-8-database does. Not meant for anything security related.
+     */
+    Sha1Digest sha1(const uint8_t* data, std::size_t length);
+
+    std::string sha1_to_hex(const Sha1Digest& digest);
+    bool sha1_from_hex(const std::string& hex, Sha1Digest& digest);
+
+} // Chip8
+
+#endif //SHA1_H
@@ -0,0 +1,299 @@
+#include "debugger.h"
+
+#include <format>
+#if defined(__unix__) || defined(__APPLE__)
+#include <poll.h>
+#include <unistd.h>
+#define CHIP8_DEBUGGER_POLL_STDIN 1
+#endif
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace Chip8 {
+    namespace {
+        constexpr uint16_t DEFAULT_DUMP_LENGTH = 64;
+        constexpr std::chrono::milliseconds CONSOLE_POLL_INTERVAL{50};
+
+        const char* HELP_TEXT =
+            "Debugger commands (addresses in hex):\n"
+            "    b <addr>            set breakpoint         bd <addr>        delete breakpoint\n"
+            "    w <addr> [len]      watch writes           r <addr> [len]   watch reads\n"
+            "    wd <addr> [len]     delete watches         l                list breakpoints and watches\n"
+            "    p                   pause                  c                continue\n"
+            "    s [n]               step n instructions    regs             show registers\n"
+            "    mem <addr> [len]    dump memory            help             this text";
+    }
+
+    Debugger::Debugger(std::shared_ptr<Chip> chip) :
+    chip_(std::move(chip)),
+    commands_(std::make_shared<CommandQueue>()),
+    commands_pending_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    Debugger::~Debugger() {
+        if (chip_->memory_observer == this)
+            chip_->set_memory_observer(nullptr);
+    }
+
+    /**
+     * @brief Starts accepting commands from stdin.
+     *
+     * Without stdin polling, a detached thread does the blocking reads; it only touches
+     * the shared command queue, which outlives the Debugger if needed.
+     */
+    void Debugger::start_console() {
+        std::cout << HELP_TEXT << std::endl;
+        console_started_ = true;
+#ifndef CHIP8_DEBUGGER_POLL_STDIN
+        std::thread([commands = commands_, pending = commands_pending_] {
+            std::string line;
+            while (std::getline(std::cin, line)) {
+                if (line.empty()) continue;
+                std::lock_guard<std::mutex> lock(commands->mutex);
+                commands->lines.push_back(line);
+                pending->store(true, std::memory_order_release);
+            }
+        }).detach();
+#endif
+    }
+
+    /**
+     * @brief Whether console commands are waiting to be run.
+     *
+     * With stdin polling, reads whatever is available (never blocks) at most every
+     * CONSOLE_POLL_INTERVAL, so the per-frame cost is a clock read.
+     */
+    bool Debugger::console_ready() {
+#ifdef CHIP8_DEBUGGER_POLL_STDIN
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (!console_started_ || now < next_console_poll_)
+            return commands_pending_->load(std::memory_order_relaxed);
+        next_console_poll_ = now + CONSOLE_POLL_INTERVAL;
+
+        pollfd input{STDIN_FILENO, POLLIN, 0};
+        while (::poll(&input, 1, 0) > 0 && (input.revents & POLLIN)) {
+            char buffer[256];
+            ssize_t count = ::read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (count <= 0) {       // EOF or error: stop polling
+                console_started_ = false;
+                break;
+            }
+            console_input_.append(buffer, static_cast<std::size_t>(count));
+        }
+
+        std::string::size_type newline;
+        while ((newline = console_input_.find('\n')) != std::string::npos) {
+            std::string line = console_input_.substr(0, newline);
+            console_input_.erase(0, newline + 1);
+            if (line.empty()) continue;
+            commands_->lines.push_back(line);     // emulation thread only in this mode
+            commands_pending_->store(true, std::memory_order_relaxed);
+        }
+#endif
+        return commands_pending_->load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Runs the commands typed since the last frame. Emulation thread only.
+     */
+    void Debugger::process_commands() {
+        if (!console_ready()) return;
+
+        std::deque<std::string> lines;
+        {
+            std::lock_guard<std::mutex> lock(commands_->mutex);
+            lines.swap(commands_->lines);
+            commands_pending_->store(false, std::memory_order_relaxed);
+        }
+        for (const std::string& line : lines) {
+            try {
+                execute(line);
+            }
+            catch (const std::exception&) {
+                std::cout << "Invalid command, type help" << std::endl;
+            }
+        }
+    }
+
+    /**
+     * @brief Parses and runs one console command.
+     *
+     * @param command Command line, e.g. "b 2a0" or "s 10".
+     * @throws std::invalid_argument if an argument is not a number.
+     */
+    void Debugger::execute(const std::string& command) {
+        std::istringstream stream(command);
+        std::string name;
+        std::vector<std::string> args;
+        stream >> name;
+        for (std::string arg; stream >> arg;) args.push_back(arg);
+
+        auto address = [&](std::size_t i) {
+            return static_cast<uint16_t>(std::stoul(args.at(i), nullptr, 16));
+        };
+        auto length = [&](std::size_t i, uint16_t fallback) {
+            return i < args.size() ? static_cast<uint16_t>(std::stoul(args[i], nullptr, 16)) : fallback;
+        };
+
+        if (name == "b") {
+            uint16_t addr = address(0);
+            if (!breakpoints_.test(addr)) breakpoint_count_++;
+            breakpoints_.set(addr);
+        }
+        else if (name == "bd") {
+            uint16_t addr = address(0);
+            if (breakpoints_.test(addr)) breakpoint_count_--;
+            breakpoints_.reset(addr);
+        }
+        else if (name == "w") {
+            set_watch(address(0), length(1, 1), false, true, true);
+        }
+        else if (name == "r") {
+            set_watch(address(0), length(1, 1), true, false, true);
+        }
+        else if (name == "wd") {
+            set_watch(address(0), length(1, 1), true, true, false);
+        }
+        else if (name == "l") {
+            print_points();
+        }
+        else if (name == "p") {
+            pause("pause requested");
+        }
+        else if (name == "c") {
+            paused_ = false;
+            skip_breakpoint_ = true;
+        }
+        else if (name == "s") {
+            steps_left_ = args.empty() ? 1 : std::stoul(args[0]);
+            paused_ = false;
+            skip_breakpoint_ = true;
+        }
+        else if (name == "regs") {
+            print_registers();
+        }
+        else if (name == "mem") {
+            print_memory(address(0), length(1, DEFAULT_DUMP_LENGTH));
+        }
+        else if (name == "help") {
+            std::cout << HELP_TEXT << std::endl;
+        }
+        else {
+            std::cout << "Unknown command " << name << ", type help" << std::endl;
+        }
+        update_engaged();
+    }
+
+    /**
+     * @brief Checked before every instruction while engaged.
+     *
+     * @param pc Address of the next instruction.
+     * @return True if execution must stop (paused or breakpoint hit).
+     */
+    bool Debugger::stop_before(uint16_t pc) {
+        if (paused_) return true;
+        if (breakpoints_[pc]) {
+            if (!skip_breakpoint_) {
+                pause("breakpoint");
+                return true;
+            }
+        }
+        skip_breakpoint_ = false;
+        return false;
+    }
+
+    /**
+     * @brief Checked after every instruction while engaged: watch hits and step count.
+     */
+    void Debugger::after_cycle() {
+        if (!watch_hit_.empty()) {
+            std::string hit = std::move(watch_hit_);
+            watch_hit_.clear();
+            pause(hit);
+        }
+        else if (steps_left_ > 0 && --steps_left_ == 0) {
+            pause("step");
+        }
+    }
+
+    void Debugger::on_memory_read(uint16_t addr, uint16_t length) {
+        for (uint16_t i = 0; i < length; i++) {
+            uint16_t watched = static_cast<uint16_t>(addr + i);
+            if (read_watches_[watched]) {
+                watch_hit_ = std::format("read of {:04X} by {:04X}", watched, chip_->program_ctr);
+                return;
+            }
+        }
+    }
+
+    void Debugger::on_memory_write(uint16_t addr, uint16_t length) {
+        for (uint16_t i = 0; i < length; i++) {
+            uint16_t watched = static_cast<uint16_t>(addr + i);
+            if (write_watches_[watched]) {
+                watch_hit_ = std::format("write to {:04X} by {:04X}", watched, chip_->program_ctr);
+                return;
+            }
+        }
+    }
+
+    void Debugger::pause(const std::string& reason) {
+        paused_ = true;
+        steps_left_ = 0;
+        std::cout << std::format(">>> Paused at {:04X} ({})", chip_->program_ctr, reason) << std::endl;
+        print_registers();
+        update_engaged();
+    }
+
+    /**
+     * @brief Sets or clears read/write watches on a range and swaps the core if needed.
+     */
+    void Debugger::set_watch(uint16_t addr, uint16_t length, bool read, bool write, bool enable) {
+        for (uint16_t i = 0; i < length; i++) {
+            uint16_t watched = static_cast<uint16_t>(addr + i);
+            if (read) read_watches_.set(watched, enable);
+            if (write) write_watches_.set(watched, enable);
+        }
+        watch_count_ = (read_watches_ | write_watches_).count();
+
+        MemoryObserver* observer = watch_count_ > 0 ? this : nullptr;
+        if (chip_->memory_observer != observer)
+            chip_->set_memory_observer(observer);
+    }
+
+    void Debugger::update_engaged() {
+        engaged_ = paused_ || steps_left_ > 0 || breakpoint_count_ > 0 || watch_count_ > 0;
+    }
+
+    void Debugger::print_registers() const {
+        const std::array<uint8_t, 16>& v = chip_->registers;
+        uint16_t pc = chip_->program_ctr;
+        uint16_t opcode = static_cast<uint16_t>((chip_->memory[pc] << 8) | chip_->memory[static_cast<uint16_t>(pc + 1)]);
+        std::cout << std::format("    PC={:04X} [{:04X}]  I={:04X}  SP={:X}  DT={:02X}  ST={:02X}",
+            pc, opcode, chip_->index_reg, chip_->stack_ptr, chip_->delay_timer, chip_->sound_timer) << std::endl;
+        std::cout << std::format("    V0-7: {:02X} {:02X} {:02X} {:02X} {:02X} {:02X} {:02X} {:02X}",
+            v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]) << std::endl;
+        std::cout << std::format("    V8-F: {:02X} {:02X} {:02X} {:02X} {:02X} {:02X} {:02X} {:02X}",
+            v[8], v[9], v[10], v[11], v[12], v[13], v[14], v[15]) << std::endl;
+    }
+
+    void Debugger::print_memory(uint16_t addr, uint16_t length) const {
+        for (uint32_t row = 0; row < length; row += 16) {   // uint16_t would wrap for lengths past FFF0
+            std::string line = std::format("    {:04X}:", static_cast<uint16_t>(addr + row));
+            for (uint32_t col = row; col < row + 16 && col < length; col++) {
+                line += std::format(" {:02X}", chip_->memory[static_cast<uint16_t>(addr + col)]);
+            }
+            std::cout << line << std::endl;
+        }
+    }
+
+    void Debugger::print_points() const {
+        for (std::size_t addr = 0; addr < Chip::memory_size; addr++) {
+            if (breakpoints_[addr])
+                std::cout << std::format("    break {:04X}", addr) << std::endl;
+            if (read_watches_[addr] || write_watches_[addr])
+                std::cout << std::format("    watch {:04X} {}{}", addr,
+                    read_watches_[addr] ? "r" : "", write_watches_[addr] ? "w" : "") << std::endl;
+        }
+    }
+} // Chip8
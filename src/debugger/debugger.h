@@ -0,0 +1,91 @@
+#ifndef DEBUGGER_H
+#define DEBUGGER_H
+
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "../hardware/chip.h"
+#include "../hardware/memory_observer.h"
+
+namespace Chip8 {
+
+/**
+ * Interactive debugger: PC breakpoints, memory watchpoints, pause and single-step.
+ *
+ * Breakpoints live in a bitmap with one bit per address, so the check before each
+ * instruction is a single bit test. The platform only enters the checking loop while
+ * engaged() is true (breakpoints or watchpoints set, paused, stepping or commands
+ * waiting); otherwise it runs its normal loop untouched. Watchpoints swap in the
+ * Watched<> instantiation of the instruction core, so the normal core has no hooks.
+ *
+ * Commands are typed on stdin and executed on the emulation thread between frames;
+ * see the `help` command. On POSIX stdin is polled without blocking (at most every
+ * 50 ms) from that thread, since commands have to wait for a frame boundary anyway:
+ * no reader sits blocked in read() at exit and nothing hands lines across threads.
+ * Other platforms fall back to a detached reader thread.
+ */
+class Debugger final : public MemoryObserver {
+public:
+    explicit Debugger(std::shared_ptr<Chip> chip);
+    ~Debugger() override;
+
+    void start_console();
+    void execute(const std::string& command);
+
+    bool engaged() {
+        return engaged_ || console_ready();
+    }
+    bool is_paused() const { return paused_; }
+
+    void process_commands();
+    bool stop_before(uint16_t pc);
+    void after_cycle();
+
+    void on_memory_read(uint16_t addr, uint16_t length) override;
+    void on_memory_write(uint16_t addr, uint16_t length) override;
+
+private:
+    // filled by the console thread, drained on the emulation thread
+    struct CommandQueue {
+        std::mutex mutex;
+        std::deque<std::string> lines;
+    };
+
+    bool console_ready();
+    void pause(const std::string& reason);
+    void set_watch(uint16_t addr, uint16_t length, bool read, bool write, bool enable);
+    void update_engaged();
+    void print_registers() const;
+    void print_memory(uint16_t addr, uint16_t length) const;
+    void print_points() const;
+
+    const std::shared_ptr<Chip> chip_;
+
+    std::bitset<Chip::memory_size> breakpoints_;
+    std::bitset<Chip::memory_size> read_watches_;
+    std::bitset<Chip::memory_size> write_watches_;
+    std::size_t breakpoint_count_{0};
+    std::size_t watch_count_{0};
+
+    bool engaged_{false};
+    bool paused_{false};
+    bool skip_breakpoint_{false};   // resuming from the breakpoint we stopped on
+    uint32_t steps_left_{0};
+    std::string watch_hit_;         // set by the observer, reported after the instruction
+
+    std::shared_ptr<CommandQueue> commands_;
+    std::shared_ptr<std::atomic<bool>> commands_pending_;
+    bool console_started_{false};
+    std::string console_input_;     // partial line read from stdin (POSIX)
+    std::chrono::steady_clock::time_point next_console_poll_{};
+};
+
+} // Chip8
+
+#endif //DEBUGGER_H
@@ -0,0 +1,71 @@
+#include "compositor.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CHIP8_COMPOSITOR_SSE2 1
+#endif
+
+namespace Chip8 {
+    Compositor::Compositor(const Palette& palette) : palette_(palette) {}
+
+    void Compositor::set_palette(const Palette& palette) {
+        palette_ = palette;
+    }
+
+    /**
+     * @brief Composites both bitplanes of the framebuffer into ARGB pixels.
+     *
+     * gfx is stored column-major (gfx[x][y]), so it is first transposed into a
+     * row-major buffer of palette indices. The palette lookup then runs 16 pixels
+     * at a time with SSE2 (compare each index against 0..3 and blend the matching
+     * colors), falling back to a scalar lookup on other targets.
+     *
+     * @param gfx Framebuffer of the chip, one plane mask per pixel.
+     * @param out Destination buffer of width * height ARGB8888 pixels.
+     */
+    void Compositor::composite(const Chip::Gfx& gfx, uint32_t* out) const {
+        alignas(16) std::array<uint8_t, pixel_count> indices;
+        for (int x = 0; x < width; x++) {
+            for (int y = 0; y < height; y++) {
+                indices[y * width + x] = gfx[x][y] & 0x3u;
+            }
+        }
+
+#ifdef CHIP8_COMPOSITOR_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i color[4] = {
+            _mm_set1_epi32(static_cast<int>(palette_[0])),
+            _mm_set1_epi32(static_cast<int>(palette_[1])),
+            _mm_set1_epi32(static_cast<int>(palette_[2])),
+            _mm_set1_epi32(static_cast<int>(palette_[3])),
+        };
+        const __m128i index[4] = {
+            _mm_set1_epi32(0), _mm_set1_epi32(1), _mm_set1_epi32(2), _mm_set1_epi32(3),
+        };
+
+        for (std::size_t i = 0; i < pixel_count; i += 16) {
+            __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(indices.data() + i));
+            __m128i words[2] = { _mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero) };
+
+            for (int half = 0; half < 2; half++) {
+                __m128i lanes[2] = {
+                    _mm_unpacklo_epi16(words[half], zero), _mm_unpackhi_epi16(words[half], zero)
+                };
+                for (int quad = 0; quad < 2; quad++) {
+                    __m128i pixels = _mm_setzero_si128();
+                    for (int c = 0; c < 4; c++) {
+                        __m128i match = _mm_cmpeq_epi32(lanes[quad], index[c]);
+                        pixels = _mm_or_si128(pixels, _mm_and_si128(match, color[c]));
+                    }
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + half * 8 + quad * 4), pixels);
+                }
+            }
+        }
+#else
+        for (std::size_t i = 0; i < pixel_count; i++) {
+            out[i] = palette_[indices[i]];
+        }
+#endif
+    }
+
+} // Chip8
@@ -0,0 +1,44 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include <array>
+#include <cstdint>
+
+#include "../hardware/chip.h"
+
+namespace Chip8 {
+
+/**
+ * Turns the bitplane framebuffer of the Chip into ARGB8888 pixels.
+ *
+ * Every gfx cell holds a 2-bit plane mask (XO-CHIP), which indexes a
+ * 4-color palette: 0 = background, 1 = plane 1, 2 = plane 2, 3 = both.
+ */
+class Compositor {
+public:
+    static constexpr int width = 64;
+    static constexpr int height = 32;
+    static constexpr std::size_t pixel_count = width * height;
+
+    using Palette = std::array<uint32_t, 4>;
+    using Frame = std::array<uint32_t, pixel_count>; // row-major ARGB8888
+
+    explicit Compositor(const Palette& palette = default_palette);
+
+    void set_palette(const Palette& palette);
+    void composite(const Chip::Gfx& gfx, uint32_t* out) const;
+
+    static constexpr Palette default_palette = {
+        0xFF141414, // background (matches Gui::clear)
+        0xFFFFFFFF, // plane 1
+        0xFF5A8CFF, // plane 2
+        0xFFFF6A3D  // planes 1 + 2
+    };
+
+private:
+    alignas(16) Palette palette_;
+};
+
+} // Chip8
+
+#endif //COMPOSITOR_H
@@ -1,11 +1,13 @@
 #include "gui.h"
 
-#include <iostream>
+#include <algorithm>
 
 #include <SDL_events.h>
 #include <SDL_video.h>
 #include <SDL2/SDL.h>
 
+#include "../log/log.h"
+
 namespace Chip8 {
     /**
      * @brief Constructs the GUI with a window, renderer, and palette.
@@ -18,9 +20,11 @@ namespace Chip8 {
      * @param w Width of the window in pixels.
      * @param h Height of the window in pixels.
      * @param is_intro If true, sets up the intro selection screen background color.
+     * @param software_scale If set, no renderer is created: frames are scaled on the CPU
+     *        with this filter and blitted straight into the window surface.
      * @throws std::runtime_error if the SDL window or renderer cannot be created.
      */
-    Gui::Gui(const std::string name, int w, int h, bool is_intro) {
+    Gui::Gui(const std::string name, int w, int h, bool is_intro, std::optional<ScaleFilter> software_scale) {
         width = w;
         height = h;
 
@@ -35,6 +39,11 @@ namespace Chip8 {
         if (!win)
             throw std::runtime_error("gui could not be opened!");
 
+        if (software_scale) {
+            scaler.emplace(*software_scale);
+            return;     // the first render_frame clears and fills the window surface
+        }
+
         this->ren = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED);
         if (!ren)
             throw std::runtime_error("SDL_CreateRenderer failed");
@@ -43,7 +52,7 @@ namespace Chip8 {
 
         // intro display (for rom selection screen)
         if (is_intro) {
-            std::cout << "Running the gui select screen : Select your ROM" << std::endl;
+            LOG_INFO(GFX, "running the gui select screen: select your ROM");
             SDL_SetRenderDrawColor(ren, 50, 50, 200, 255);
         }
         else {
@@ -78,6 +87,11 @@ namespace Chip8 {
         screen_rect = std::make_unique<SDL_Rect>( SDL_Rect{ 0, 0, width, height } );
 
         SDL_FreeSurface(screen_surface);
+
+        frame_texture = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, 64, 32);
+        if (!frame_texture)
+            throw std::runtime_error("SDL_CreateTexture failed");
+
         // one time clear + present so you see something right away
         SDL_RenderClear(ren);
         SDL_RenderCopy(ren, screen_texture, NULL, screen_rect.get());
@@ -109,11 +123,14 @@ namespace Chip8 {
      * Destroys the SDL texture, renderer, and window, and frees the palette colors.
      */
     Gui::~Gui() {
+        if (staging_surface) SDL_FreeSurface(staging_surface);
+        if (overlay_texture) SDL_DestroyTexture(overlay_texture);
+        if (frame_texture) SDL_DestroyTexture(frame_texture);
         if (screen_texture) SDL_DestroyTexture(screen_texture);
         if (ren) SDL_DestroyRenderer(ren);
         if (win) SDL_DestroyWindow(win);
         if (colors) free(colors);
-        ren = nullptr; win = nullptr; screen_texture = nullptr; screen_rect = nullptr;
+        ren = nullptr; win = nullptr; screen_texture = nullptr; frame_texture = nullptr; screen_rect = nullptr;
     }
 
     /**
@@ -122,6 +139,7 @@ namespace Chip8 {
      * Sets the draw color to a dark grey and clears the current rendering target.
      */
     void Gui::clear() {
+        if (scaler) return;     // blit_to_window owns the whole surface
         SDL_SetRenderDrawColor(ren, 20, 20, 20, 255);
         SDL_RenderClear(ren);
     }
@@ -132,6 +150,28 @@ namespace Chip8 {
      * Useful for idle or static frames where only presenting is needed.
      */
     void Gui::present_idle() {
+        if (scaler) {
+            SDL_UpdateWindowSurface(win);
+            return;
+        }
+        SDL_RenderPresent(ren);
+    }
+
+    /**
+     * @brief Shows the intro background (no ROM loaded yet) and presents it.
+     */
+    void Gui::present_intro() {
+        if (scaler) {
+            SDL_Surface* surface = SDL_GetWindowSurface(win);
+            if (surface) {
+                SDL_FillRect(surface, nullptr, SDL_MapRGB(surface->format, 50, 50, 200));
+                surface_width = 0;  // the next frame repaints its border
+                SDL_UpdateWindowSurface(win);
+            }
+            return;
+        }
+        SDL_SetRenderDrawColor(ren, 50, 50, 200, 255);
+        SDL_RenderClear(ren);
         SDL_RenderPresent(ren);
     }
 
@@ -145,7 +185,7 @@ namespace Chip8 {
      */
     void Gui::draw_pixel(int col, int row, bool on)
     {
-        if (!on) return;
+        if (!on || !ren) return;
         SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
 
         SDL_Rect r{col, row, 1, 1}; // draws a 1x1 logical pixel in canvas always
@@ -162,8 +202,124 @@ namespace Chip8 {
      * @return The result code from SDL_RenderCopy (0 on success, negative on failure).
      */
     int Gui::update_texture(uint8_t* gfx_ptr) {
+        if (!ren) return -1;
         SDL_UpdateTexture(screen_texture, nullptr, gfx_ptr, width * sizeof(uint8_t));
         return SDL_RenderCopy(ren, screen_texture, NULL, screen_rect.get());
     }
 
+    /**
+     * @brief Uploads a composited frame and renders it over the whole logical canvas.
+     *
+     * @param pixels 64x32 row-major ARGB8888 pixels (see Compositor::composite).
+     * @param overlay PerfOverlay::width x height ARGB8888 pixels alpha blended over the
+     *        whole game screen, or nullptr for none.
+     * @return The result code from SDL_RenderCopy (0 on success, negative on failure).
+     */
+    int Gui::render_frame(const uint32_t* pixels, const uint32_t* overlay) {
+        if (scaler)
+            return blit_to_window(pixels, overlay);
+
+        SDL_UpdateTexture(frame_texture, nullptr, pixels, 64 * sizeof(uint32_t));
+        int status = SDL_RenderCopy(ren, frame_texture, nullptr, nullptr);
+        if (!overlay || status != 0)
+            return status;
+
+        if (!overlay_texture) {
+            overlay_texture = SDL_CreateTexture(ren, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                PerfOverlay::width, PerfOverlay::height);
+            if (!overlay_texture)
+                return -1;
+            SDL_SetTextureBlendMode(overlay_texture, SDL_BLENDMODE_BLEND);
+        }
+        SDL_UpdateTexture(overlay_texture, nullptr, overlay, PerfOverlay::width * sizeof(uint32_t));
+        return SDL_RenderCopy(ren, overlay_texture, nullptr, nullptr);
+    }
+
+    /**
+     * @brief Alpha blends the overlay onto a 32-bit XRGB/ARGB area, each overlay pixel
+     * covering a scale x scale block, clipped to width x height.
+     *
+     * Only the panel has non-zero alpha, so the transparent rest costs one compare a pixel.
+     */
+    void Gui::blend_overlay(const uint32_t* overlay, uint8_t* origin, int pitch, int width, int height) {
+        const int scale = std::max(1, width / PerfOverlay::width);
+        for (int oy = 0; oy < PerfOverlay::height && oy * scale < height; oy++) {
+            for (int ox = 0; ox < PerfOverlay::width && ox * scale < width; ox++) {
+                const uint32_t src = overlay[oy * PerfOverlay::width + ox];
+                const uint32_t alpha = src >> 24;
+                if (alpha == 0)
+                    continue;
+
+                for (int y = oy * scale; y < std::min((oy + 1) * scale, height); y++) {
+                    auto* line = reinterpret_cast<uint32_t*>(origin + static_cast<std::size_t>(y) * pitch);
+                    for (int x = ox * scale; x < std::min((ox + 1) * scale, width); x++) {
+                        const uint32_t dst = line[x];
+                        uint32_t out = dst & 0xFF000000u;
+                        for (int shift = 0; shift < 24; shift += 8) {
+                            const uint32_t s = (src >> shift) & 0xFF;
+                            const uint32_t d = (dst >> shift) & 0xFF;
+                            out |= ((s * alpha + d * (255 - alpha)) / 255) << shift;
+                        }
+                        line[x] = out;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Software path of render_frame: scales the frame by the largest integer factor
+     * that fits the window and centers it on the window surface.
+     *
+     * 32-bit XRGB/ARGB surfaces are written in place. Other formats get the frame scaled
+     * into an ARGB8888 staging surface first and converted by SDL_BlitSurface. The border
+     * is only repainted when the surface changes size.
+     *
+     * @param pixels 64x32 row-major ARGB8888 pixels (see Compositor::composite).
+     * @return 0 on success, negative if the window surface is unavailable.
+     */
+    int Gui::blit_to_window(const uint32_t* pixels, const uint32_t* overlay) {
+        SDL_Surface* surface = SDL_GetWindowSurface(win);
+        if (!surface)
+            return -1;
+        if (surface->w < Compositor::width || surface->h < Compositor::height)
+            return 0;   // minimized or smaller than one pixel per cell
+
+        if (surface->w != surface_width || surface->h != surface_height) {
+            SDL_FillRect(surface, nullptr, SDL_MapRGB(surface->format, 20, 20, 20));
+            surface_width = surface->w;
+            surface_height = surface->h;
+        }
+
+        const int factor = scaler->output_factor(Scaler::fit_factor(surface->w, surface->h));
+        SDL_Rect target{ 0, 0, Compositor::width * factor, Compositor::height * factor };
+        target.x = (surface->w - target.w) / 2;
+        target.y = (surface->h - target.h) / 2;
+
+        const uint32_t format = surface->format->format;
+        if (format == SDL_PIXELFORMAT_ARGB8888 || format == SDL_PIXELFORMAT_RGB888) {
+            if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0)
+                return -1;
+            auto* origin = static_cast<uint8_t*>(surface->pixels)
+                + static_cast<std::size_t>(target.y) * surface->pitch + static_cast<std::size_t>(target.x) * 4;
+            scaler->scale(pixels, factor, reinterpret_cast<uint32_t*>(origin), surface->pitch);
+            if (overlay)
+                blend_overlay(overlay, origin, surface->pitch, target.w, target.h);
+            if (SDL_MUSTLOCK(surface))
+                SDL_UnlockSurface(surface);
+            return 0;
+        }
+
+        if (!staging_surface || staging_surface->w != target.w || staging_surface->h != target.h) {
+            if (staging_surface) SDL_FreeSurface(staging_surface);
+            staging_surface = SDL_CreateRGBSurfaceWithFormat(0, target.w, target.h, 32, SDL_PIXELFORMAT_ARGB8888);
+            if (!staging_surface)
+                return -1;
+        }
+        scaler->scale(pixels, factor, static_cast<uint32_t*>(staging_surface->pixels), staging_surface->pitch);
+        if (overlay)
+            blend_overlay(overlay, static_cast<uint8_t*>(staging_surface->pixels), staging_surface->pitch, target.w, target.h);
+        return SDL_BlitSurface(staging_surface, nullptr, surface, &target);
+    }
+
 }
@@ -2,29 +2,44 @@
 #define GUI_H
 
 #include <memory>
+#include <optional>
 #include <SDL_render.h>
 #include <SDL_video.h>
 #include <string>
 
+#include "compositor.h"
+#include "perf_overlay.h"
+#include "scaler.h"
+
 namespace Chip8 {
 
 class Gui {
     public:
-        Gui(const std::string name, int width, int height, bool is_demo); // constructor
+        Gui(const std::string name, int width, int height, bool is_demo,
+            std::optional<ScaleFilter> software_scale = std::nullopt); // constructor
         ~Gui();
         void clear();
         void present_idle();
+        void present_intro();
         bool input_rom_path(std::string rom_path);
         void draw_pixel(int col, int row /* int scale */, bool on); // on, paint white, off is nothing
 
         int update_texture(uint8_t* gfx_ptr);
+        int render_frame(const uint32_t* pixels, const uint32_t* overlay = nullptr); // 64x32 ARGB8888 from Compositor, PerfOverlay on top
 
     private:
         SDL_Window* win = nullptr;
-        SDL_Texture*  screen_texture;
+        SDL_Texture*  screen_texture = nullptr;
+        SDL_Texture*  frame_texture = nullptr;  // streaming 64x32 ARGB8888
+        SDL_Texture*  overlay_texture = nullptr;  // streaming PerfOverlay, alpha blended, created on first use
         std::unique_ptr<SDL_Rect> screen_rect;
         SDL_Renderer* ren = nullptr;
-        SDL_Color* colors;
+        SDL_Color* colors = nullptr;
+
+        std::optional<Scaler> scaler;               // set: blit into the window surface, no renderer
+        SDL_Surface* staging_surface = nullptr;     // ARGB8888 frame when the window surface is another format
+        int surface_width = 0;
+        int surface_height = 0;
 
         uint8_t width;
         uint8_t height;
@@ -32,6 +47,8 @@ class Gui {
         bool intro;
 
         SDL_Color* init_colors();
+        int blit_to_window(const uint32_t* pixels, const uint32_t* overlay);
+        static void blend_overlay(const uint32_t* overlay, uint8_t* origin, int pitch, int width, int height);
 };
 
 } // Chip8
@@ -0,0 +1,143 @@
+#include "perf_overlay.h"
+
+#include <algorithm>
+#include <format>
+
+namespace Chip8 {
+    namespace {
+        constexpr uint32_t PANEL = 0xB0000000;      // translucent black
+        constexpr uint32_t TEXT = 0xFFFFFFFF;
+        constexpr uint32_t DIM_TEXT = 0xFFA0A0A0;
+        constexpr uint32_t BAR = 0xFF4CD964;
+        constexpr uint32_t SLOW_BAR = 0xFFFF6A3D;   // frames longer than the 60 Hz period
+        constexpr uint32_t TARGET = 0xFF5A8CFF;     // 16.7 ms marker
+
+        constexpr int GLYPH_W = 3;
+        constexpr int GLYPH_H = 5;
+        constexpr int LINE_H = GLYPH_H + 2;
+        constexpr int HISTOGRAM_H = 28;
+
+        struct Glyph {
+            char c;
+            uint16_t rows;  // 5 rows of 3 bits, top row in bits 14-12, leftmost pixel first
+        };
+
+        constexpr uint16_t rows(uint16_t r0, uint16_t r1, uint16_t r2, uint16_t r3, uint16_t r4) {
+            return static_cast<uint16_t>(r0 << 12 | r1 << 9 | r2 << 6 | r3 << 3 | r4);
+        }
+
+        constexpr Glyph FONT[] = {
+            {'0', rows(7, 5, 5, 5, 7)}, {'1', rows(2, 6, 2, 2, 7)}, {'2', rows(7, 1, 7, 4, 7)},
+            {'3', rows(7, 1, 7, 1, 7)}, {'4', rows(5, 5, 7, 1, 1)}, {'5', rows(7, 4, 7, 1, 7)},
+            {'6', rows(7, 4, 7, 5, 7)}, {'7', rows(7, 1, 1, 2, 2)}, {'8', rows(7, 5, 7, 5, 7)},
+            {'9', rows(7, 5, 7, 1, 7)}, {'A', rows(2, 5, 7, 5, 5)}, {'B', rows(6, 5, 6, 5, 6)},
+            {'C', rows(3, 4, 4, 4, 3)}, {'D', rows(6, 5, 5, 5, 6)}, {'E', rows(7, 4, 6, 4, 7)},
+            {'F', rows(7, 4, 6, 4, 4)}, {'G', rows(3, 4, 5, 5, 3)}, {'H', rows(5, 5, 7, 5, 5)},
+            {'I', rows(7, 2, 2, 2, 7)}, {'K', rows(5, 5, 6, 5, 5)}, {'L', rows(4, 4, 4, 4, 7)},
+            {'M', rows(5, 7, 7, 5, 5)}, {'N', rows(6, 5, 5, 5, 5)}, {'O', rows(2, 5, 5, 5, 2)},
+            {'P', rows(6, 5, 6, 4, 4)}, {'R', rows(6, 5, 6, 5, 5)}, {'S', rows(3, 4, 2, 1, 6)},
+            {'T', rows(7, 2, 2, 2, 2)}, {'U', rows(5, 5, 5, 5, 7)}, {'V', rows(5, 5, 5, 5, 2)},
+            {'W', rows(5, 5, 7, 7, 5)}, {'X', rows(5, 5, 2, 5, 5)}, {'Y', rows(5, 5, 2, 2, 2)},
+            {'Z', rows(7, 1, 2, 4, 7)}, {'.', rows(0, 0, 0, 0, 2)}, {':', rows(0, 2, 0, 2, 0)},
+            {'/', rows(1, 1, 2, 4, 4)}, {'-', rows(0, 0, 7, 0, 0)}, {'+', rows(0, 2, 7, 2, 0)},
+        };
+
+        uint16_t glyph(char c) {
+            for (const Glyph& g : FONT) {
+                if (g.c == c) return g.rows;
+            }
+            return 0;   // space and anything unknown
+        }
+
+        double ms(std::chrono::microseconds us) {
+            return us.count() / 1000.0;
+        }
+    }
+
+    void PerfOverlay::record(const FrameTiming& timing) {
+        frames_[next_] = timing;
+        next_ = (next_ + 1) % history;
+        count_ = std::min(count_ + 1, history);
+    }
+
+    /**
+     * @brief Draws the panel: numbers averaged over the last average_window frames,
+     * histogram over the whole history.
+     *
+     * @param pixels Destination of width * height ARGB8888 pixels, overwritten completely.
+     */
+    void PerfOverlay::draw(uint32_t* pixels) const {
+        std::fill_n(pixels, static_cast<std::size_t>(width) * height, 0u);
+
+        const std::size_t averaged = std::min(count_, average_window);
+        std::chrono::microseconds emulate{0}, render{0}, present{0}, sleep{0}, interval{0};
+        uint64_t instructions = 0;
+        for (std::size_t i = 0; i < averaged; i++) {
+            const FrameTiming& frame = frames_[(next_ + history - 1 - i) % history];
+            emulate += frame.emulate;
+            render += frame.render;
+            present += frame.present;
+            sleep += frame.sleep;
+            interval += frame.interval;
+            instructions += frame.instructions;
+        }
+
+        const double n = averaged ? static_cast<double>(averaged) : 1.0;
+        const double seconds = interval.count() / 1e6;
+        const double fps = seconds > 0 ? averaged / seconds : 0.0;
+        const double ips = seconds > 0 ? instructions / seconds : 0.0;
+        const double busy = (ms(emulate) + ms(render) + ms(present)) / n;
+
+        const int panel_h = 4 * LINE_H + 2 + HISTOGRAM_H + 4;
+        fill_rect(pixels, 0, 0, width, panel_h, PANEL);
+
+        int y = 2;
+        draw_text(pixels, 2, y, std::format("FPS {:.1f}  FRAME {:.2f} MS  IPF {}", fps, busy, ipf_), TEXT);
+        y += LINE_H;
+        draw_text(pixels, 2, y, ips >= 1e6 ? std::format("IPS {:.2f}M", ips / 1e6) : std::format("IPS {:.1f}K", ips / 1e3), TEXT);
+        draw_text(pixels, 96, y, std::format("UNDERRUNS {}", audio_underruns_), audio_underruns_ ? SLOW_BAR : TEXT);
+        y += LINE_H;
+        draw_text(pixels, 2, y, std::format("EMU {:.2f} RND {:.2f} PRS {:.2f} SLP {:.2f}",
+            ms(emulate) / n, ms(render) / n, ms(present) / n, ms(sleep) / n), TEXT);
+        y += LINE_H;
+        draw_text(pixels, 2, y, std::format("FRAME TIME 0-{} MS, LAST {}", histogram_buckets - 1, count_), DIM_TEXT);
+        y += LINE_H + 1;
+
+        // Histogram of frame intervals, one 1 ms bucket per 5 px column
+        std::array<uint32_t, histogram_buckets> buckets{};
+        for (std::size_t i = 0; i < count_; i++) {
+            const std::size_t bucket = std::min<std::size_t>(frames_[i].interval.count() / 1000, histogram_buckets - 1);
+            buckets[bucket]++;
+        }
+        const uint32_t tallest = std::max<uint32_t>(1, *std::max_element(buckets.begin(), buckets.end()));
+        const int base = y + HISTOGRAM_H;
+        for (int b = 0; b < histogram_buckets; b++) {
+            const int x = 2 + b * 5;
+            int bar = static_cast<int>((static_cast<uint64_t>(buckets[b]) * HISTOGRAM_H + tallest - 1) / tallest);
+            fill_rect(pixels, x, base - bar, 4, bar, b > 16 ? SLOW_BAR : BAR);
+        }
+        fill_rect(pixels, 2 + 16 * 5 + 4, y, 1, HISTOGRAM_H, TARGET);  // 16.7 ms: the gap after bucket 16
+        fill_rect(pixels, 2, base, histogram_buckets * 5 - 1, 1, DIM_TEXT);
+    }
+
+    void PerfOverlay::draw_text(uint32_t* pixels, int x, int y, const std::string& text, uint32_t color) const {
+        for (char c : text) {
+            if (x + GLYPH_W > width) return;
+            const uint16_t bits = glyph(c);
+            for (int row = 0; row < GLYPH_H; row++) {
+                for (int col = 0; col < GLYPH_W; col++) {
+                    if (bits >> ((GLYPH_H - 1 - row) * GLYPH_W + (GLYPH_W - 1 - col)) & 1u)
+                        pixels[(y + row) * width + x + col] = color;
+                }
+            }
+            x += GLYPH_W + 1;
+        }
+    }
+
+    void PerfOverlay::fill_rect(uint32_t* pixels, int x, int y, int w, int h, uint32_t color) {
+        for (int row = std::max(y, 0); row < std::min(y + h, height); row++) {
+            std::fill_n(pixels + row * width + std::max(x, 0), std::max(0, std::min(x + w, width) - std::max(x, 0)), color);
+        }
+    }
+
+} // Chip8
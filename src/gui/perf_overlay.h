@@ -0,0 +1,59 @@
+#ifndef PERF_OVERLAY_H
+#define PERF_OVERLAY_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Chip8 {
+
+/**
+ * Where the time of one Platform::run_frame went.
+ */
+struct FrameTiming {
+    std::chrono::microseconds emulate;      // instructions and timers
+    std::chrono::microseconds render;       // composite, texture upload, overlay
+    std::chrono::microseconds present;
+    std::chrono::microseconds sleep;        // pacing to the 60 Hz period
+    std::chrono::microseconds interval;     // start of the previous frame to start of this one
+    uint32_t instructions;                  // actually executed (not the budget)
+};
+
+/**
+ * Keeps the timings of the last frames and draws them as a small ARGB overlay:
+ * FPS, host frame time, instructions per second, the emulate/render/present/sleep
+ * split, audio underruns and a histogram of frame intervals.
+ *
+ * Recording is a ring buffer write, so it runs every frame and the overlay shows
+ * full history as soon as it is toggled on. Text uses a built-in 3x5 font.
+ */
+class PerfOverlay {
+public:
+    static constexpr int width = 192;           // stretched over the whole game screen
+    static constexpr int height = 96;
+    static constexpr std::size_t history = 240;         // frames kept for the histogram
+    static constexpr std::size_t average_window = 60;   // frames averaged for the numbers
+    static constexpr int histogram_buckets = 34;        // 1 ms each, the last one is 33+ ms
+
+    void record(const FrameTiming& timing);
+    void set_audio_underruns(uint32_t underruns) { audio_underruns_ = underruns; }
+    void set_ipf(unsigned ipf) { ipf_ = ipf; }
+
+    void draw(uint32_t* pixels) const;     // width * height ARGB8888, transparent outside the panel
+
+private:
+    void draw_text(uint32_t* pixels, int x, int y, const std::string& text, uint32_t color) const;
+    static void fill_rect(uint32_t* pixels, int x, int y, int w, int h, uint32_t color);
+
+    std::array<FrameTiming, history> frames_{};
+    std::size_t next_{0};
+    std::size_t count_{0};
+    uint32_t audio_underruns_{0};
+    unsigned ipf_{0};
+};
+
+} // Chip8
+
+#endif //PERF_OVERLAY_H
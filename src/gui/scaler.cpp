@@ -0,0 +1,197 @@
+#include "scaler.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CHIP8_SCALER_SSE2 1
+#endif
+
+namespace Chip8 {
+    Scaler::Scaler(ScaleFilter filter) : filter_(filter) {}
+
+    /**
+     * @brief Factor the output is actually scaled by for a requested factor.
+     *
+     * Scale2x/Scale3x can only produce multiples of 2/3; anything in between is
+     * rounded down, and factors too small for the filter use nearest neighbour.
+     */
+    int Scaler::output_factor(int factor) const {
+        const int step = filter_ == ScaleFilter::SCALE2X ? 2 : filter_ == ScaleFilter::SCALE3X ? 3 : 1;
+        if (factor < step)
+            return std::max(factor, 1);
+        return factor / step * step;
+    }
+
+    /**
+     * @brief Largest integer factor whose 64x32 multiple fits in the given area (at least 1).
+     */
+    int Scaler::fit_factor(int dst_width, int dst_height) {
+        return std::max(1, std::min(dst_width / Compositor::width, dst_height / Compositor::height));
+    }
+
+    /**
+     * @brief Scales one composited frame into dst.
+     *
+     * @param src    64x32 row-major ARGB8888 pixels (see Compositor::composite).
+     * @param factor Requested integer factor, adjusted by output_factor().
+     * @param dst    Top-left output pixel; must hold 64 * 32 * output_factor()^2 pixels.
+     * @param dst_pitch Bytes between the starts of two output rows (SDL_Surface::pitch).
+     */
+    void Scaler::scale(const uint32_t* src, int factor, uint32_t* dst, std::size_t dst_pitch) {
+        factor = output_factor(factor);
+
+        if (filter_ == ScaleFilter::SCALE2X && factor >= 2) {
+            smoothed_.resize(Compositor::pixel_count * 4);
+            scale2x(src, Compositor::width, Compositor::height, smoothed_.data());
+            replicate(smoothed_.data(), Compositor::width * 2, Compositor::height * 2, factor / 2,
+                      dst, dst_pitch, row_);
+        }
+        else if (filter_ == ScaleFilter::SCALE3X && factor >= 3) {
+            smoothed_.resize(Compositor::pixel_count * 9);
+            scale3x(src, Compositor::width, Compositor::height, smoothed_.data());
+            replicate(smoothed_.data(), Compositor::width * 3, Compositor::height * 3, factor / 3,
+                      dst, dst_pitch, row_);
+        }
+        else {
+            replicate(src, Compositor::width, Compositor::height, factor, dst, dst_pitch, row_);
+        }
+    }
+
+    /**
+     * @brief Nearest-neighbour replication of src by factor.
+     *
+     * Each source row is expanded once into `row` (SSE2 broadcasts; every store may spill
+     * past its pixel, the next pixel overwrites the spill) and then copied to its factor
+     * output rows. Whole cache lines of 4-byte aligned output rows go through non-temporal
+     * stores (the frame is far larger than the cache and nobody reads it back on the CPU);
+     * the partial lines at both ends use plain stores, which is much cheaper than letting
+     * the write-combining buffers flush half-filled lines.
+     */
+    void Scaler::replicate(const uint32_t* src, int src_width, int src_height, int factor,
+                           uint32_t* dst, std::size_t dst_pitch, std::vector<uint32_t>& row) {
+        const std::size_t out_width = static_cast<std::size_t>(src_width) * factor;
+        row.resize(out_width + 4);     // room for the spill of the last store
+        auto* out = reinterpret_cast<uint8_t*>(dst);
+
+        for (int y = 0; y < src_height; y++) {
+            const uint32_t* in = src + static_cast<std::size_t>(y) * src_width;
+
+#ifdef CHIP8_SCALER_SSE2
+            for (int x = 0; x < src_width; x++) {
+                const __m128i pixel = _mm_set1_epi32(static_cast<int>(in[x]));
+                uint32_t* run = row.data() + static_cast<std::size_t>(x) * factor;
+                for (int i = 0; i < factor; i += 4) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(run + i), pixel);
+                }
+            }
+
+            for (int copy = 0; copy < factor; copy++, out += dst_pitch) {
+                auto* line = reinterpret_cast<uint32_t*>(out);
+                const std::size_t misalignment = reinterpret_cast<uintptr_t>(line) & 63u;
+                if (misalignment & 3u) {
+                    std::memcpy(line, row.data(), out_width * sizeof(uint32_t));
+                    continue;
+                }
+
+                const std::size_t head = std::min(out_width, ((64 - misalignment) & 63u) / sizeof(uint32_t));
+                const std::size_t body_end = head + (out_width - head) / 16 * 16;
+                std::memcpy(line, row.data(), head * sizeof(uint32_t));
+                for (std::size_t i = head; i < body_end; i += 4) {
+                    _mm_stream_si128(reinterpret_cast<__m128i*>(line + i),
+                                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(row.data() + i)));
+                }
+                std::memcpy(line + body_end, row.data() + body_end, (out_width - body_end) * sizeof(uint32_t));
+            }
+#else
+            for (int x = 0; x < src_width; x++) {
+                std::fill_n(row.data() + static_cast<std::size_t>(x) * factor, factor, in[x]);
+            }
+            for (int copy = 0; copy < factor; copy++, out += dst_pitch) {
+                std::memcpy(out, row.data(), out_width * sizeof(uint32_t));
+            }
+#endif
+        }
+
+#ifdef CHIP8_SCALER_SSE2
+        _mm_sfence();  // make the streamed rows visible before the surface is presented
+#endif
+    }
+
+    /**
+     * @brief Scale2x (EPX): each pixel becomes a 2x2 block whose corners take the color
+     * of two matching orthogonal neighbours. Edges repeat the border pixel.
+     *
+     * The intermediate is only 2048 source pixels, so this stays scalar.
+     */
+    void Scaler::scale2x(const uint32_t* src, int width, int height, uint32_t* dst) {
+        const int out_width = width * 2;
+        for (int y = 0; y < height; y++) {
+            const uint32_t* above = src + std::max(y - 1, 0) * width;
+            const uint32_t* here = src + y * width;
+            const uint32_t* below = src + std::min(y + 1, height - 1) * width;
+            uint32_t* top = dst + (y * 2) * out_width;
+            uint32_t* bottom = top + out_width;
+
+            for (int x = 0; x < width; x++) {
+                const int left = std::max(x - 1, 0);
+                const int right = std::min(x + 1, width - 1);
+                const uint32_t b = above[x], d = here[left], e = here[x], f = here[right], h = below[x];
+
+                if (b != h && d != f) {
+                    top[x * 2]        = d == b ? d : e;
+                    top[x * 2 + 1]    = b == f ? f : e;
+                    bottom[x * 2]     = d == h ? d : e;
+                    bottom[x * 2 + 1] = h == f ? f : e;
+                }
+                else {
+                    top[x * 2] = top[x * 2 + 1] = bottom[x * 2] = bottom[x * 2 + 1] = e;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Scale3x (AdvMAME3x): each pixel becomes a 3x3 block, corners as in Scale2x
+     * and edge midpoints only where the diagonal continues. Edges repeat the border pixel.
+     */
+    void Scaler::scale3x(const uint32_t* src, int width, int height, uint32_t* dst) {
+        const int out_width = width * 3;
+        for (int y = 0; y < height; y++) {
+            const uint32_t* above = src + std::max(y - 1, 0) * width;
+            const uint32_t* here = src + y * width;
+            const uint32_t* below = src + std::min(y + 1, height - 1) * width;
+            uint32_t* r0 = dst + (y * 3) * out_width;
+            uint32_t* r1 = r0 + out_width;
+            uint32_t* r2 = r1 + out_width;
+
+            for (int x = 0; x < width; x++) {
+                const int left = std::max(x - 1, 0);
+                const int right = std::min(x + 1, width - 1);
+                const uint32_t a = above[left], b = above[x], c = above[right];
+                const uint32_t d = here[left],  e = here[x],  f = here[right];
+                const uint32_t g = below[left], h = below[x], i = below[right];
+                uint32_t* o0 = r0 + x * 3;
+                uint32_t* o1 = r1 + x * 3;
+                uint32_t* o2 = r2 + x * 3;
+
+                if (b != h && d != f) {
+                    o0[0] = d == b ? d : e;
+                    o0[1] = (d == b && e != c) || (b == f && e != a) ? b : e;
+                    o0[2] = b == f ? f : e;
+                    o1[0] = (d == b && e != g) || (d == h && e != a) ? d : e;
+                    o1[1] = e;
+                    o1[2] = (b == f && e != i) || (h == f && e != c) ? f : e;
+                    o2[0] = d == h ? d : e;
+                    o2[1] = (d == h && e != i) || (h == f && e != g) ? h : e;
+                    o2[2] = h == f ? f : e;
+                }
+                else {
+                    o0[0] = o0[1] = o0[2] = o1[0] = o1[1] = o1[2] = o2[0] = o2[1] = o2[2] = e;
+                }
+            }
+        }
+    }
+
+} // Chip8
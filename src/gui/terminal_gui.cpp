@@ -0,0 +1,225 @@
+#include "terminal_gui.h"
+
+#include <cstdio>
+#include <format>
+#include <stdexcept>
+
+#ifdef CHIP8_TERMINAL_POSIX
+#include <unistd.h>
+#endif
+
+namespace Chip8 {
+#ifdef CHIP8_TERMINAL_POSIX
+    namespace {
+        constexpr const char* ENTER_SCREEN = "\x1b[?1049h\x1b[?25l\x1b[2J";    // alternate screen, hide cursor, clear
+        constexpr const char* LEAVE_SCREEN = "\x1b[0m\x1b[?25h\x1b[?1049l";
+
+        // braille dot bit for pixel (x, y) of a 2x4 cell (U+2800 block layout)
+        constexpr uint8_t BRAILLE_DOTS[4][2] = { {0x01, 0x08}, {0x02, 0x10}, {0x04, 0x20}, {0x40, 0x80} };
+
+        constexpr char CTRL_C = 0x03;
+        constexpr char ESC = 0x1b;
+
+        void write_all(const std::string& data) {
+            std::size_t done = 0;
+            while (done < data.size()) {
+                ssize_t n = ::write(STDOUT_FILENO, data.data() + done, data.size() - done);
+                if (n <= 0) return;     // terminal went away, nothing useful left to do
+                done += static_cast<std::size_t>(n);
+            }
+        }
+    }
+
+    /**
+     * @brief Switches the terminal to the alternate screen and, if stdin is a terminal,
+     * to raw non-blocking input.
+     *
+     * @param glyphs     Braille (32x8 cells) or half blocks (64x16 cells).
+     * @param background ARGB color that counts as an unlit pixel for braille output.
+     */
+    TerminalGui::TerminalGui(TerminalGlyphs glyphs, uint32_t background) :
+    glyphs_(glyphs),
+    background_(background),
+    rows_(glyphs == TerminalGlyphs::BRAILLE ? Compositor::height / 4 : Compositor::height / 2),
+    cols_(glyphs == TerminalGlyphs::BRAILLE ? Compositor::width / 2 : Compositor::width),
+    cells_(static_cast<std::size_t>(rows_) * cols_, 0)
+    {
+        if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &saved_termios_) == 0) {
+            termios raw = saved_termios_;
+            raw.c_iflag &= ~static_cast<tcflag_t>(ICRNL | IXON | BRKINT | ISTRIP);
+            raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO | ISIG | IEXTEN);
+            raw.c_cc[VMIN] = 0;     // read() returns at once with whatever is there
+            raw.c_cc[VTIME] = 0;
+            raw_ = tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0;
+        }
+
+        std::fflush(stdout);    // anything printed before must land above, not inside, the screen
+        write_all(ENTER_SCREEN);
+        out_.reserve(4096);
+    }
+
+    TerminalGui::~TerminalGui() {
+        write_all(LEAVE_SCREEN);
+        if (raw_)
+            tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved_termios_);
+    }
+
+    /**
+     * @brief Reduces the frame to cells and writes the ones that changed.
+     *
+     * The first frame is written in full. All output of a frame goes out in one write().
+     *
+     * @param pixels 64x32 row-major ARGB8888 pixels (see Compositor::composite).
+     */
+    void TerminalGui::render_frame(const uint32_t* pixels) {
+        out_.clear();
+        const bool full_redraw = !drawn_;
+        drawn_ = true;
+
+        for (int row = 0; row < rows_; row++) {
+            for (int col = 0; col < cols_; col++) {
+                uint64_t cell = 0;
+                if (glyphs_ == TerminalGlyphs::BRAILLE) {
+                    for (int dy = 0; dy < 4; dy++) {
+                        const uint32_t* line = pixels + (row * 4 + dy) * Compositor::width + col * 2;
+                        if (line[0] != background_) cell |= BRAILLE_DOTS[dy][0];
+                        if (line[1] != background_) cell |= BRAILLE_DOTS[dy][1];
+                    }
+                }
+                else {
+                    const uint32_t top = pixels[(row * 2) * Compositor::width + col];
+                    const uint32_t bottom = pixels[(row * 2 + 1) * Compositor::width + col];
+                    cell = (static_cast<uint64_t>(top) << 32) | bottom;
+                }
+
+                uint64_t& shown = cells_[static_cast<std::size_t>(row) * cols_ + col];
+                if (cell == shown && !full_redraw)
+                    continue;
+                shown = cell;
+
+                move_cursor(row, col);
+                append_cell(cell);
+                cursor_col_++;
+            }
+        }
+
+        if (!out_.empty()) {
+            write_all(out_);
+            bytes_written_ += out_.size();
+        }
+    }
+
+    /**
+     * @brief Appends a cursor move to (row, col) unless the cursor is already there.
+     */
+    void TerminalGui::move_cursor(int row, int col) {
+        if (row == cursor_row_ && col == cursor_col_)
+            return;
+        std::format_to(std::back_inserter(out_), "\x1b[{};{}H", row + 1, col + 1);
+        cursor_row_ = row;
+        cursor_col_ = col;
+    }
+
+    /**
+     * @brief Appends the glyph of one cell (and its colors, when they differ from the
+     * colors currently set) as UTF-8.
+     */
+    void TerminalGui::append_cell(uint64_t cell) {
+        if (glyphs_ == TerminalGlyphs::BRAILLE) {
+            const uint32_t code_point = 0x2800 + static_cast<uint32_t>(cell);
+            out_ += static_cast<char>(0xE0 | (code_point >> 12));
+            out_ += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out_ += static_cast<char>(0x80 | (code_point & 0x3F));
+            return;
+        }
+
+        if (cell != colors_) {
+            const uint32_t top = static_cast<uint32_t>(cell >> 32);
+            const uint32_t bottom = static_cast<uint32_t>(cell);
+            std::format_to(std::back_inserter(out_), "\x1b[38;2;{};{};{};48;2;{};{};{}m",
+                (top >> 16) & 0xFF, (top >> 8) & 0xFF, top & 0xFF,
+                (bottom >> 16) & 0xFF, (bottom >> 8) & 0xFF, bottom & 0xFF);
+            colors_ = cell;
+        }
+        out_ += "\xe2\x96\x80";     // U+2580 upper half block: fg is the top pixel, bg the bottom one
+    }
+
+    /**
+     * @brief Reads whatever was typed since the last call without blocking.
+     *
+     * Letters are folded to lower case so they match Platform::key_mapping, enter and
+     * space map to SDLK_RETURN / SDLK_SPACE, and arrow escape sequences to the SDL arrow
+     * keys. Escape on its own and Ctrl-C (raw mode swallows SIGINT) ask to quit.
+     *
+     * @param keys Receives the host keys pressed, in order.
+     * @return false if the user asked to quit.
+     */
+    bool TerminalGui::poll_keys(std::vector<SDL_Keycode>& keys) {
+        if (!raw_)
+            return true;
+
+        char buffer[64];
+        ssize_t n;
+        while ((n = ::read(STDIN_FILENO, buffer, sizeof(buffer))) > 0) {
+            pending_input_.append(buffer, static_cast<std::size_t>(n));
+        }
+
+        std::size_t i = 0;
+        bool quit = false;
+        while (i < pending_input_.size()) {
+            const char c = pending_input_[i];
+            if (c == CTRL_C) {
+                quit = true;
+                i++;
+            }
+            else if (c == ESC) {
+                if (i + 1 == pending_input_.size()) {
+                    quit = true;    // a lone escape key; sequences arrive in one read
+                    i++;
+                    continue;
+                }
+                const char intro = pending_input_[i + 1];
+                if (intro != '[' && intro != 'O') {
+                    i++;            // alt + key: drop the escape, keep the key
+                    continue;
+                }
+
+                std::size_t end = i + 2;
+                while (end < pending_input_.size() && (pending_input_[end] < 0x40 || pending_input_[end] > 0x7E))
+                    end++;
+                if (end == pending_input_.size())
+                    break;          // wait for the rest of the sequence
+
+                switch (pending_input_[end]) {
+                    case 'A': keys.push_back(SDLK_UP); break;
+                    case 'B': keys.push_back(SDLK_DOWN); break;
+                    case 'C': keys.push_back(SDLK_RIGHT); break;
+                    case 'D': keys.push_back(SDLK_LEFT); break;
+                    default: break;     // function keys and the like are not mapped
+                }
+                i = end + 1;
+            }
+            else {
+                if (c == '\r' || c == '\n')
+                    keys.push_back(SDLK_RETURN);
+                else if (c >= 'A' && c <= 'Z')
+                    keys.push_back(c - 'A' + 'a');
+                else
+                    keys.push_back(static_cast<unsigned char>(c));
+                i++;
+            }
+        }
+        pending_input_.erase(0, i);
+        return !quit;
+    }
+#else
+    TerminalGui::TerminalGui(TerminalGlyphs glyphs, uint32_t background) : glyphs_(glyphs), background_(background) {
+        throw std::runtime_error("terminal output needs a POSIX terminal");
+    }
+
+    TerminalGui::~TerminalGui() = default;
+    void TerminalGui::render_frame(const uint32_t*) {}
+    bool TerminalGui::poll_keys(std::vector<SDL_Keycode>&) { return true; }
+#endif
+
+} // Chip8
@@ -0,0 +1,80 @@
+#ifndef TERMINAL_GUI_H
+#define TERMINAL_GUI_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <SDL_keyboard.h>
+#if defined(__unix__) || defined(__APPLE__)
+#include <termios.h>
+#define CHIP8_TERMINAL_POSIX 1
+#endif
+
+#include "compositor.h"
+
+namespace Chip8 {
+
+enum class TerminalGlyphs : uint8_t {
+    BRAILLE,    // 2x4 pixels per cell, 32x8 cells, monochrome
+    HALF_BLOCK  // 1x2 pixels per cell, 64x16 cells, palette colors (24-bit SGR)
+};
+
+inline std::optional<TerminalGlyphs> parse_terminal_glyphs(const std::string& name) {
+    if (name == "braille") return TerminalGlyphs::BRAILLE;
+    if (name == "halfblock") return TerminalGlyphs::HALF_BLOCK;
+    return std::nullopt;
+}
+
+/**
+ * Renders frames to the controlling terminal, for hosts without a display.
+ *
+ * Takes the same composited ARGB frame as Gui::render_frame. Every frame is reduced to
+ * terminal cells and only the cells that differ from the previous frame are written,
+ * with a cursor move whenever they are not adjacent, so a static screen costs nothing
+ * and a moving sprite a few dozen bytes.
+ *
+ * While attached the terminal is in raw mode on the alternate screen; both are undone
+ * by the destructor. Terminals only report key presses (and autorepeats), never
+ * releases, so poll_keys just returns the keys that were typed.
+ */
+class TerminalGui {
+public:
+    explicit TerminalGui(TerminalGlyphs glyphs, uint32_t background = Compositor::default_palette[0]);
+    ~TerminalGui();
+    TerminalGui(const TerminalGui&) = delete;
+    TerminalGui& operator=(const TerminalGui&) = delete;
+
+    void render_frame(const uint32_t* pixels);     // 64x32 ARGB8888 from Compositor
+    bool poll_keys(std::vector<SDL_Keycode>& keys); // false once the user asked to quit
+
+    uint64_t bytes_written() const { return bytes_written_; }
+
+private:
+    void append_cell(uint64_t cell);
+    void move_cursor(int row, int col);
+
+    TerminalGlyphs glyphs_;
+    uint32_t background_;
+    int rows_;
+    int cols_;
+
+    std::vector<uint64_t> cells_;       // what the terminal shows now
+    std::string out_;                   // escape sequences of the current frame
+    int cursor_row_{-1};                // where the terminal cursor is, -1 if unknown
+    int cursor_col_{-1};
+    uint64_t colors_{~0ull};            // current SGR fg/bg (half-block only)
+    uint64_t bytes_written_{0};
+    bool drawn_{false};                 // first frame is written in full
+
+#ifdef CHIP8_TERMINAL_POSIX
+    termios saved_termios_{};
+#endif
+    bool raw_{false};
+    std::string pending_input_;         // escape sequence split across reads
+};
+
+} // Chip8
+
+#endif //TERMINAL_GUI_H
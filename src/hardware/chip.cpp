@@ -1,8 +1,11 @@
 #include "chip.h"
 
-#include <iostream>
+#include <cstring>
 #include <fstream>
 #include <sstream>
+#include <vector>
+
+#include "../log/log.h"
 
 // This is all the implementation for the chip-8 hardware
 namespace Chip8 {
@@ -13,10 +16,6 @@ namespace Chip8 {
      * Sets up internal counters, timers, random generator, and key-wait state.
      */
     Chip::Chip() :
-    registers(std::make_unique<std::array<uint8_t, 16>>()),
-    memory(std::make_unique<std::array<uint8_t, 4096>>()),
-    stack(std::make_unique<std::array<uint16_t, 16>>()),
-    key_states(std::make_unique<std::set<uint8_t>>()),
     fonts {{
         0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
         0x20, 0x60, 0x20, 0x20, 0x70, // 1
@@ -38,13 +37,44 @@ namespace Chip8 {
     {
         init_counters();
         init_timers(0, 0);    // use default argument values 0, 0
-        init_random_generator();
+        rehash_state();
         load_fonts_in_memory();
         init_waiting();
+        init_xo_chip();
     }
 
     // INITIALIZERS
 
+    /**
+     * @brief Puts the machine back into its power-on state, in place.
+     *
+     * Registers, stack, memory, framebuffer, timers, keys and XO-CHIP state are cleared
+     * and the fonts reloaded, without touching any allocation, so pointers to memory or
+     * gfx stay valid. The random sequence restarts from the current seed and stream;
+     * the quirk profile, tracer and memory observer stay attached.
+     */
+    void Chip::reset() {
+        registers.fill(0);
+        stack.fill(0);
+        key_mask = 0;
+        memory.fill(0);
+        for (auto& column : gfx) {
+            column.fill(0);
+        }
+
+        init_counters();
+        init_timers(0, 0);
+        init_waiting();
+        init_xo_chip();
+        seed_random(rng_seed, rng_stream);
+        rehash_state();
+        load_fonts_in_memory();
+
+        delay_timer_polls = 0;
+        delay_timer_sets = 0;
+        set_rom_loaded(false);
+    }
+
     /**
      * @brief Initializes the index register, program counter, and stack pointer.
      *
@@ -75,29 +105,67 @@ namespace Chip8 {
     /**
      * @brief Initializes the opcode instruction dispatcher.
      *
-     * Creates an Instructions instance bound to this Chip.
+     * Creates the Instructions instantiation matching the selected quirk profile,
+     * bound to this Chip. This is the only place the profile is looked at.
      */
     void Chip::init_instr_dispatcher() {
-        instr_dispatcher = std::make_shared<Instructions>(shared_from_this());
+        switch (quirk_profile) {
+            case QuirkProfile::VIP:
+                instr_dispatcher = make_dispatcher<VipQuirks>();
+                break;
+            case QuirkProfile::SCHIP:
+                instr_dispatcher = make_dispatcher<SchipQuirks>();
+                break;
+            case QuirkProfile::XOCHIP:
+                instr_dispatcher = make_dispatcher<XoChipQuirks>();
+                break;
+        }
     }
 
     /**
-     * @brief Initializes the graphics buffer.
+     * @brief Instantiates the core for a quirk policy, with memory hooks only if observed.
+     */
+    template<typename Quirks>
+    std::shared_ptr<InstructionSet> Chip::make_dispatcher() {
+        if (memory_observer)
+            return std::make_shared<Instructions<Watched<Quirks>>>(this);
+        return std::make_shared<Instructions<Quirks>>(this);
+    }
+
+    /**
+     * @brief Selects the quirk profile and rebuilds the instruction dispatcher for it.
      *
-     * Allocates a 64x32 array for pixel state.
+     * @param profile Interpreter variant to emulate.
      */
-    void Chip::init_gfx() {
-        gfx = std::make_shared<std::array<std::array<uint8_t, 32>, 64>>();
+    void Chip::set_quirk_profile(QuirkProfile profile) {
+        quirk_profile = profile;
+        init_instr_dispatcher();
+    }
+
+    QuirkProfile Chip::get_quirk_profile() const {
+        return quirk_profile;
+    }
+
+    /**
+     * @brief Installs (or with nullptr removes) the memory access observer.
+     *
+     * The dispatcher is rebuilt so that without an observer the unhooked core runs.
+     *
+     * @param observer Notified of I-addressed reads and writes.
+     */
+    void Chip::set_memory_observer(MemoryObserver* observer) {
+        memory_observer = observer;
+        init_instr_dispatcher();
     }
 
     /**
-     * @brief Initializes the random number generator.
+     * @brief Initializes the graphics buffer.
      *
-     * Configures uniform distribution over 0-255 and default engine.
+     * Clears the 64x32 pixel state.
      */
-    void Chip::init_random_generator() {
-        uniform_dist = std::uniform_int_distribution<uint8_t>{ 0, 255u };
-        random_engine = std::default_random_engine{};
+    void Chip::init_gfx() {
+        gfx = Gfx{};
+        rehash_state();
     }
 
     /**
@@ -110,33 +178,211 @@ namespace Chip8 {
         this->waiting_reg = 0xFF;
     }
 
+    /**
+     * @brief Resets the XO-CHIP specific state.
+     *
+     * Selects bitplane 1 only (plain CHIP-8 drawing), clears the audio pattern
+     * and sets the pitch to the XO-CHIP default of 64 (4000 Hz playback).
+     */
+    void Chip::init_xo_chip() {
+        this->plane_mask = 0x1;
+        this->audio_pattern.fill(0);
+        this->audio_pitch = 64;
+        this->audio_pattern_dirty = false;
+    }
+
     // HARDWARE FUNCTIONS
 
     /**
      * @brief Loads a CHIP-8 ROM from file into memory starting at 0x200.
      *
+     * ROMs may fill the whole XO-CHIP address space above 0x200.
+     *
      * @param file_stream Pointer to an open ifstream for the ROM file.
-     * @throws std::runtime_error if file read fails.
+     * @throws std::runtime_error if file read fails or the ROM does not fit in memory.
      * @return 0 on success.
      */
     int Chip::load_rom(std::ifstream *file_stream) {
         std::streamsize file_size = file_stream->tellg();
+        if (file_size < 0 || static_cast<std::size_t>(file_size) > max_rom_size)
+            throw std::runtime_error("ROM does not fit in memory");
         std::vector<char> buffer(file_size);
 
         file_stream->seekg(0, std::ios::beg);
         if (!file_stream->read(buffer.data(), file_size))
             throw std::runtime_error("Read failed");
 
-        std::copy(
-            buffer.begin(),
-            buffer.end(),
-            memory->begin() + rom_start_addr
-        );
+        return load_rom(reinterpret_cast<const uint8_t*>(buffer.data()), buffer.size());
+    }
+
+    /**
+     * @brief Loads a CHIP-8 ROM image already in memory, starting at 0x200.
+     *
+     * @param data ROM bytes.
+     * @param size Number of bytes.
+     * @throws std::runtime_error if the ROM does not fit in memory.
+     * @return 0 on success.
+     */
+    int Chip::load_rom(const uint8_t* data, std::size_t size) {
+        if (size > max_rom_size)
+            throw std::runtime_error("ROM does not fit in memory");
+
+        for (std::size_t i = 0; i < size; i++) {
+            write_memory(static_cast<uint16_t>(rom_start_addr + i), data[i]);
+        }
         set_rom_loaded(true);
 
         return 0;
     }
 
+    /**
+     * @brief Copies the full machine state into a snapshot.
+     *
+     * @param snapshot Destination, typically reused across calls to avoid allocations.
+     */
+    void Chip::save_snapshot(Snapshot& snapshot) const {
+        snapshot.state = static_cast<const ChipState&>(*this);
+        snapshot.rom_loaded = rom_loaded;
+        snapshot.memory_hash = memory_hash;
+        snapshot.gfx_hash = gfx_hash;
+    }
+
+    /**
+     * @brief Restores the machine state from a snapshot in place.
+     *
+     * The state is copied over the existing one, so references to memory or gfx
+     * (e.g. held by the platform) stay valid.
+     *
+     * @param snapshot State previously filled by save_snapshot.
+     */
+    void Chip::restore_snapshot(const Snapshot& snapshot) {
+        static_cast<ChipState&>(*this) = snapshot.state;
+        rom_loaded = snapshot.rom_loaded;
+        memory_hash = snapshot.memory_hash;
+        gfx_hash = snapshot.gfx_hash;
+    }
+
+    /**
+     * @brief Opens a copy-on-write checkpoint; the machine keeps running normally.
+     *
+     * @param checkpoint Storage for the saved state (about 70 KB), reused across calls.
+     */
+    void Chip::begin_checkpoint(Checkpoint& checkpoint) {
+        const ChipState& state = *this;
+        std::memcpy(checkpoint.cpu.data(), &state, checkpoint.cpu.size());
+        checkpoint.gfx = gfx;
+        checkpoint.memory_hash = memory_hash;
+        checkpoint.gfx_hash = gfx_hash;
+        for (std::size_t i = 0; i < checkpoint.saved_count; i++) {
+            checkpoint.saved[checkpoint.saved_list[i]] = false;
+        }
+        checkpoint.saved_count = 0;
+        this->checkpoint = &checkpoint;
+    }
+
+    /**
+     * @brief Puts the machine back to where begin_checkpoint was called and closes it.
+     *
+     * Copies the CPU state, the framebuffer and only the memory pages written since.
+     */
+    void Chip::rollback_checkpoint() {
+        Checkpoint& saved = *checkpoint;
+        ChipState& state = *this;
+        std::memcpy(&state, saved.cpu.data(), saved.cpu.size());
+        gfx = saved.gfx;
+        memory_hash = saved.memory_hash;
+        gfx_hash = saved.gfx_hash;
+        for (std::size_t i = 0; i < saved.saved_count; i++) {
+            const std::size_t page = saved.saved_list[i];
+            std::memcpy(memory.data() + page * Checkpoint::page_size, saved.pages[page].data(), Checkpoint::page_size);
+        }
+        checkpoint = nullptr;
+    }
+
+    /**
+     * @brief Writes one byte of memory and folds it into the memory hash.
+     *
+     * @param addr Address; every uint16_t is inside the 64 KB memory.
+     * @param value Byte to store.
+     */
+    void Chip::write_memory(uint16_t addr, uint8_t value) {
+        uint8_t& byte = memory[addr];
+        if (checkpoint) {   // first write to a page since the checkpoint: keep the original
+            const std::size_t page = addr / Checkpoint::page_size;
+            if (!checkpoint->saved[page]) {
+                std::memcpy(checkpoint->pages[page].data(), memory.data() + page * Checkpoint::page_size, Checkpoint::page_size);
+                checkpoint->saved[page] = true;
+                checkpoint->saved_list[checkpoint->saved_count++] = static_cast<uint16_t>(page);
+            }
+        }
+        StateHash::update(memory_hash, StateHash::MEMORY_SEED, addr, byte, value);
+        byte = value;
+    }
+
+    /**
+     * @brief Writes one framebuffer cell (all bitplanes) and folds it into the gfx hash.
+     *
+     * @param x Column, 0-63.
+     * @param y Row, 0-31.
+     * @param value Bitplane bits of the pixel.
+     */
+    void Chip::write_pixel(uint8_t x, uint8_t y, uint8_t value) {
+        uint8_t& pixel = gfx.at(x).at(y);
+        StateHash::update(gfx_hash, StateHash::GFX_SEED, x * 32u + y, pixel, value);
+        pixel = value;
+    }
+
+    /**
+     * @brief Fingerprint of the whole machine state.
+     *
+     * Memory and gfx contribute their incrementally maintained hashes; the CPU state
+     * (registers, stack, counters, timers, XO-CHIP audio, RNG position) is about 100 bytes and is
+     * hashed on the spot. Equal states always give equal hashes, so two runs can be
+     * compared every frame and the first differing frame found.
+     *
+     * @return 64-bit state hash.
+     */
+    uint64_t Chip::state_hash() const {
+        std::array<uint8_t, 16 + 32 + 12 + 16 + 16 + 1> cpu{};
+        std::size_t pos = 0;
+        for (uint8_t reg : registers) cpu[pos++] = reg;
+        for (uint16_t addr : stack) {
+            cpu[pos++] = addr & 0xFFu;
+            cpu[pos++] = addr >> 8;
+        }
+        cpu[pos++] = index_reg & 0xFFu;
+        cpu[pos++] = index_reg >> 8;
+        cpu[pos++] = program_ctr & 0xFFu;
+        cpu[pos++] = program_ctr >> 8;
+        cpu[pos++] = stack_ptr;
+        cpu[pos++] = delay_timer;
+        cpu[pos++] = sound_timer;
+        cpu[pos++] = waiting_for_key;
+        cpu[pos++] = waiting_reg;
+        cpu[pos++] = plane_mask;
+        cpu[pos++] = audio_pitch;
+        cpu[pos++] = static_cast<uint8_t>(quirk_profile);
+        for (uint8_t sample : audio_pattern) cpu[pos++] = sample;
+        for (int shift = 0; shift < 64; shift += 8) {
+            cpu[pos++] = static_cast<uint8_t>(rng_key >> shift);
+            cpu[pos++] = static_cast<uint8_t>(rng_counter >> shift);
+        }
+
+        uint64_t cpu_hash = StateHash::block(StateHash::CPU_SEED, cpu.data(), pos);
+        return StateHash::mix(cpu_hash ^ memory_hash) ^ gfx_hash;
+    }
+
+    /**
+     * @brief Recomputes memory and gfx hashes from scratch.
+     *
+     * Needed only after writes that bypass write_memory/write_pixel; comparing
+     * state_hash() before and after also verifies the incremental bookkeeping.
+     */
+    void Chip::rehash_state() {
+        memory_hash = StateHash::block(StateHash::MEMORY_SEED, memory.data(), memory.size());
+        gfx_hash = StateHash::block(StateHash::GFX_SEED, &gfx[0][0], sizeof(Gfx));
+    }
+
     /**
      * @brief Loads font sprite data into memory.
      *
@@ -152,12 +398,12 @@ namespace Chip8 {
         ss >> font_start_address;
 
         if (font_start_address > 432) {
-            std::cerr << "start_address is too high to fit in between 0x000 and 0x200";
+            LOG_ERROR(CPU, "font address {:03X} does not fit below 0x200", font_start_address);
             return false;
         }
 
         for (int i = 0; i < 80; i++) {
-            (*this->memory)[font_start_address + i] = this->fonts[i];
+            write_memory(static_cast<uint16_t>(font_start_address + i), this->fonts[i]);
         }
         return true;
     }
@@ -209,19 +455,27 @@ namespace Chip8 {
      */
     int Chip::cycle() {
         // validation
-        if (program_ctr + 1 >= memory->size()) {
-            std::cout << "Resetting program_ctr" << std::endl;
+        if (std::size_t{program_ctr} + 1 >= memory.size()) {
+            LOG_WARN(CPU, "program counter ran off the end of memory, restarting at {:03X}", rom_start_addr);
             program_ctr = rom_start_addr;
             // throw std::out_of_range("PCOutOfBoundsException: Crashed Program\n");
         }
 
-        // fetch two bytes
-        uint8_t high = memory->at(program_ctr);
-        uint8_t low  = memory->at(program_ctr + 1);
+        // fetch two bytes, in range after the validation above
+        uint8_t high = memory[program_ctr];
+        uint8_t low  = memory[program_ctr + 1];
 
         // execute
         uint16_t opcode = ((uint16_t) high << 8) | low; // combine two byte using bitwise
+        const uint16_t pc = program_ctr;
         instr_dispatcher->interpret_opcode(opcode);
+        if (TraceBuffer* trace = tracer.get()) {     // one predictable branch when tracing is off
+            trace->record(pc, opcode, index_reg, registers[(opcode >> 8) & 0xFu], registers[0xF]);
+        }
+        if (std::atomic<uint64_t>* counts = opcode_counts) {     // single writer: no locked add needed
+            std::atomic<uint64_t>& count = counts[opcode_slot(opcode)];
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
 
         // move relevant counters and timers
         program_ctr += 2;
@@ -229,22 +483,53 @@ namespace Chip8 {
     }
 
     /**
-     * @brief Generates a random 8-bit value using uniform distribution.
+     * @brief Attaches (or with nullptr detaches) an execution trace.
+     *
+     * @param trace_buffer Ring every executed instruction is recorded into.
+     */
+    void Chip::attach_tracer(std::shared_ptr<TraceBuffer> trace_buffer) {
+        tracer = std::move(trace_buffer);
+    }
+
+    const std::shared_ptr<TraceBuffer>& Chip::get_tracer() const {
+        return tracer;
+    }
+
+    /**
+     * @brief Next CXNN byte: a pure function of (seed, stream, draw index).
      *
      * @return A random uint8_t in range [0,255].
      */
     uint8_t Chip::get_random_number() {
-        return uniform_dist(random_engine);
+        return CounterRng::draw8(rng_key, rng_counter++);
+    }
+
+    /**
+     * @brief Restarts the CXNN sequence.
+     *
+     * @param seed Same seed, same sequence on every run.
+     * @param stream Instance id; machines sharing a seed but not a stream draw independently.
+     */
+    void Chip::seed_random(uint64_t seed, uint32_t stream) {
+        rng_seed = seed;
+        rng_stream = stream;
+        rng_key = CounterRng::stream_key(seed, stream);
+        rng_counter = 0;
     }
 
     void Chip::add_key_state(uint8_t key) {
         if (key <= 15) {    // uint8_t always >= 0
-            key_states->insert(key);
+            key_mask |= static_cast<uint16_t>(1u << key);
         }
     }
 
+    /**
+     * @return 1 if the key was held, 0 otherwise.
+     */
     int Chip::remove_key_state(uint8_t key) {
-        return key_states->erase(key);
+        if (!is_key_pressed(key)) return 0;
+        key_mask &= static_cast<uint16_t>(~(1u << key));
+        return 1;
     }
 
     /**
@@ -259,7 +544,7 @@ namespace Chip8 {
      * @return True if chip8 key is pressed
      */
     bool Chip::is_key_pressed(uint8_t key) {
-        return key_states->count(key) > 0;
+        return key < 16 && ((key_mask >> key) & 1u);
     }
 
     bool Chip::is_waiting_for_key() {
@@ -279,7 +564,7 @@ namespace Chip8 {
      * @param key Index of the key that was pressed.
      */
     void Chip::complete_key_wait(uint8_t key) {
-        registers->at(waiting_reg) = key; // store the value of released key in Vx
+        registers.at(waiting_reg) = key; // store the value of released key in Vx
 
         waiting_for_key = false; // so run_frame resumes cycle()
         waiting_reg = 0xFF; // default value
@@ -2,60 +2,118 @@
 #define CHIP8_H
 
 #include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <random>
-#include <set>
 
+#include "chip_state.h"
 #include "instructions.h"
+#include "memory_observer.h"
+#include "quirks.h"
+#include "state_hash.h"
+#include "trace_buffer.h"
 
 namespace Chip8 {
     const std::string FONT_START_ADDRESS = "050";
-    class Instructions; // avoid circular declarations
+    class InstructionSet; // avoid circular declarations
 
-    class Chip : public std::enable_shared_from_this<Chip> {
+    /**
+     * The machine: registers, memory, stack and framebuffer live inline in the
+     * ChipState base (one allocation, no pointers to chase), the rest is host-side.
+     */
+    class Chip : public ChipState {
     public:
-        static const uint16_t rom_start_addr = 0x200;
+        static constexpr uint16_t rom_start_addr = 0x200;
+        static constexpr std::size_t max_rom_size = memory_size - rom_start_addr;
+        static constexpr std::size_t opcode_slots = 16 * 256;     // first nibble x low byte
 
-        const std::unique_ptr<std::array<uint8_t, 16>> registers;  //uint8_t registers[16];
-        const std::unique_ptr<std::array<uint8_t, 4096>> memory;     //uint8_t memory[4096];
-        const std::unique_ptr<std::array<uint16_t, 16>> stack;     //uint16_t stack[16];
-        std::shared_ptr<std::array<std::array<uint8_t, 32>, 64>> gfx; //uint8_t gfx[64][32];
-        std::array<uint8_t, 80> fonts;
+        static constexpr std::size_t opcode_slot(uint16_t opcode) {
+            return (opcode >> 4 & 0xF00u) | (opcode & 0xFFu);
+        }
 
-        const std::unique_ptr<std::set<uint8_t>> key_states; // state of keys
+        std::array<uint8_t, 80> fonts;
 
-        std::shared_ptr<Instructions> instr_dispatcher; // lifetime is managed by the hardware
+        std::shared_ptr<InstructionSet> instr_dispatcher; // lifetime is managed by the hardware
         // Do not reference platform as it is abstraction layer
 
-        uint16_t index_reg;
-        uint16_t program_ctr;
-        uint8_t stack_ptr;
-        uint8_t delay_timer;
-        uint8_t sound_timer;
-        bool waiting_for_key;
-        uint8_t waiting_reg;
-
-        uint16_t font_start_address;
+        MemoryObserver* memory_observer = nullptr;  // debugger watchpoints, see set_memory_observer
+        uint32_t delay_timer_polls = 0;             // FX07 reads of a running delay timer (not machine state)
+        uint32_t delay_timer_sets = 0;              // FX15 writes, both feed the adaptive IPF controller
+        std::atomic<uint64_t>* opcode_counts = nullptr;    // opcode_slots counters for metrics, nullptr when off
+
+        /**
+         * Plain copy of every piece of machine state, restored with straight memcpy-style
+         * copies instead of rebuilding the Chip (fuzzing, rewinds).
+         */
+        struct Snapshot {
+            ChipState state;
+            bool rom_loaded;
+            uint64_t memory_hash;
+            uint64_t gfx_hash;
+        };
+
+        /**
+         * Copy-on-write checkpoint for short look-aheads (run-ahead): opening one copies
+         * the CPU state and the framebuffer (about 2 KB), memory pages are copied only
+         * when first written, and rolling back restores just those.
+         */
+        struct Checkpoint {
+            static constexpr std::size_t page_size = 256;
+            static constexpr std::size_t page_count = memory_size / page_size;
+
+            std::array<uint8_t, offsetof(ChipState, memory)> cpu;   // everything before memory
+            Gfx gfx;
+            uint64_t memory_hash;
+            uint64_t gfx_hash;
+            std::array<std::array<uint8_t, page_size>, page_count> pages;   // originals of written pages
+            std::array<bool, page_count> saved{};
+            std::array<uint16_t, page_count> saved_list;
+            std::size_t saved_count = 0;
+        };
 
         explicit Chip();
         ~Chip() = default;
+        Chip(const Chip&) = delete;
+        Chip& operator=(const Chip&) = delete;
+        void reset();
         int init_counters();
         int init_timers(uint8_t delay_time, uint8_t sound_time);
         void init_instr_dispatcher();
+        void set_quirk_profile(QuirkProfile profile);
+        QuirkProfile get_quirk_profile() const;
+        void set_memory_observer(MemoryObserver* observer);
         void init_gfx();
         void init_waiting();
+        void init_xo_chip();
 
         bool load_fonts_in_memory(std::string start_address = FONT_START_ADDRESS);
         bool get_rom_loaded();
         int load_rom(std::ifstream *file_stream);
+        int load_rom(const uint8_t* data, std::size_t size);
+
+        void save_snapshot(Snapshot& snapshot) const;
+        void restore_snapshot(const Snapshot& snapshot);
+        void begin_checkpoint(Checkpoint& checkpoint);
+        void rollback_checkpoint();
+
+        // Memory and framebuffer writes go through these so the state hash stays current
+        void write_memory(uint16_t addr, uint8_t value);
+        void write_pixel(uint8_t x, uint8_t y, uint8_t value);
+
+        uint64_t state_hash() const;
+        uint64_t framebuffer_hash() const { return gfx_hash; }
+        void rehash_state();
 
         void set_sound_timer(uint8_t time);
 
         int decrement_timers();
 
         int cycle();    // main loop
+        void attach_tracer(std::shared_ptr<TraceBuffer> trace_buffer);
+        const std::shared_ptr<TraceBuffer>& get_tracer() const;
 
         uint8_t get_random_number();
+        void seed_random(uint64_t seed, uint32_t stream = 0);
 
         void add_key_state(uint8_t key);
         int remove_key_state(uint8_t key);
@@ -68,13 +126,17 @@ namespace Chip8 {
         void complete_key_wait(uint8_t key);
 
     private:
-        std::uniform_int_distribution<uint8_t> uniform_dist;
-        std::default_random_engine random_engine;
         bool rom_loaded = false;
-
-        void init_random_generator();
+        QuirkProfile quirk_profile = QuirkProfile::SCHIP;
+        uint64_t memory_hash = 0;   // incremental StateHash of memory
+        uint64_t gfx_hash = 0;      // incremental StateHash of gfx
+        std::shared_ptr<TraceBuffer> tracer;    // nullptr unless tracing
+        Checkpoint* checkpoint = nullptr;       // open checkpoint, see begin_checkpoint
 
         void set_rom_loaded(bool status);
+
+        template<typename Quirks>
+        std::shared_ptr<InstructionSet> make_dispatcher();
     };
 } // Chip8
 
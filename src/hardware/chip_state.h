@@ -0,0 +1,57 @@
+#ifndef CHIP_STATE_H
+#define CHIP_STATE_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "counter_rng.h"
+
+namespace Chip8 {
+
+/**
+ * Every piece of emulated machine state in one flat, trivially copyable block.
+ *
+ * The first cache line holds what nearly every instruction touches (V0-VF, I, PC,
+ * SP, timers, keys and the call stack); memory and the framebuffer follow on their
+ * own cache lines. Chip derives from it, so the fields keep their old names, and a
+ * snapshot is a plain copy of this struct.
+ */
+struct alignas(64) ChipState {
+    static constexpr std::size_t memory_size = 0x10000; // XO-CHIP 64 KB address space
+
+    using Memory = std::array<uint8_t, memory_size>;
+    using Gfx = std::array<std::array<uint8_t, 32>, 64>; // each pixel holds one bit per bitplane
+
+    // cache line 0: CPU
+    std::array<uint8_t, 16> registers{};
+    uint16_t index_reg = 0;
+    uint16_t program_ctr = 0;
+    uint8_t stack_ptr = 0;
+    uint8_t delay_timer = 0;
+    uint8_t sound_timer = 0;
+    uint8_t plane_mask = 0x1;               // bitplanes selected by FN01 (bit 0 = plane 1, bit 1 = plane 2)
+    uint16_t key_mask = 0;                  // bit k set = key k held
+    bool waiting_for_key = false;
+    uint8_t waiting_reg = 0xFF;
+    uint16_t font_start_address = 0;
+    uint8_t audio_pitch = 64;               // playback pitch set by FX3A (64 = 4000 Hz)
+    bool audio_pattern_dirty = false;       // set when pattern or pitch changed, cleared by platform
+    std::array<uint16_t, 16> stack{};
+
+    // cache line 1: XO-CHIP audio and the CXNN generator
+    alignas(64) std::array<uint8_t, 16> audio_pattern{};  // 128 1-bit samples loaded by F002
+    uint64_t rng_seed = CounterRng::DEFAULT_SEED;
+    uint64_t rng_key = CounterRng::stream_key(CounterRng::DEFAULT_SEED, 0);  // from seed and stream
+    uint64_t rng_counter = 0;               // draws so far
+    uint32_t rng_stream = 0;                // instance id, separates parallel machines
+
+    alignas(64) Memory memory{};
+    alignas(64) Gfx gfx{};
+};
+
+static_assert(offsetof(ChipState, stack) + sizeof(ChipState::stack) <= 64, "CPU state must fit one cache line");
+
+} // Chip8
+
+#endif //CHIP_STATE_H
@@ -0,0 +1,43 @@
+#ifndef COUNTER_RNG_H
+#define COUNTER_RNG_H
+
+#include <cstdint>
+
+#include "state_hash.h"
+
+namespace Chip8 {
+    /**
+     * Counter-based random numbers: draw n of a stream is a pure function of
+     * (seed, stream, n), so there is no engine state beyond the draw counter.
+     *
+     * Each (seed, stream) pair picks a starting point of a splitmix64 sequence; draw n
+     * is the finalizer applied to that start plus n golden-ratio steps. All streams are
+     * offsets into that one sequence, so two streams can overlap; with scrambled 64-bit
+     * starting points they are statistically independent for any realistic number of
+     * draws, not disjoint. Restoring the counter restores every future draw.
+     */
+    namespace CounterRng {
+        constexpr uint64_t DEFAULT_SEED = 0x243F6A8885A308D3ull;
+        constexpr uint64_t STREAM_MULTIPLIER = 0xD1342543DE82EF95ull;
+
+        /**
+         * @brief Starting point of the sequence of one stream.
+         */
+        constexpr uint64_t stream_key(uint64_t seed, uint64_t stream) {
+            return StateHash::mix(seed ^ (stream * STREAM_MULTIPLIER));
+        }
+
+        constexpr uint64_t draw64(uint64_t key, uint64_t index) {
+            return StateHash::mix(key + index * 0x9E3779B97F4A7C15ull);
+        }
+
+        /**
+         * @brief Byte number index of a stream; uses the best-mixed top bits.
+         */
+        constexpr uint8_t draw8(uint64_t key, uint64_t index) {
+            return static_cast<uint8_t>(draw64(key, index) >> 56);
+        }
+    }
+}
+
+#endif // COUNTER_RNG_H
@@ -1,37 +1,43 @@
 #include "instructions.h"
 
-#include <chrono>
-#include <iostream>
-#include <map>
-#include <SDL_timer.h>
+#include <cstdlib>
+
+#include "../log/log.h"
 
 namespace Chip8 {
     // public
-    Instructions::Instructions(std::shared_ptr<Chip> chip8_instance) :
+    template<typename Quirks, typename Access>
+    Instructions<Quirks, Access>::Instructions(Chip* chip8_instance) :
     chip8_(chip8_instance)
     {  // constructor
         init_dispatch_table();
     }
 
-    int Instructions::interpret_opcode(uint16_t p_opcode) {
+    template<typename Quirks, typename Access>
+    int Instructions<Quirks, Access>::interpret_opcode(uint16_t p_opcode) {
         // static
         opcode = p_opcode;
-        // Lock weak_ptr and operate using weak_ptr
-        if (auto chip8_ptr = chip8_.lock()) {
-            (this->*dispatch_table[(opcode & 0xF000u) >> 12u])(chip8_ptr); // executes specific insYtruction
-            chip8_ptr.reset();
-        }
+        (this->*dispatch_table[(opcode & 0xF000u) >> 12u])(chip8_); // executes specific insYtruction
         return 0;
     }
 
     // private
-    void Instructions::init_dispatch_table() {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::init_dispatch_table() {
     // for quick access instead
         zero_dispatch_table = std::array<Handler, ZERO_OPS>{};
         zero_dispatch_table.fill(&Instructions::OP_NULL);
         zero_dispatch_table[0x0] = &Instructions::OP_00E0;
         zero_dispatch_table[0xE] = &Instructions::OP_00EE;
 
+        five_dispatch_table = std::array<Handler, FIVE_OPS>{};
+        five_dispatch_table.fill(&Instructions::OP_NULL);
+        five_dispatch_table[0x0] = &Instructions::OP_5XY0;
+        if constexpr (Quirks::xo_chip_opcodes) {
+            five_dispatch_table[0x2] = &Instructions::OP_5XY2;
+            five_dispatch_table[0x3] = &Instructions::OP_5XY3;
+        }
+
         eight_dispatch_table = std::array<Handler, EIGHT_OPS>{};
         eight_dispatch_table.fill(&Instructions::OP_NULL);
         eight_dispatch_table[0x0] = &Instructions::OP_8XY0;
@@ -51,6 +57,12 @@ namespace Chip8 {
 
         f_dispatch_table = std::array<Handler, F_OPS>{};
         f_dispatch_table.fill(&Instructions::OP_NULL);
+        if constexpr (Quirks::xo_chip_opcodes) {    // undefined (OP_NULL) on VIP and SCHIP
+            f_dispatch_table[0x00] = &Instructions::OP_F000;
+            f_dispatch_table[0x01] = &Instructions::OP_FN01;
+            f_dispatch_table[0x02] = &Instructions::OP_F002;
+            f_dispatch_table[0x3A] = &Instructions::OP_FX3A;
+        }
         f_dispatch_table[0x07] = &Instructions::OP_FX07;
         f_dispatch_table[0x0A] = &Instructions::OP_FX0A;
         f_dispatch_table[0x15] = &Instructions::OP_FX15;
@@ -67,7 +79,7 @@ namespace Chip8 {
         dispatch_table[0x2] = &Instructions::OP_2NNN;
         dispatch_table[0x3] = &Instructions::OP_3XNN;
         dispatch_table[0x4] = &Instructions::OP_4XNN;
-        dispatch_table[0x5] = &Instructions::OP_5XY0;
+        dispatch_table[0x5] = &Instructions::OP_5;
         dispatch_table[0x6] = &Instructions::OP_6XNN;
         dispatch_table[0x7] = &Instructions::OP_7XNN;
         dispatch_table[0x8] = &Instructions::OP_8;
@@ -81,7 +93,8 @@ namespace Chip8 {
     }
 
     // 0 - Ops
-    void Instructions::OP_0(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_0(Chip8::Chip* chip8_ptr) {
         (this->*zero_dispatch_table[(opcode & 0x000Fu)])(chip8_ptr);     // masks last bit and executes
     }
 
@@ -90,12 +103,17 @@ namespace Chip8 {
      *
      * Clear the display.
      *
+     * Only the bitplanes currently selected by FN01 are cleared (XO-CHIP).
+     *
      * @param chip8_ptr
      */
-    void Instructions::OP_00E0(std::shared_ptr<Chip8::Chip> chip8_ptr) {
-        for (std::size_t x = 0; x < 64; x++) {
-            for (std::size_t y = 0; y < 32; y++) {
-                (*chip8_ptr->gfx)[x][y] = 0;
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_00E0(Chip8::Chip* chip8_ptr) {
+        uint8_t keep_mask = static_cast<uint8_t>(~chip8_ptr->plane_mask);
+        for (uint8_t x = 0; x < 64; x++) {
+            for (uint8_t y = 0; y < 32; y++) {
+                uint8_t pixel = chip8_ptr->gfx[x][y];
+                if (pixel & ~keep_mask) chip8_ptr->write_pixel(x, y, pixel & keep_mask);
             }
         }
     }
@@ -106,13 +124,14 @@ namespace Chip8 {
      * Return from a subroutine.
      *
      * The interpreter sets the program counter to the address at the top of the stack,
-     * then subtracts 1 from the stack pointer.
+     * then subtracts 1 from the stack pointer. Returning with an empty stack wraps the
+     * stack pointer (MaskedAccess) or traps (CheckedAccess).
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_00EE(std::shared_ptr<Chip8::Chip> chip8_ptr) {
-        chip8_ptr->stack_ptr--;
-        chip8_ptr->program_ctr = (chip8_ptr->stack->at(chip8_ptr->stack_ptr));
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_00EE(Chip8::Chip* chip8_ptr) {
+        chip8_ptr->program_ctr = Access::pop(*chip8_ptr, opcode);
     }
 
     /**
@@ -124,7 +143,8 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_1NNN(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_1NNN(Chip8::Chip* chip8_ptr) {
         uint16_t addr = opcode & 0x0FFFu;
         chip8_ptr->program_ctr = addr - 2;
     }
@@ -136,12 +156,13 @@ namespace Chip8 {
      *
      * The interpreter increments the stack pointer,
      * then puts the current PC on the top of the stack. The PC is then set to nnn.
+     * A 17th nested call wraps the stack pointer (MaskedAccess) or traps (CheckedAccess).
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_2NNN(std::shared_ptr<Chip8::Chip> chip8_ptr) {
-        chip8_ptr->stack->at(chip8_ptr->stack_ptr) = chip8_ptr->program_ctr;
-        chip8_ptr->stack_ptr++;
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_2NNN(Chip8::Chip* chip8_ptr) {
+        Access::push(*chip8_ptr, opcode, chip8_ptr->program_ctr);
 
         uint16_t addr = opcode & 0x0FFFu; // 4 + 4 + 4 = 12 bits so need a uint16
         chip8_ptr->program_ctr = addr - 2;
@@ -157,12 +178,13 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_3XNN(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_3XNN(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t byte = (opcode & 0x00FFu);
 
-        if (chip8_ptr->registers->at(reg_x) == byte) {
-            chip8_ptr->program_ctr += 2;
+        if (chip8_ptr->registers[reg_x] == byte) {
+            skip_next_instruction(chip8_ptr);
         }
     }
 
@@ -176,12 +198,13 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_4XNN(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_4XNN(Chip8::Chip* chip8_ptr) {
         uint8_t reg = (opcode & 0x0F00u) >> 8u;     // Masks third digit then shifts to keep
         uint8_t byte = (opcode & 0x00FFu);    // Masks bottom 8-bits
 
-        if (chip8_ptr->registers->at(reg) != byte) {
-            chip8_ptr->program_ctr += 2;
+        if (chip8_ptr->registers[reg] != byte) {
+            skip_next_instruction(chip8_ptr);
         }
     }
 
@@ -195,12 +218,61 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_5XY0(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_5XY0(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
 
-        if (chip8_ptr->registers->at(reg_x) == chip8_ptr->registers->at(reg_y)) {
-            chip8_ptr->program_ctr += 2;
+        if (chip8_ptr->registers[reg_x] == chip8_ptr->registers[reg_y]) {
+            skip_next_instruction(chip8_ptr);
+        }
+    }
+
+    /**
+     * @brief SAVE Vx - Vy (XO-CHIP)
+     *
+     * Store registers Vx through Vy in memory starting at location I.
+     *
+     * The range may be ascending or descending (x > y stores Vx first).
+     * I is not modified.
+     *
+     * @param chip8_ptr
+     */
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_5XY2(Chip8::Chip* chip8_ptr) {
+        uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
+        uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
+
+        int step = (reg_x <= reg_y) ? 1 : -1;
+        int count = std::abs(reg_y - reg_x) + 1;
+        Access::check_range(*chip8_ptr, opcode, chip8_ptr->index_reg, count);
+        if constexpr (Quirks::watch_memory) chip8_ptr->memory_observer->on_memory_write(chip8_ptr->index_reg, count);
+        for (int i = 0; i < count; i++) {
+            chip8_ptr->write_memory(Access::address(chip8_ptr->index_reg + i), chip8_ptr->registers[reg_x + i * step]);
+        }
+    }
+
+    /**
+     * @brief LOAD Vx - Vy (XO-CHIP)
+     *
+     * Read registers Vx through Vy from memory starting at location I.
+     *
+     * The range may be ascending or descending (x > y loads Vx first).
+     * I is not modified.
+     *
+     * @param chip8_ptr
+     */
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_5XY3(Chip8::Chip* chip8_ptr) {
+        uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
+        uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
+
+        int step = (reg_x <= reg_y) ? 1 : -1;
+        int count = std::abs(reg_y - reg_x) + 1;
+        Access::check_range(*chip8_ptr, opcode, chip8_ptr->index_reg, count);
+        if constexpr (Quirks::watch_memory) chip8_ptr->memory_observer->on_memory_read(chip8_ptr->index_reg, count);
+        for (int i = 0; i < count; i++) {
+            chip8_ptr->registers[reg_x + i * step] = chip8_ptr->memory[Access::address(chip8_ptr->index_reg + i)];
         }
     }
 
@@ -213,11 +285,12 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_6XNN(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_6XNN(Chip8::Chip* chip8_ptr) {
         uint8_t reg = (opcode & 0x0F00u) >> 8u;
         uint8_t byte = opcode & 0x00FFu;
 
-        chip8_ptr->registers->at(reg) = byte;
+        chip8_ptr->registers[reg] = byte;
     }
 
     /**
@@ -230,15 +303,22 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_7XNN(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_7XNN(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t kk_byte = opcode & 0x00FFu;
 
-        uint8_t result = chip8_ptr->registers->at(reg_x) + kk_byte;
-        chip8_ptr->registers->at(reg_x) = result;
+        uint8_t result = chip8_ptr->registers[reg_x] + kk_byte;
+        chip8_ptr->registers[reg_x] = result;
+    }
+
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_5(Chip8::Chip* chip8_ptr) {
+        (this->*five_dispatch_table[(opcode & 0x000Fu)])(chip8_ptr);     // masks last bit and executes
     }
 
-    void Instructions::OP_8(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_8(Chip8::Chip* chip8_ptr) {
         (this->*eight_dispatch_table[(opcode & 0x000Fu)])(chip8_ptr);    // masks last bit and
         // executes
     }
@@ -252,12 +332,13 @@ namespace Chip8 {
      *
      * @param chip8_ptr
     */
-    void Instructions::OP_8XY0(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_8XY0(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t value_y = chip8_ptr->registers->at(reg_y);
-        chip8_ptr->registers->at(reg_x) = value_y;
+        uint8_t value_y = chip8_ptr->registers[reg_y];
+        chip8_ptr->registers[reg_x] = value_y;
     }
 
     /**
@@ -268,18 +349,21 @@ namespace Chip8 {
      * Performs a bitwise OR on the values of Vx and Vy, then stores the result in Vx.
      * A bitwise OR compares the corresponding bits from two values, and if either bit is 1,
      * then the same bit in the result is also 1. Otherwise, it is 0.
+     * VIP quirk: VF is reset to 0.
      *
      * @param chip8_ptr
     */
-    void Instructions::OP_8XY1(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_8XY1(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t value_x = chip8_ptr->registers->at(reg_x);
-        uint8_t value_y = chip8_ptr->registers->at(reg_y);
+        uint8_t value_x = chip8_ptr->registers[reg_x];
+        uint8_t value_y = chip8_ptr->registers[reg_y];
 
         uint8_t c = static_cast<uint8_t>(value_x | value_y);    // OR operator
-        chip8_ptr->registers->at(reg_x) = c;
+        chip8_ptr->registers[reg_x] = c;
+        if constexpr (Quirks::logic_resets_vf) chip8_ptr->registers[0xF] = 0;
     }
 
     /**
@@ -290,18 +374,21 @@ namespace Chip8 {
      * Performs a bitwise AND on the values of Vx and Vy, then stores the result in Vx.
      * A bitwise AND compares the corresponding bits from two values, and if both bit is 1,
      * then the same bit in the result is also 1. Otherwise, it is 0.
+     * VIP quirk: VF is reset to 0.
      *
      * @param chip8_ptr
     */
-    void Instructions::OP_8XY2(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_8XY2(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t value_x = chip8_ptr->registers->at(reg_x);
-        uint8_t value_y = chip8_ptr->registers->at(reg_y);
+        uint8_t value_x = chip8_ptr->registers[reg_x];
+        uint8_t value_y = chip8_ptr->registers[reg_y];
 
         uint8_t c = static_cast<uint8_t>(value_x & value_y);
-        chip8_ptr->registers->at(reg_x) = c;
+        chip8_ptr->registers[reg_x] = c;
+        if constexpr (Quirks::logic_resets_vf) chip8_ptr->registers[0xF] = 0;
     }
 
     /**
@@ -312,18 +399,21 @@ namespace Chip8 {
      * Performs a bitwise exclusive OR on the values of Vx and Vy, then stores the result in Vx.
      * An exclusive OR compares the corresponding bits from two values, and if the bits are not both the same,
      * then the corresponding bit in the result is set to 1. Otherwise, it is 0.
+     * VIP quirk: VF is reset to 0.
      *
      * @param chip8_ptr
     */
-    void Instructions::OP_8XY3(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_8XY3(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t value_x = chip8_ptr->registers->at(reg_x);
-        uint8_t value_y = chip8_ptr->registers->at(reg_y);
+        uint8_t value_x = chip8_ptr->registers[reg_x];
+        uint8_t value_y = chip8_ptr->registers[reg_y];
 
         uint8_t c = static_cast<uint8_t>(value_x ^ value_y);
-        chip8_ptr->registers->at(reg_x) = c;
+        chip8_ptr->registers[reg_x] = c;
+        if constexpr (Quirks::logic_resets_vf) chip8_ptr->registers[0xF] = 0;
     }
 
     /**
@@ -337,19 +427,17 @@ namespace Chip8 {
      *
      * @param chip8_ptr
     */
-    void Instructions::OP_8XY4(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_8XY4(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t value_x = chip8_ptr->registers->at(reg_x);
-        uint8_t value_y = chip8_ptr->registers->at(reg_y);
+        uint8_t value_x = chip8_ptr->registers[reg_x];
+        uint8_t value_y = chip8_ptr->registers[reg_y];
 
         uint16_t full_sum_value = value_x + value_y;
-        chip8_ptr->registers->at(0xF) = 0;
-        if (full_sum_value > 255) {
-            chip8_ptr->registers->at(0xF) = 1; // VF (carry) = 1
-        }
-        chip8_ptr->registers->at(reg_x) = (full_sum_value & 0x00FF); // 8 lowest bits
+        chip8_ptr->registers[reg_x] = (full_sum_value & 0x00FF); // 8 lowest bits
+        chip8_ptr->registers[0xF] = (full_sum_value > 255) ? 1 : 0; // VF (carry), written last so it wins when X = F
     }
 
     /**
@@ -357,22 +445,22 @@ namespace Chip8 {
      *
      * Set Vx = Vx - Vy, set VF = NOT borrow.
      *
-     * If Vx > Vy, then VF is set to 1, otherwise 0. Then Vy is subtracted from Vx, and the results stored in Vx.
+     * If Vx >= Vy (no borrow), then VF is set to 1, otherwise 0. Then Vy is subtracted from Vx,
+     * and the results stored in Vx. VF is written last so it wins when X = F.
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_8XY5(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_8XY5(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t value_x = chip8_ptr->registers->at(reg_x);
-        uint8_t value_y = chip8_ptr->registers->at(reg_y);
-
-        chip8_ptr->registers->at(0xF) = 0;
-        if (value_x > value_y) chip8_ptr->registers->at(0xF) = 1;
+        uint8_t value_x = chip8_ptr->registers[reg_x];
+        uint8_t value_y = chip8_ptr->registers[reg_y];
 
         uint16_t full_diff = value_x - value_y;
-        chip8_ptr->registers->at(reg_x) = (full_diff & 0x00FF); // 8 lowest bits
+        chip8_ptr->registers[reg_x] = (full_diff & 0x00FF); // 8 lowest bits
+        chip8_ptr->registers[0xF] = (value_x >= value_y) ? 1 : 0;
     }
 
     /**
@@ -382,18 +470,19 @@ namespace Chip8 {
      *
      * If the least-significant bit of Vx is 1, then VF is set to 1, otherwise 0.
      * Then Vx is divided by 2.
+     * VIP/XO-CHIP quirk: Vy is shifted instead and the result stored in Vx.
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_8XY6(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_8XY6(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
+        uint8_t reg_src = reg_x;
+        if constexpr (Quirks::shift_uses_vy) reg_src = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t value_x = chip8_ptr->registers->at(reg_x);
-        uint8_t lsb_x = (value_x & 0x000Fu);
-        chip8_ptr->registers->at(0xF) = 0;
-        if (lsb_x == 1) chip8_ptr->registers->at(0xF) = 1;
-
-        chip8_ptr->registers->at(reg_x) = (value_x / 2);
+        uint8_t value = chip8_ptr->registers[reg_src];
+        chip8_ptr->registers[reg_x] = (value >> 1);
+        chip8_ptr->registers[0xF] = (value & 0x01u);   // shifted-out lsb
     }
 
     /**
@@ -401,23 +490,22 @@ namespace Chip8 {
      *
      * Set Vx = Vy - Vx, set VF = NOT borrow.
      *
-     * If Vy > Vx, then VF is set to 1, otherwise 0.
-     * Then Vx is subtracted from Vy, and the results stored in Vx.
+     * If Vy >= Vx (no borrow), then VF is set to 1, otherwise 0.
+     * Then Vx is subtracted from Vy, and the results stored in Vx. VF is written last.
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_8XY7(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_8XY7(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t value_x = chip8_ptr->registers->at(reg_x);
-        uint8_t value_y = chip8_ptr->registers->at(reg_y);
-
-        chip8_ptr->registers->at(0xF) = 0;
-        if (value_y > value_x) chip8_ptr->registers->at(0xF) = 1;
+        uint8_t value_x = chip8_ptr->registers[reg_x];
+        uint8_t value_y = chip8_ptr->registers[reg_y];
 
         uint16_t full_diff = value_y - value_x;
-        chip8_ptr->registers->at(reg_x) = (full_diff & 0x00FF); // 8 lowest bits
+        chip8_ptr->registers[reg_x] = (full_diff & 0x00FF); // 8 lowest bits
+        chip8_ptr->registers[0xF] = (value_y >= value_x) ? 1 : 0;
     }
 
     /**
@@ -426,18 +514,19 @@ namespace Chip8 {
      *
      * If the most-significant bit of Vx is 1, then VF is set to 1, otherwise to 0.
      * Then Vx is multiplied by 2.
+     * VIP/XO-CHIP quirk: Vy is shifted instead and the result stored in Vx.
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_8XYE(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_8XYE(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
+        uint8_t reg_src = reg_x;
+        if constexpr (Quirks::shift_uses_vy) reg_src = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t value_x = chip8_ptr->registers->at(reg_x);
-        uint8_t msb_x = (value_x & 0xF000u);
-        chip8_ptr->registers->at(0xF) = 0;
-        if (msb_x == 1) chip8_ptr->registers->at(0xF) = 1; // VF = 1
-
-        chip8_ptr->registers->at(reg_x) = (value_x * 2);
+        uint8_t value = chip8_ptr->registers[reg_src];
+        chip8_ptr->registers[reg_x] = static_cast<uint8_t>(value << 1);
+        chip8_ptr->registers[0xF] = (value >> 7u);     // shifted-out msb
     }
 
     /**
@@ -448,14 +537,15 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_9XY0(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_9XY0(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         uint8_t reg_y = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t value_x = chip8_ptr->registers->at(reg_x);
-        uint8_t value_y = chip8_ptr->registers->at(reg_y);
+        uint8_t value_x = chip8_ptr->registers[reg_x];
+        uint8_t value_y = chip8_ptr->registers[reg_y];
 
-        if (value_x != value_y) chip8_ptr->program_ctr += 2;
+        if (value_x != value_y) skip_next_instruction(chip8_ptr);
     }
 
     /**
@@ -467,7 +557,8 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_ANNN(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_ANNN(Chip8::Chip* chip8_ptr) {
         uint16_t addr = opcode & 0x0FFFu;
         chip8_ptr->index_reg = addr;
     }
@@ -478,14 +569,17 @@ namespace Chip8 {
      * Jump to location nnn + V0.
      *
      * The program counter is set to nnn plus the value of V0.
+     * SCHIP quirk (BXNN): the offset register is VX instead of V0.
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_BNNN(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_BNNN(Chip8::Chip* chip8_ptr) {
         uint16_t location = (opcode & 0x0FFFu); // no need to shift because we keep the last byte
-        uint8_t reg_zero = chip8_ptr->registers->at(0);
+        uint8_t reg_offset = 0;
+        if constexpr (Quirks::jump_uses_vx) reg_offset = (opcode & 0x0F00u) >> 8u;
 
-        chip8_ptr->program_ctr = location + reg_zero - 2;
+        chip8_ptr->program_ctr = location + chip8_ptr->registers[reg_offset] - 2;
     }
 
     /**
@@ -499,11 +593,12 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_CXNN(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_CXNN(Chip8::Chip* chip8_ptr) {
         uint8_t reg = (opcode & 0x0F00u) >> 8;
         uint8_t NN = (opcode & 0x00FFu);
         uint16_t random = chip8_ptr->get_random_number() & NN;
-        chip8_ptr->registers->at(reg) = random;
+        chip8_ptr->registers[reg] = random;
     }
 
     /**
@@ -514,31 +609,52 @@ namespace Chip8 {
      * The interpreter reads n bytes from memory, starting at the address stored in I.
      * These bytes are then displayed as sprites on screen at coordinates (Vx, Vy).
      * Sprites are XORed onto the existing screen. If this causes any pixels to be erased, VF is set to 1,
-     * otherwise it is set to 0. If the sprite is positioned outside the coordinates of the display,
-     * it wraps around to the opposite side of the screen.
+     * otherwise it is set to 0. The starting position wraps around the display; the parts of the
+     * sprite crossing the edge are clipped (VIP/SCHIP) or wrap to the opposite side (XO-CHIP quirk).
+     *
+     * XO-CHIP: the sprite is drawn once per bitplane selected by FN01, plane 1 first, with the
+     * data of each plane following the previous one in memory. n = 0 draws a 16x16 sprite.
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_DXYN(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_DXYN(Chip8::Chip* chip8_ptr) {
         uint16_t addr = chip8_ptr->index_reg;
-        uint8_t* sprite_ptr = chip8_ptr->memory->data() + addr;
 
-        uint8_t bytes = opcode & 0x000Fu;
+        uint8_t rows = opcode & 0x000Fu;
+        uint8_t bytes_per_row = 1;
+        if (rows == 0) {    // 16x16 sprite
+            rows = 16;
+            bytes_per_row = 2;
+        }
 
         uint8_t x = (opcode & 0x0F00u) >> 8u;
         uint8_t y = (opcode & 0x00F0u) >> 4u;
 
-        uint8_t vx = chip8_ptr->registers->at(x);
-        uint8_t vy = chip8_ptr->registers->at(y);
+        uint8_t vx = chip8_ptr->registers[x] % 64;
+        uint8_t vy = chip8_ptr->registers[y] % 32;
 
-        for (int i = 0; (i < bytes); i++) {  // add artificial upper bound at n bytes
-            draw(*sprite_ptr, vx, vy + i, chip8_ptr);
-            sprite_ptr++;
-        }
+        uint16_t planes = (chip8_ptr->plane_mask & 0x1u) + ((chip8_ptr->plane_mask >> 1) & 0x1u);
+        Access::check_range(*chip8_ptr, opcode, addr, rows * bytes_per_row * planes);
+        if constexpr (Quirks::watch_memory)
+            chip8_ptr->memory_observer->on_memory_read(addr, rows * bytes_per_row * planes);
+
+        chip8_ptr->registers[0xF] = 0;
+        for (uint8_t plane = 0x1; plane <= 0x2; plane <<= 1) {
+            if (!(chip8_ptr->plane_mask & plane)) continue;
 
+            for (int row = 0; row < rows; row++) {
+                for (int col = 0; col < bytes_per_row; col++) {
+                    uint8_t sprite_byte = chip8_ptr->memory[addr];  // uint16_t addr wraps at 64 KB
+                    draw(sprite_byte, vx + col * 8, vy + row, plane, chip8_ptr);
+                    addr++;
+                }
+            }
+        }
     }
 
-    void Instructions::OP_E(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_E(Chip8::Chip* chip8_ptr) {
         (this->*e_dispatch_table[(opcode & 0x000Fu)])(chip8_ptr);
     }
 
@@ -552,12 +668,13 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_EX9E(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_EX9E(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
-        uint8_t key_x = chip8_ptr->registers->at(reg_x);
+        uint8_t key_x = chip8_ptr->registers[reg_x];
 
         if (chip8_ptr->is_key_pressed(key_x)) {
-            chip8_ptr->program_ctr += 2;
+            skip_next_instruction(chip8_ptr);
         }
     }
 
@@ -571,21 +688,82 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_EXA1(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_EXA1(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
-        uint8_t key_x = chip8_ptr->registers->at(reg_x);
+        uint8_t key_x = chip8_ptr->registers[reg_x];
 
         if (!(chip8_ptr->is_key_pressed(key_x))) {
-            chip8_ptr->program_ctr += 2;
+            skip_next_instruction(chip8_ptr);
         }
     }
 
     // F-Ops
-    void Instructions::OP_F(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_F(Chip8::Chip* chip8_ptr) {
         (this->*f_dispatch_table[(opcode & 0x00FFu)])(chip8_ptr);    // masks last two bits and
         // executes
     }
 
+    /**
+     * @brief LD I, long addr (XO-CHIP)
+     *
+     * Set I = nnnn, where nnnn is the 16-bit word following this instruction.
+     *
+     * This is the only 4-byte instruction; the program counter skips over the address word.
+     *
+     * @param chip8_ptr
+     */
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_F000(Chip8::Chip* chip8_ptr) {
+        if (opcode != 0xF000u) {    // F100..FF00 are undefined
+            OP_NULL(chip8_ptr);
+            return;
+        }
+        uint16_t word_addr = chip8_ptr->program_ctr + 2;
+        uint8_t high = chip8_ptr->memory[word_addr];
+        uint8_t low = chip8_ptr->memory[static_cast<uint16_t>(word_addr + 1)];
+
+        chip8_ptr->index_reg = ((uint16_t) high << 8) | low;
+        chip8_ptr->program_ctr += 2;
+    }
+
+    /**
+     * @brief PLANE n (XO-CHIP)
+     *
+     * Select the bitplanes used by drawing and clearing instructions.
+     *
+     * n is a 2-bit mask: 1 = plane 1, 2 = plane 2, 3 = both, 0 = none.
+     *
+     * @param chip8_ptr
+     */
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FN01(Chip8::Chip* chip8_ptr) {
+        chip8_ptr->plane_mask = ((opcode & 0x0F00u) >> 8u) & 0x3u;
+    }
+
+    /**
+     * @brief AUDIO (XO-CHIP)
+     *
+     * Load the 16-byte audio pattern buffer from memory starting at location I.
+     *
+     * @param chip8_ptr
+     */
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_F002(Chip8::Chip* chip8_ptr) {
+        if (opcode != 0xF002u) {    // F102..FF02 are undefined
+            OP_NULL(chip8_ptr);
+            return;
+        }
+        if constexpr (Quirks::watch_memory)
+            chip8_ptr->memory_observer->on_memory_read(chip8_ptr->index_reg, chip8_ptr->audio_pattern.size());
+        Access::check_range(*chip8_ptr, opcode, chip8_ptr->index_reg, chip8_ptr->audio_pattern.size());
+        for (std::size_t i = 0; i < chip8_ptr->audio_pattern.size(); i++) {
+            chip8_ptr->audio_pattern[i] = chip8_ptr->memory[Access::address(chip8_ptr->index_reg + i)];
+        }
+        chip8_ptr->audio_pattern_dirty = true;
+    }
+
     /**
      * @brief LD Vx, DT
      *
@@ -595,11 +773,13 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_FX07(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FX07(Chip8::Chip* chip8_ptr) {
         uint8_t reg = (opcode & 0x0F00u) >> 8u;
         uint8_t delay_v = chip8_ptr->delay_timer;
 
-        chip8_ptr->registers->at(reg) = delay_v;
+        chip8_ptr->registers[reg] = delay_v;
+        chip8_ptr->delay_timer_polls += (delay_v != 0);    // spin-wait detection for adaptive IPF
     }
 
     /**
@@ -611,7 +791,8 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_FX0A(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FX0A(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
         chip8_ptr->set_waiting_register(reg_x);
         // we store the value of key inside Platform.cpp at SDL_KEYUP
@@ -626,11 +807,13 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_FX15(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FX15(Chip8::Chip* chip8_ptr) {
         uint8_t reg = (opcode & 0x0F00u) >> 8u;
-        uint8_t v = chip8_ptr->registers->at(reg);
+        uint8_t v = chip8_ptr->registers[reg];
 
         chip8_ptr->delay_timer = v;
+        chip8_ptr->delay_timer_sets++;
     }
 
     /**
@@ -642,9 +825,10 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_FX18(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FX18(Chip8::Chip* chip8_ptr) {
         uint8_t reg = (opcode & 0x0F00u) >> 8u;
-        uint8_t v = chip8_ptr->registers->at(reg);
+        uint8_t v = chip8_ptr->registers[reg];
 
         chip8_ptr->sound_timer = v;
     }
@@ -658,9 +842,10 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_FX1E(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FX1E(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
-        uint8_t val_x = chip8_ptr->registers->at(reg_x);
+        uint8_t val_x = chip8_ptr->registers[reg_x];
 
         chip8_ptr->index_reg += val_x;
     }
@@ -674,9 +859,10 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_FX29(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FX29(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
-        uint8_t val_x = chip8_ptr->registers->at(reg_x); // this should be 4 bits max
+        uint8_t val_x = chip8_ptr->registers[reg_x]; // this should be 4 bits max
 
         chip8_ptr->index_reg =
             chip8_ptr->font_start_address + (val_x * 5); // 5 bytes per sprite
@@ -694,17 +880,35 @@ namespace Chip8 {
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_FX33(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FX33(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
-        uint8_t val_x = chip8_ptr->registers->at(reg_x);
+        uint8_t val_x = chip8_ptr->registers[reg_x];
 
         uint8_t hundreds = val_x / 100; // 152 / 100 -> 1
         uint8_t tens = (val_x / 10) % 10; // 152 / 10 -> 15 -> mod 10 = 5
         uint8_t ones = (val_x % 10); // 152 % 10 -> 2
 
-        chip8_ptr->memory->at(chip8_ptr->index_reg) = hundreds;
-        chip8_ptr->memory->at(chip8_ptr->index_reg + 1) = tens;
-        chip8_ptr->memory->at(chip8_ptr->index_reg + 2) = ones;
+        Access::check_range(*chip8_ptr, opcode, chip8_ptr->index_reg, 3);
+        if constexpr (Quirks::watch_memory) chip8_ptr->memory_observer->on_memory_write(chip8_ptr->index_reg, 3);
+        chip8_ptr->write_memory(chip8_ptr->index_reg, hundreds);
+        chip8_ptr->write_memory(Access::address(chip8_ptr->index_reg + 1), tens);
+        chip8_ptr->write_memory(Access::address(chip8_ptr->index_reg + 2), ones);
+    }
+
+    /**
+     * @brief PITCH Vx (XO-CHIP)
+     *
+     * Set the audio pattern playback rate to 4000 * 2^((Vx - 64) / 48) Hz.
+     *
+     * @param chip8_ptr
+     */
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FX3A(Chip8::Chip* chip8_ptr) {
+        uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
+
+        chip8_ptr->audio_pitch = chip8_ptr->registers[reg_x];
+        chip8_ptr->audio_pattern_dirty = true;
     }
 
     /**
@@ -714,21 +918,20 @@ namespace Chip8 {
      *
      * The interpreter copies the values of registers V0 through Vx into memory,
      * starting at the address in I.
+     * VIP/XO-CHIP quirk: I is left pointing past the last stored byte (I = I + X + 1).
      *
      * @param chip8_ptr
      */
-    void Instructions::OP_FX55(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FX55(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
 
-        std::array<uint8_t, 16>::iterator reg_begin = chip8_ptr->registers->begin();
-        std::array<uint8_t, 16>::iterator reg_end = reg_begin + reg_x + 1; // include Vx for index
-
-        std::array<uint8_t, 4096>::iterator mem_ptr = chip8_ptr->memory->begin() + chip8_ptr->index_reg;
-
-        if ((chip8_ptr->index_reg + reg_x) > chip8_ptr->memory->size()) {
-            throw std::out_of_range("Memory overflow in OP_FX55");
+        Access::check_range(*chip8_ptr, opcode, chip8_ptr->index_reg, reg_x + 1);
+        if constexpr (Quirks::watch_memory) chip8_ptr->memory_observer->on_memory_write(chip8_ptr->index_reg, reg_x + 1);
+        for (uint8_t i = 0; i <= reg_x; i++) {  // include Vx
+            chip8_ptr->write_memory(Access::address(chip8_ptr->index_reg + i), chip8_ptr->registers[i]);
         }
-        std::copy(reg_begin, reg_end, mem_ptr);
+        if constexpr (Quirks::load_store_increments_i) chip8_ptr->index_reg += reg_x + 1;
     }
 
     /**
@@ -738,44 +941,77 @@ namespace Chip8 {
      *
      * The interpreter reads values from memory starting at location I
      * into registers V0 through Vx.
+     * VIP/XO-CHIP quirk: I is left pointing past the last loaded byte (I = I + X + 1).
      *
      *  @param chip8_ptr
      */
-    void Instructions::OP_FX65(std::shared_ptr<Chip8::Chip> chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_FX65(Chip8::Chip* chip8_ptr) {
         uint8_t reg_x = (opcode & 0x0F00u) >> 8u;
 
-        std::array<uint8_t, 4096>::iterator mem_begin = chip8_ptr->memory->begin() + chip8_ptr->index_reg;
-        std::array<uint8_t, 4096>::iterator mem_end = mem_begin + reg_x + 1; // included Vx for index
-
-        std::array<uint8_t, 16>::iterator register_ptr = chip8_ptr->registers->begin(); // included Vx for index
-
-        if ((chip8_ptr->index_reg + reg_x) >= chip8_ptr->memory->size()) {
-            throw std::out_of_range("Memory overflow in OP_FX65");
+        Access::check_range(*chip8_ptr, opcode, chip8_ptr->index_reg, reg_x + 1);
+        if constexpr (Quirks::watch_memory) chip8_ptr->memory_observer->on_memory_read(chip8_ptr->index_reg, reg_x + 1);
+        for (uint8_t i = 0; i <= reg_x; i++) {  // include Vx
+            chip8_ptr->registers[i] = chip8_ptr->memory[Access::address(chip8_ptr->index_reg + i)];
         }
-        std::copy(mem_begin, mem_end, register_ptr );
+        if constexpr (Quirks::load_store_increments_i) chip8_ptr->index_reg += reg_x + 1;
     }
 
-    void Instructions::OP_NULL(std::shared_ptr<Chip8::Chip> chip8_ptr) {
-        std::cout << "Performed null operation" << std::endl;
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::OP_NULL(Chip8::Chip* chip8_ptr) {
+        LOG_WARN(CPU, "unknown opcode {:04X} at {:03X}, ignored", opcode, chip8_ptr->program_ctr);
     }
 
-    void Instructions::draw(uint8_t sprite_byte, uint8_t x, uint8_t y, std::shared_ptr<Chip8::Chip>
-    chip8_ptr) {
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::draw(uint8_t sprite_byte, uint8_t x, uint8_t y, uint8_t plane,
+    Chip8::Chip* chip8_ptr) {
         for (int bit = 0; bit < 8; bit++) {
-            uint8_t sprite_pixel = (sprite_byte >> (7 - bit)) & 0x01u;; // mask out single bit
+            uint8_t sprite_pixel = (sprite_byte >> (7 - bit)) & 0x01u; // mask out single bit
+            if constexpr (Quirks::clip_sprites) {
+                if (x + bit >= 64 || y >= 32) return;   // clipped at the right/bottom edge
+            }
+            if (!sprite_pixel) continue;
 
             uint8_t wrapped_x = (x + bit) % 64;
             uint8_t wrapped_y = y % 32;
 
-            uint8_t& pixel = chip8_ptr->gfx->at(wrapped_x).at(wrapped_y);
+            uint8_t pixel = chip8_ptr->gfx[wrapped_x][wrapped_y];
 
-            if (sprite_pixel && pixel) {
-                chip8_ptr->registers->at(0xF) = 1;  // sets collision to 1
+            if (pixel & plane) {
+                chip8_ptr->registers[0xF] = 1;  // sets collision to 1
             }
-            // fix this line
-            pixel ^= sprite_pixel;
+            chip8_ptr->write_pixel(wrapped_x, wrapped_y, pixel ^ plane);
+        }
+    }
+
+    /**
+     * @brief Skips the next instruction.
+     *
+     * XO-CHIP: if the next instruction is the 4-byte F000 NNNN, both words are skipped.
+     * Elsewhere F000 is not an instruction, so a 0xF000 data word is skipped like any other.
+     *
+     * @param chip8_ptr
+     */
+    template<typename Quirks, typename Access>
+    void Instructions<Quirks, Access>::skip_next_instruction(Chip8::Chip* chip8_ptr) {
+        if constexpr (!Quirks::xo_chip_opcodes) {
+            chip8_ptr->program_ctr += 2;
+            return;
         }
+        uint16_t next_addr = chip8_ptr->program_ctr + 2;
+        uint16_t next_opcode = ((uint16_t) chip8_ptr->memory[next_addr] << 8)
+            | chip8_ptr->memory[static_cast<uint16_t>(next_addr + 1)];
+
+        chip8_ptr->program_ctr += (next_opcode == 0xF000u) ? 4 : 2;
     }
 
-    
+    // Prebuilt quirk profiles, selected at runtime by Chip::init_instr_dispatcher, all with
+    // the MemoryAccess policy of this build
+    template class Instructions<VipQuirks>;
+    template class Instructions<SchipQuirks>;
+    template class Instructions<XoChipQuirks>;
+    template class Instructions<Watched<VipQuirks>>;
+    template class Instructions<Watched<SchipQuirks>>;
+    template class Instructions<Watched<XoChipQuirks>>;
+
 } // Chip8
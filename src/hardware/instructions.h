@@ -5,36 +5,58 @@
 #include <memory>
 
 #include "chip.h"
+#include "memory_access.h"
+#include "quirks.h"
 
 namespace Chip8 {
 
     class Chip; // avoid circular declarations
 
-    class Instructions {
+    /**
+     * Runtime handle on an instruction core, so Chip can hold whichever quirk
+     * profile was selected at startup. One virtual call per opcode; everything
+     * behind it is resolved at compile time.
+     */
+    class InstructionSet {
     public:
-        static constexpr std::size_t NUM_OPS = 35;
+        virtual ~InstructionSet() = default;
+        virtual int interpret_opcode(uint16_t opcode) = 0;
+        virtual QuirkProfile profile() const = 0;
+    };
+
+    /**
+     * Instruction core for one quirk profile. Access is the addressing policy of
+     * memory_access.h: masked in release builds, checked with CHIP8_CHECKED_ACCESS.
+     */
+    template<typename Quirks, typename Access = MemoryAccess>
+    class Instructions final : public InstructionSet {
+    public:
+        static constexpr std::size_t NUM_OPS = 41;
         uint16_t opcode;
 
-        explicit Instructions(std::shared_ptr<Chip> chip8_instance);    // constructor
-        ~Instructions() = default;
+        explicit Instructions(Chip* chip8_instance);    // constructor
+        ~Instructions() override = default;
 
-        int interpret_opcode(uint16_t opcode);   // Computed goto table
+        int interpret_opcode(uint16_t opcode) override;   // Computed goto table
+        QuirkProfile profile() const override { return Quirks::profile; }
 
-        using Handler = void (Instructions::*)(std::shared_ptr<Chip8::Chip>);   // define function
+        using Handler = void (Instructions::*)(Chip8::Chip*);   // define function
         // ptr type
 
     private:
         static constexpr std::size_t DISPATCH_SIZE = 16;
 
-        std::weak_ptr<Chip8::Chip> chip8_;    // weak_ptr to break circular dependency
+        Chip8::Chip* chip8_;    // owns this dispatcher, so it always outlives it
         std::array<Handler, DISPATCH_SIZE> dispatch_table;  // func_ptr[35]
 
         static constexpr std::size_t ZERO_OPS = 0x10; // 2
+        static constexpr std::size_t FIVE_OPS = 0x10; // 3
         static constexpr std::size_t EIGHT_OPS = 0x10; // 9
         static constexpr std::size_t E_OPS = 0x10; // 2
         static constexpr std::size_t F_OPS = 0x100; // 9
 
         std::array<Handler, ZERO_OPS> zero_dispatch_table;
+        std::array<Handler, FIVE_OPS> five_dispatch_table;
         std::array<Handler, EIGHT_OPS> eight_dispatch_table;
         std::array<Handler, E_OPS> e_dispatch_table;
         std::array<Handler, F_OPS> f_dispatch_table;
@@ -42,58 +64,69 @@ namespace Chip8 {
         void init_dispatch_table();
 
         // 0-Ops
-        void OP_0(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_0NNN(std::shared_ptr<Chip8::Chip> chip8_ptr); // Call
-        void OP_00E0(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_00EE(std::shared_ptr<Chip8::Chip> chip8_ptr);
-
-        void OP_1NNN(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_2NNN(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_3XNN(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_4XNN(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_5XY0(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_6XNN(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_7XNN(std::shared_ptr<Chip8::Chip> chip8_ptr);
+        void OP_0(Chip8::Chip* chip8_ptr);
+        void OP_0NNN(Chip8::Chip* chip8_ptr); // Call
+        void OP_00E0(Chip8::Chip* chip8_ptr);
+        void OP_00EE(Chip8::Chip* chip8_ptr);
+
+        void OP_1NNN(Chip8::Chip* chip8_ptr);
+        void OP_2NNN(Chip8::Chip* chip8_ptr);
+        void OP_3XNN(Chip8::Chip* chip8_ptr);
+        void OP_4XNN(Chip8::Chip* chip8_ptr);
+
+        // 5-Ops
+        void OP_5(Chip8::Chip* chip8_ptr);
+        void OP_5XY0(Chip8::Chip* chip8_ptr);
+        void OP_5XY2(Chip8::Chip* chip8_ptr); // XO-CHIP
+        void OP_5XY3(Chip8::Chip* chip8_ptr); // XO-CHIP
+
+        void OP_6XNN(Chip8::Chip* chip8_ptr);
+        void OP_7XNN(Chip8::Chip* chip8_ptr);
 
         // 8-Ops
-        void OP_8(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_8XY0(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_8XY1(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_8XY2(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_8XY3(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_8XY4(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_8XY5(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_8XY6(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_8XY7(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_8XYE(std::shared_ptr<Chip8::Chip> chip8_ptr);
-
-        void OP_9XY0(std::shared_ptr<Chip8::Chip> chip8_ptr);
-
-        void OP_ANNN(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_BNNN(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_CXNN(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_DXYN(std::shared_ptr<Chip8::Chip> chip8_ptr);
+        void OP_8(Chip8::Chip* chip8_ptr);
+        void OP_8XY0(Chip8::Chip* chip8_ptr);
+        void OP_8XY1(Chip8::Chip* chip8_ptr);
+        void OP_8XY2(Chip8::Chip* chip8_ptr);
+        void OP_8XY3(Chip8::Chip* chip8_ptr);
+        void OP_8XY4(Chip8::Chip* chip8_ptr);
+        void OP_8XY5(Chip8::Chip* chip8_ptr);
+        void OP_8XY6(Chip8::Chip* chip8_ptr);
+        void OP_8XY7(Chip8::Chip* chip8_ptr);
+        void OP_8XYE(Chip8::Chip* chip8_ptr);
+
+        void OP_9XY0(Chip8::Chip* chip8_ptr);
+
+        void OP_ANNN(Chip8::Chip* chip8_ptr);
+        void OP_BNNN(Chip8::Chip* chip8_ptr);
+        void OP_CXNN(Chip8::Chip* chip8_ptr);
+        void OP_DXYN(Chip8::Chip* chip8_ptr);
 
         // E-Ops
-        void OP_E(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_EX9E(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_EXA1(std::shared_ptr<Chip8::Chip> chip8_ptr);
+        void OP_E(Chip8::Chip* chip8_ptr);
+        void OP_EX9E(Chip8::Chip* chip8_ptr);
+        void OP_EXA1(Chip8::Chip* chip8_ptr);
 
         // F-Ops
-        void OP_F(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_FX07(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_FX0A(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_FX15(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_FX18(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_FX1E(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_FX29(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_FX33(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_FX55(std::shared_ptr<Chip8::Chip> chip8_ptr);
-        void OP_FX65(std::shared_ptr<Chip8::Chip> chip8_ptr);
-
-        void OP_NULL(std::shared_ptr<Chip8::Chip> chip8_ptr);
-
-        void draw(uint8_t sprite_byte, uint8_t x, uint8_t y, std::shared_ptr<Chip8::Chip> chip8_ptr);
+        void OP_F(Chip8::Chip* chip8_ptr);
+        void OP_F000(Chip8::Chip* chip8_ptr); // XO-CHIP
+        void OP_FN01(Chip8::Chip* chip8_ptr); // XO-CHIP
+        void OP_F002(Chip8::Chip* chip8_ptr); // XO-CHIP
+        void OP_FX07(Chip8::Chip* chip8_ptr);
+        void OP_FX0A(Chip8::Chip* chip8_ptr);
+        void OP_FX15(Chip8::Chip* chip8_ptr);
+        void OP_FX18(Chip8::Chip* chip8_ptr);
+        void OP_FX1E(Chip8::Chip* chip8_ptr);
+        void OP_FX29(Chip8::Chip* chip8_ptr);
+        void OP_FX33(Chip8::Chip* chip8_ptr);
+        void OP_FX3A(Chip8::Chip* chip8_ptr); // XO-CHIP
+        void OP_FX55(Chip8::Chip* chip8_ptr);
+        void OP_FX65(Chip8::Chip* chip8_ptr);
+
+        void OP_NULL(Chip8::Chip* chip8_ptr);
+
+        void draw(uint8_t sprite_byte, uint8_t x, uint8_t y, uint8_t plane, Chip8::Chip* chip8_ptr);
+        void skip_next_instruction(Chip8::Chip* chip8_ptr);
     };
 }
 
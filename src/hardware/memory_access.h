@@ -0,0 +1,119 @@
+#ifndef MEMORY_ACCESS_H
+#define MEMORY_ACCESS_H
+
+#include <cstdint>
+#include <format>
+#include <stdexcept>
+#include <string>
+
+#include "chip_state.h"
+
+// 1 traps ROM faults with a MachineFault (CMake Debug builds), 0 masks every index into range
+#ifndef CHIP8_CHECKED_ACCESS
+#define CHIP8_CHECKED_ACCESS 0
+#endif
+
+namespace Chip8 {
+
+    /**
+     * A ROM reached outside the machine: stack under/overflow, or an I-relative access
+     * running past the end of memory. Only CheckedAccess throws it.
+     */
+    class MachineFault : public std::runtime_error {
+    public:
+        MachineFault(uint16_t pc, uint16_t opcode, const std::string& what) :
+        std::runtime_error(std::format("{:04X} at {:04X}: {}", opcode, pc, what)),
+        pc(pc),
+        opcode(opcode)
+        {}
+
+        const uint16_t pc;
+        const uint16_t opcode;
+    };
+
+    /**
+     * 00EE with an empty stack or a 17th nested 2NNN.
+     */
+    class StackFault : public MachineFault {
+    public:
+        using MachineFault::MachineFault;
+    };
+
+    /**
+     * An I-relative access (FX33, FX55, FX65, 5XY2, 5XY3, DXYN, F002) running past the end
+     * of memory.
+     */
+    class MemoryRangeFault : public MachineFault {
+    public:
+        using MachineFault::MachineFault;
+    };
+
+    /**
+     * How the instruction core indexes memory and the stack, a compile-time policy of
+     * Instructions like the quirk profiles:
+     *
+     *  - MaskedAccess: addresses wrap at 64 KB and the stack pointer at 16 entries, so
+     *    no index can leave its array and no access costs a branch.
+     *  - CheckedAccess: the same addressing, but a stack under/overflow or an I-relative
+     *    range running past the end of memory throws a MachineFault naming PC and opcode.
+     *
+     * Register indices come from 4-bit opcode fields and are in range by construction.
+     */
+    struct MaskedAccess {
+        static constexpr bool checked = false;
+
+        static constexpr uint16_t address(uint32_t addr) {
+            return static_cast<uint16_t>(addr & (ChipState::memory_size - 1));
+        }
+
+        static void check_range(const ChipState&, uint16_t, uint32_t, uint32_t) {}
+
+        static void push(ChipState& state, uint16_t, uint16_t return_addr) {
+            state.stack[state.stack_ptr & 0xFu] = return_addr;
+            state.stack_ptr = (state.stack_ptr + 1) & 0xFu;
+        }
+
+        static uint16_t pop(ChipState& state, uint16_t) {
+            state.stack_ptr = (state.stack_ptr - 1) & 0xFu;
+            return state.stack[state.stack_ptr];
+        }
+    };
+
+    struct CheckedAccess {
+        static constexpr bool checked = true;
+
+        static constexpr uint16_t address(uint32_t addr) {
+            return MaskedAccess::address(addr);
+        }
+
+        /**
+         * @brief Traps unless the length bytes from addr all lie in memory.
+         */
+        static void check_range(const ChipState& state, uint16_t opcode, uint32_t addr, uint32_t length) {
+            if (addr + length > ChipState::memory_size)
+                throw MemoryRangeFault(state.program_ctr, opcode,
+                    std::format("{} bytes at I={:04X} run past the end of memory", length, addr));
+        }
+
+        static void push(ChipState& state, uint16_t opcode, uint16_t return_addr) {
+            if (state.stack_ptr >= state.stack.size())
+                throw StackFault(state.program_ctr, opcode, std::format("stack overflow, {} calls deep", state.stack_ptr));
+            state.stack[state.stack_ptr++] = return_addr;
+        }
+
+        static uint16_t pop(ChipState& state, uint16_t opcode) {
+            if (state.stack_ptr == 0 || state.stack_ptr > state.stack.size())
+                throw StackFault(state.program_ctr, opcode, std::format("stack underflow, SP={}", state.stack_ptr));
+            return state.stack[--state.stack_ptr];
+        }
+    };
+
+#if CHIP8_CHECKED_ACCESS
+    using MemoryAccess = CheckedAccess;
+#else
+    using MemoryAccess = MaskedAccess;
+#endif
+
+} // Chip8
+
+#endif //MEMORY_ACCESS_H
@@ -0,0 +1,23 @@
+#ifndef MEMORY_OBSERVER_H
+#define MEMORY_OBSERVER_H
+
+#include <cstdint>
+
+namespace Chip8 {
+
+/**
+ * Notified of the I-addressed memory accesses of the instruction core.
+ *
+ * Only instantiations built with a Watched<Quirks> policy call it, so the normal
+ * instruction core carries no hooks at all. Ranges may wrap around 0xFFFF.
+ */
+class MemoryObserver {
+public:
+    virtual ~MemoryObserver() = default;
+    virtual void on_memory_read(uint16_t addr, uint16_t length) = 0;   // DXYN, FX65, 5XY3, F002
+    virtual void on_memory_write(uint16_t addr, uint16_t length) = 0;  // FX55, FX33, 5XY2
+};
+
+} // Chip8
+
+#endif //MEMORY_OBSERVER_H
@@ -0,0 +1,83 @@
+#ifndef QUIRKS_H
+#define QUIRKS_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace Chip8 {
+
+    /**
+     * Behavioural differences between CHIP-8 interpreters.
+     *
+     * Each profile is a compile-time policy for Instructions<Quirks>: the handlers
+     * test these constants with `if constexpr`, so the chosen instantiation carries
+     * no quirk branches at all. The profile is picked once at startup.
+     */
+    enum class QuirkProfile : uint8_t {
+        VIP,    // original COSMAC VIP interpreter
+        SCHIP,  // SUPER-CHIP 1.1 (modern CHIP-8 behaviour, emulator default)
+        XOCHIP  // XO-CHIP (Octo)
+    };
+
+    struct VipQuirks {
+        static constexpr QuirkProfile profile = QuirkProfile::VIP;
+        static constexpr bool shift_uses_vy = true;           // 8XY6/8XYE shift VY into VX
+        static constexpr bool load_store_increments_i = true; // FX55/FX65 leave I = I + X + 1
+        static constexpr bool jump_uses_vx = false;           // BNNN jumps to NNN + V0
+        static constexpr bool logic_resets_vf = true;         // 8XY1/8XY2/8XY3 set VF = 0
+        static constexpr bool clip_sprites = true;            // DXYN clips at the screen edge
+        static constexpr bool xo_chip_opcodes = false;        // F000 NNNN, FN01, F002, FX3A, 5XY2/5XY3
+        static constexpr bool watch_memory = false;           // see Watched
+    };
+
+    struct SchipQuirks {
+        static constexpr QuirkProfile profile = QuirkProfile::SCHIP;
+        static constexpr bool shift_uses_vy = false;          // 8XY6/8XYE shift VX in place
+        static constexpr bool load_store_increments_i = false;
+        static constexpr bool jump_uses_vx = true;            // BXNN jumps to XNN + VX
+        static constexpr bool logic_resets_vf = false;
+        static constexpr bool clip_sprites = true;
+        static constexpr bool xo_chip_opcodes = false;
+        static constexpr bool watch_memory = false;
+    };
+
+    struct XoChipQuirks {
+        static constexpr QuirkProfile profile = QuirkProfile::XOCHIP;
+        static constexpr bool shift_uses_vy = true;
+        static constexpr bool load_store_increments_i = true;
+        static constexpr bool jump_uses_vx = false;
+        static constexpr bool logic_resets_vf = false;
+        static constexpr bool clip_sprites = false;           // DXYN wraps around the screen
+        static constexpr bool xo_chip_opcodes = true;
+        static constexpr bool watch_memory = false;
+    };
+
+    /**
+     * Same quirks, plus calls to the chip's MemoryObserver on every I-addressed memory
+     * access. Only instantiated while the debugger has watchpoints set.
+     */
+    template<typename Quirks>
+    struct Watched : Quirks {
+        static constexpr bool watch_memory = true;
+    };
+
+    inline std::optional<QuirkProfile> parse_quirk_profile(const std::string& name) {
+        if (name == "vip") return QuirkProfile::VIP;
+        if (name == "schip") return QuirkProfile::SCHIP;
+        if (name == "xochip") return QuirkProfile::XOCHIP;
+        return std::nullopt;
+    }
+
+    inline const char* quirk_profile_name(QuirkProfile profile) {
+        switch (profile) {
+            case QuirkProfile::VIP: return "vip";
+            case QuirkProfile::SCHIP: return "schip";
+            case QuirkProfile::XOCHIP: return "xochip";
+        }
+        return "unknown";
+    }
+
+} // Chip8
+
+#endif //QUIRKS_H
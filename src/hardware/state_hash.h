@@ -0,0 +1,56 @@
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Chip8 {
+    /**
+     * Position-keyed XOR hashing (Zobrist style) for large state blocks.
+     *
+     * A block's hash is the XOR of one 64-bit key per (index, value) pair, so a single
+     * byte write is folded in with two key evaluations instead of rehashing the block.
+     * Keys are derived on the fly with the splitmix64 finalizer, no tables needed.
+     */
+    namespace StateHash {
+        // distinct seeds so identical bytes in memory and gfx do not cancel out
+        constexpr uint64_t MEMORY_SEED = 0x6A09E667F3BCC908ull;
+        constexpr uint64_t GFX_SEED    = 0xBB67AE8584CAA73Bull;
+        constexpr uint64_t CPU_SEED    = 0x3C6EF372FE94F82Bull;
+
+        constexpr uint64_t mix(uint64_t x) {
+            x += 0x9E3779B97F4A7C15ull;
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+            return x ^ (x >> 31);
+        }
+
+        /**
+         * @brief Key of one byte of a block.
+         */
+        constexpr uint64_t key(uint64_t seed, std::size_t index, uint8_t value) {
+            return mix(seed ^ (static_cast<uint64_t>(index) << 8) ^ value);
+        }
+
+        /**
+         * @brief Folds a write of old_value -> new_value at index into a block hash.
+         */
+        constexpr void update(uint64_t& hash, uint64_t seed, std::size_t index, uint8_t old_value, uint8_t new_value) {
+            if (old_value != new_value)
+                hash ^= key(seed, index, old_value) ^ key(seed, index, new_value);
+        }
+
+        /**
+         * @brief Full hash of a block, used after bulk writes and to check the incremental one.
+         */
+        inline uint64_t block(uint64_t seed, const uint8_t* data, std::size_t size) {
+            uint64_t hash = 0;
+            for (std::size_t i = 0; i < size; i++) {
+                hash ^= key(seed, i, data[i]);
+            }
+            return hash;
+        }
+    }
+}
+
+#endif // STATE_HASH_H
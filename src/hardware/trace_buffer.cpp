@@ -0,0 +1,131 @@
+#include "trace_buffer.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define CHIP8_TRACE_POSIX 1
+#endif
+
+namespace Chip8 {
+    namespace {
+        // Crash handler state: a signal handler can only reach globals
+        const TraceBuffer* crash_buffer = nullptr;
+        char crash_path[512] = {};
+        constexpr int crash_signals[] = {SIGSEGV, SIGABRT, SIGFPE, SIGILL};
+
+        void crash_signal_handler(int signal) {
+            if (crash_buffer) {
+                crash_buffer->dump(crash_path);
+                crash_buffer = nullptr;     // dump once
+            }
+            std::signal(signal, SIG_DFL);
+            std::raise(signal);
+        }
+    }
+
+    /**
+     * @brief Allocates the ring.
+     *
+     * @param capacity Number of records kept, must be a power of two.
+     * @throws std::invalid_argument if capacity is not a power of two.
+     */
+    TraceBuffer::TraceBuffer(std::size_t capacity) :
+    mask_(capacity - 1),
+    records_(std::make_unique<TraceRecord[]>(capacity)) {
+        if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+            throw std::invalid_argument("TraceBuffer capacity must be a power of two");
+    }
+
+    /**
+     * @brief Uninstalls the crash handler if it still dumps this trace.
+     */
+    TraceBuffer::~TraceBuffer() {
+        if (crash_buffer == this) {
+            for (int signal : crash_signals) {
+                std::signal(signal, SIG_DFL);
+            }
+            crash_buffer = nullptr;
+        }
+    }
+
+    uint64_t TraceBuffer::total() const {
+        return head_;
+    }
+
+    std::size_t TraceBuffer::capacity() const {
+        return mask_ + 1;
+    }
+
+    /**
+     * @brief Writes the most recent records to a file.
+     *
+     * @param path Output file, see the class comment for the format.
+     * @return True on success.
+     */
+    bool TraceBuffer::dump(const std::string& path) const {
+        return dump(path.c_str());
+    }
+
+    /**
+     * @brief Writes the header and the live window of the ring, oldest first.
+     *
+     * Only uses calls that are async-signal-safe on POSIX, so the crash handler can use it.
+     *
+     * @param path Output file.
+     * @return True on success.
+     */
+    bool TraceBuffer::dump(const char* path) const {
+        const uint64_t head = total();
+        const std::size_t capacity = mask_ + 1;
+        const std::size_t count = head < capacity ? static_cast<std::size_t>(head) : capacity;
+        const std::size_t first = static_cast<std::size_t>((head - count) & mask_);
+        const TraceRecord* records = records_.get();
+
+        TraceHeader header{{'C', '8', 'T', 'R'}, BYTE_ORDER_MARK, FORMAT_VERSION,
+            static_cast<uint32_t>(count), head};
+
+        // the window may wrap around the end of the array: write it in two runs
+        const std::size_t first_run = count < capacity - first ? count : capacity - first;
+        const std::size_t second_run = count - first_run;
+#ifdef CHIP8_TRACE_POSIX
+        int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        bool ok = ::write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header));
+        ok = ok && ::write(fd, records + first, first_run * sizeof(TraceRecord))
+            == static_cast<ssize_t>(first_run * sizeof(TraceRecord));
+        ok = ok && ::write(fd, records, second_run * sizeof(TraceRecord))
+            == static_cast<ssize_t>(second_run * sizeof(TraceRecord));
+        ::close(fd);
+        return ok;
+#else
+        std::FILE* file = std::fopen(path, "wb");
+        if (!file) return false;
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && std::fwrite(records + first, sizeof(TraceRecord), first_run, file) == first_run;
+        ok = ok && std::fwrite(records, sizeof(TraceRecord), second_run, file) == second_run;
+        std::fclose(file);
+        return ok;
+#endif
+    }
+
+    /**
+     * @brief Dumps this trace to path if the process dies on SIGSEGV, SIGABRT, SIGFPE or SIGILL.
+     *
+     * An uncaught exception ends in std::abort, so ROM faults are covered too.
+     *
+     * @param path Output file for the crash dump.
+     */
+    void TraceBuffer::install_crash_handler(const std::string& path) {
+        std::strncpy(crash_path, path.c_str(), sizeof(crash_path) - 1);
+        crash_buffer = this;
+        for (int signal : crash_signals) {
+            std::signal(signal, crash_signal_handler);
+        }
+    }
+
+} // Chip8
@@ -0,0 +1,79 @@
+#ifndef TRACE_BUFFER_H
+#define TRACE_BUFFER_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace Chip8 {
+
+/**
+ * One executed instruction, 8 bytes, written in host byte order.
+ *
+ * Instead of diffing the register file, the record keeps Vx (X taken from the opcode)
+ * and VF after execution: together they are the registers almost every instruction
+ * writes, and reading two bytes is cheaper than a diff.
+ */
+struct TraceRecord {
+    uint16_t pc;        // address the opcode was fetched from
+    uint16_t opcode;
+    uint16_t index_reg; // I after execution
+    uint8_t vx;         // Vx after execution
+    uint8_t vf;         // VF after execution
+};
+static_assert(sizeof(TraceRecord) == 8, "TraceRecord must stay packed");
+
+struct TraceHeader {
+    char magic[4];          // "C8TR"
+    uint32_t byte_order;    // TraceBuffer::BYTE_ORDER_MARK
+    uint32_t version;
+    uint32_t count;         // records that follow
+    uint64_t total;         // instructions traced over the whole run
+};
+static_assert(sizeof(TraceHeader) == 24, "TraceHeader must stay packed");
+
+/**
+ * Fixed-size ring of the most recent instructions.
+ *
+ * The emulation thread is the only writer: a record is one 8-byte store and a plain
+ * counter bump, no atomics or fences per instruction (about 2% of headless speed).
+ * Dumps run on that thread too (F12, exit, or the crash handler interrupting it) and
+ * copy the last `capacity` records in execution order, so the counter never needs
+ * publishing to another thread.
+ *
+ * File format (host byte order): a TraceHeader followed by TraceRecord[count],
+ * oldest first. The first record is instruction number total - count of the run.
+ */
+class TraceBuffer {
+public:
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr std::size_t DEFAULT_CAPACITY = 1u << 12;    // 32 KB, stays in L1/L2 while recording
+
+    explicit TraceBuffer(std::size_t capacity = DEFAULT_CAPACITY);
+    ~TraceBuffer();
+
+    void record(uint16_t pc, uint16_t opcode, uint16_t index_reg, uint8_t vx, uint8_t vf) {
+        const TraceRecord record{pc, opcode, index_reg, vx, vf};
+        std::memcpy(&records_[head_ & mask_], &record, sizeof(record));    // one 8-byte store
+        ++head_;
+    }
+
+    uint64_t total() const;
+    std::size_t capacity() const;
+
+    bool dump(const std::string& path) const;
+    bool dump(const char* path) const;     // async-signal-safe on POSIX
+
+    void install_crash_handler(const std::string& path);
+
+private:
+    const std::size_t mask_;
+    const std::unique_ptr<TraceRecord[]> records_;
+    uint64_t head_ = 0;     // emulation thread only, see the class comment
+};
+
+} // Chip8
+
+#endif //TRACE_BUFFER_H
@@ -0,0 +1,243 @@
+#include "log.h"
+
+#include <array>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Chip8::Log {
+    namespace {
+        constexpr std::size_t QUEUE_CAPACITY = 1024;    // power of two
+
+        const char* level_name(LogLevel level) {
+            switch (level) {
+                case LogLevel::TRACE: return "trace";
+                case LogLevel::DEBUG: return "debug";
+                case LogLevel::INFO: return "info";
+                case LogLevel::WARN: return "warn";
+                case LogLevel::ERROR: return "error";
+                case LogLevel::OFF: return "off";
+            }
+            return "?";
+        }
+
+        const char* category_name(LogCategory category) {
+            switch (category) {
+                case LogCategory::CPU: return "cpu";
+                case LogCategory::GFX: return "gfx";
+                case LogCategory::AUDIO: return "audio";
+                case LogCategory::INPUT: return "input";
+                case LogCategory::PLATFORM: return "platform";
+                case LogCategory::NET: return "net";
+            }
+            return "?";
+        }
+
+        struct Record {
+            LogLevel level;
+            LogCategory category;
+            uint64_t suppressed;
+            std::chrono::steady_clock::time_point time;
+            std::string message;
+        };
+
+        /**
+         * Bounded multi-producer single-consumer queue (Vyukov): each cell carries a
+         * sequence number telling producers and the consumer whose turn it is.
+         */
+        class RecordQueue {
+        public:
+            RecordQueue() {
+                for (std::size_t i = 0; i < QUEUE_CAPACITY; i++) cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            bool push(Record&& record) {
+                std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+                Cell* cell;
+                for (;;) {
+                    cell = &cells_[pos & (QUEUE_CAPACITY - 1)];
+                    std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                    auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+                    if (diff == 0) {
+                        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+                    }
+                    else if (diff < 0) {
+                        return false;   // full
+                    }
+                    else {
+                        pos = enqueue_pos_.load(std::memory_order_relaxed);
+                    }
+                }
+                cell->record = std::move(record);
+                cell->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool pop(Record& record) {
+                Cell& cell = cells_[dequeue_pos_ & (QUEUE_CAPACITY - 1)];
+                if (cell.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) return false;
+                record = std::move(cell.record);
+                cell.sequence.store(dequeue_pos_ + QUEUE_CAPACITY, std::memory_order_release);
+                dequeue_pos_++;
+                return true;
+            }
+
+        private:
+            struct Cell {
+                std::atomic<std::size_t> sequence;
+                Record record;
+            };
+            std::array<Cell, QUEUE_CAPACITY> cells_;
+            alignas(64) std::atomic<std::size_t> enqueue_pos_{0};
+            alignas(64) std::size_t dequeue_pos_{0};    // consumer only
+        };
+
+        /**
+         * Queue plus the writer thread draining it to stderr.
+         */
+        class Logger {
+        public:
+            ~Logger() { stop(); }
+
+            void submit(Record&& record) {
+                std::call_once(started_, [this] { writer_ = std::thread(&Logger::run, this); });
+                if (!queue_.push(std::move(record))) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                pushed_.fetch_add(1, std::memory_order_release);
+                wake();
+            }
+
+            void flush() {
+                uint64_t target = pushed_.load(std::memory_order_acquire);
+                uint64_t written = written_.load(std::memory_order_acquire);
+                while (writer_.joinable() && written < target) {
+                    written_.wait(written);
+                    written = written_.load(std::memory_order_acquire);
+                }
+            }
+
+            void stop() {
+                std::lock_guard<std::mutex> lock(stop_mutex_);
+                if (!writer_.joinable()) return;
+                stopping_.store(true, std::memory_order_release);
+                wake();
+                writer_.join();
+            }
+
+            uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+            std::atomic<LogLevel> level{LogLevel::INFO};
+            std::atomic<uint8_t> category_mask{0xFF};
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        private:
+            void wake() {
+                wakeups_.fetch_add(1, std::memory_order_release);
+                wakeups_.notify_one();
+            }
+
+            void run() {
+                Record record;
+                for (;;) {
+                    uint32_t wakeups = wakeups_.load(std::memory_order_acquire);
+                    while (queue_.pop(record)) {
+                        print(record);
+                        written_.fetch_add(1, std::memory_order_release);
+                    }
+                    std::fflush(stderr);
+                    written_.notify_all();
+                    if (stopping_.load(std::memory_order_acquire)) return;
+                    wakeups_.wait(wakeups);     // sleeps until the next submit or stop
+                }
+            }
+
+            void print(const Record& record) const {
+                std::chrono::duration<double> since_start = record.time - start;
+                std::string line = std::format("[{:9.3f}] {:<8} {:<5} {}", since_start.count(),
+                    category_name(record.category), level_name(record.level), record.message);
+                if (record.suppressed > 0)
+                    line += std::format(" ({} similar suppressed)", record.suppressed);
+                line += '\n';
+                std::fwrite(line.data(), 1, line.size(), stderr);
+            }
+
+            RecordQueue queue_;
+            std::atomic<uint64_t> pushed_{0};
+            std::atomic<uint64_t> written_{0};
+            std::atomic<uint64_t> dropped_{0};
+            std::atomic<uint32_t> wakeups_{0};
+            std::atomic<bool> stopping_{false};
+            std::once_flag started_;
+            std::mutex stop_mutex_;
+            std::thread writer_;
+        };
+
+        std::atomic<uint64_t> unreported_suppressed{0};    // suppressed, not yet mentioned in a line
+
+        Logger& logger() {
+            static Logger instance;
+            return instance;
+        }
+    }
+
+    bool Site::admit() {
+        int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t window_end = window_end_ns_.load(std::memory_order_relaxed);
+        if (now >= window_end &&
+            window_end_ns_.compare_exchange_strong(window_end, now + std::chrono::nanoseconds(INTERVAL).count(),
+                std::memory_order_relaxed)) {
+            count_.store(0, std::memory_order_relaxed);
+        }
+        if (count_.fetch_add(1, std::memory_order_relaxed) < BURST) return true;
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        unreported_suppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    bool enabled(LogLevel level, LogCategory category) {
+        Logger& log = logger();
+        return level >= log.level.load(std::memory_order_relaxed) &&
+            (log.category_mask.load(std::memory_order_relaxed) >> static_cast<uint8_t>(category)) & 1u;
+    }
+
+    void write(LogLevel level, LogCategory category, uint64_t suppressed, std::string message) {
+        unreported_suppressed.fetch_sub(suppressed, std::memory_order_relaxed);
+        logger().submit(Record{level, category, suppressed, std::chrono::steady_clock::now(), std::move(message)});
+    }
+
+    void set_level(LogLevel level) {
+        logger().level.store(level, std::memory_order_relaxed);
+    }
+
+    void set_category(LogCategory category, bool enabled) {
+        uint8_t bit = static_cast<uint8_t>(1u << static_cast<uint8_t>(category));
+        if (enabled) logger().category_mask.fetch_or(bit, std::memory_order_relaxed);
+        else logger().category_mask.fetch_and(static_cast<uint8_t>(~bit), std::memory_order_relaxed);
+    }
+
+    std::optional<LogLevel> parse_level(const std::string& name) {
+        for (uint8_t i = 0; i <= static_cast<uint8_t>(LogLevel::OFF); i++) {
+            if (name == level_name(static_cast<LogLevel>(i))) return static_cast<LogLevel>(i);
+        }
+        return std::nullopt;
+    }
+
+    void flush() {
+        logger().flush();
+    }
+
+    void shutdown() {
+        uint64_t suppressed = unreported_suppressed.exchange(0);
+        if (suppressed > 0 && enabled(LogLevel::INFO, LogCategory::PLATFORM))
+            write(LogLevel::INFO, LogCategory::PLATFORM, 0, std::format("{} repeated messages were suppressed", suppressed));
+        logger().stop();
+    }
+
+    uint64_t dropped() {
+        return logger().dropped();
+    }
+} // Chip8::Log
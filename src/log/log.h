@@ -0,0 +1,81 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+
+namespace Chip8 {
+
+enum class LogLevel : uint8_t { TRACE, DEBUG, INFO, WARN, ERROR, OFF };
+enum class LogCategory : uint8_t { CPU, GFX, AUDIO, INPUT, PLATFORM, NET };
+
+// Messages below this level are compiled out entirely (-DCHIP8_LOG_LEVEL=0 keeps everything)
+#ifndef CHIP8_LOG_LEVEL
+#define CHIP8_LOG_LEVEL 2   // INFO
+#endif
+
+/**
+ * Asynchronous logging for code that must not stall on the console.
+ *
+ * CHIP8_LOG formats the message and pushes it into a bounded lock-free queue; a
+ * background thread (started with the first message) writes it to stderr. Levels below
+ * CHIP8_LOG_LEVEL cost nothing, runtime level and category filters cost one load, and
+ * every call site is rate limited: a ROM executing an unknown opcode in a tight loop
+ * produces a few lines per second plus a count of what was suppressed.
+ */
+namespace Log {
+    constexpr LogLevel COMPILED_LEVEL = static_cast<LogLevel>(CHIP8_LOG_LEVEL);
+
+    /**
+     * Rate limiter of one call site: at most BURST messages per INTERVAL.
+     */
+    class Site {
+    public:
+        static constexpr unsigned BURST = 10;
+        static constexpr std::chrono::milliseconds INTERVAL{1000};
+
+        bool admit();
+        uint64_t take_suppressed() { return suppressed_.exchange(0, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<unsigned> count_{0};            // messages in the current window
+        std::atomic<int64_t> window_end_ns_{0};     // steady_clock
+        std::atomic<uint64_t> suppressed_{0};
+    };
+
+    bool enabled(LogLevel level, LogCategory category);
+    void write(LogLevel level, LogCategory category, uint64_t suppressed, std::string message);
+
+    void set_level(LogLevel level);
+    void set_category(LogCategory category, bool enabled);
+    std::optional<LogLevel> parse_level(const std::string& name);
+
+    void flush();       // waits until everything queued so far is written
+    void shutdown();    // flushes and stops the writer thread
+    uint64_t dropped(); // messages lost to a full queue
+}
+
+} // Chip8
+
+#define CHIP8_LOG(level, category, ...) \
+    do { \
+        if constexpr ((level) >= ::Chip8::Log::COMPILED_LEVEL) { \
+            if (::Chip8::Log::enabled((level), (category))) { \
+                static ::Chip8::Log::Site chip8_log_site; \
+                if (chip8_log_site.admit()) \
+                    ::Chip8::Log::write((level), (category), chip8_log_site.take_suppressed(), std::format(__VA_ARGS__)); \
+            } \
+        } \
+    } while (0)
+
+#define LOG_TRACE(category, ...) CHIP8_LOG(::Chip8::LogLevel::TRACE, ::Chip8::LogCategory::category, __VA_ARGS__)
+#define LOG_DEBUG(category, ...) CHIP8_LOG(::Chip8::LogLevel::DEBUG, ::Chip8::LogCategory::category, __VA_ARGS__)
+#define LOG_INFO(category, ...)  CHIP8_LOG(::Chip8::LogLevel::INFO, ::Chip8::LogCategory::category, __VA_ARGS__)
+#define LOG_WARN(category, ...)  CHIP8_LOG(::Chip8::LogLevel::WARN, ::Chip8::LogCategory::category, __VA_ARGS__)
+#define LOG_ERROR(category, ...) CHIP8_LOG(::Chip8::LogLevel::ERROR, ::Chip8::LogCategory::category, __VA_ARGS__)
+
+#endif //LOG_H
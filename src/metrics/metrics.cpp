@@ -0,0 +1,202 @@
+#include "metrics.h"
+
+#include <format>
+#include <map>
+
+#include "../hardware/chip.h"
+
+namespace Chip8 {
+    namespace {
+        struct CounterInfo {
+            const char* name;
+            const char* help;
+        };
+
+        constexpr CounterInfo COUNTERS[] = {
+            {"chip8_frames_emulated_total", "Frames emulated (60 per second when paced)."},
+            {"chip8_instructions_executed_total", "CHIP-8 instructions executed."},
+            {"chip8_frame_deadline_misses_total", "Frames whose work took longer than the 60 Hz period."},
+            {"chip8_audio_underruns_total", "Audio callbacks that arrived after the device ran dry."},
+        };
+        static_assert(std::size(COUNTERS) == static_cast<std::size_t>(Counter::COUNT));
+
+        constexpr CounterInfo HISTOGRAMS[] = {
+            {"chip8_frame_work_seconds", "Host time spent emulating, rendering and presenting one frame."},
+            {"chip8_sleep_overshoot_seconds", "How much longer than requested the frame pacing sleep took."},
+        };
+        static_assert(std::size(HISTOGRAMS) == static_cast<std::size_t>(Histogram::COUNT));
+
+        uint64_t load(const std::atomic<uint64_t>& value) {
+            return value.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Adds one observation to a histogram, clamped at zero.
+     */
+    void MetricsShard::observe(Histogram histogram, std::chrono::microseconds value) {
+        const uint64_t us = value.count() > 0 ? static_cast<uint64_t>(value.count()) : 0;
+        std::size_t bucket = 0;
+        while (bucket < bucket_bounds.size() && us > bucket_bounds[bucket]) {
+            bucket++;
+        }
+        HistogramData& data = histograms_[static_cast<std::size_t>(histogram)];
+        bump(data.buckets[bucket], 1);
+        bump(data.sum_us, us);
+    }
+
+    /**
+     * @brief Allocates the per-opcode counters of this shard (once).
+     *
+     * @return Chip::opcode_slots counters indexed by Chip::opcode_slot, for Chip::opcode_counts.
+     */
+    std::atomic<uint64_t>* MetricsShard::enable_opcode_counts() {
+        if (!opcodes_)
+            opcodes_ = std::make_unique<std::atomic<uint64_t>[]>(Chip::opcode_slots);  // value-initialized to 0
+        return opcodes_.get();
+    }
+
+    /**
+     * @brief A new shard for the calling thread; only that thread may write to it.
+     */
+    MetricsShard& Metrics::make_shard() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return shards_.emplace_back();
+    }
+
+    uint64_t Metrics::total(Counter counter) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t sum = 0;
+        for (const MetricsShard& shard : shards_) {
+            sum += load(shard.counters_[static_cast<std::size_t>(counter)]);
+        }
+        return sum;
+    }
+
+    /**
+     * @brief Every counter and histogram in the Prometheus text exposition format.
+     *
+     * Opcode counts are summed per instruction pattern; patterns never executed are left out.
+     */
+    std::string Metrics::prometheus_text() const {
+        std::array<uint64_t, static_cast<std::size_t>(Counter::COUNT)> counters{};
+        std::array<std::array<uint64_t, MetricsShard::bucket_count>, static_cast<std::size_t>(Histogram::COUNT)> buckets{};
+        std::array<uint64_t, static_cast<std::size_t>(Histogram::COUNT)> sums_us{};
+        std::map<std::string_view, uint64_t> opcodes;
+        bool opcodes_enabled = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const MetricsShard& shard : shards_) {
+                for (std::size_t c = 0; c < counters.size(); c++) {
+                    counters[c] += load(shard.counters_[c]);
+                }
+                for (std::size_t h = 0; h < buckets.size(); h++) {
+                    for (std::size_t b = 0; b < MetricsShard::bucket_count; b++) {
+                        buckets[h][b] += load(shard.histograms_[h].buckets[b]);
+                    }
+                    sums_us[h] += load(shard.histograms_[h].sum_us);
+                }
+                if (shard.opcodes_) {
+                    opcodes_enabled = true;
+                    for (std::size_t slot = 0; slot < Chip::opcode_slots; slot++) {
+                        if (uint64_t count = load(shard.opcodes_[slot]))
+                            opcodes[opcode_pattern(slot)] += count;
+                    }
+                }
+            }
+        }
+
+        std::string text;
+        for (std::size_t c = 0; c < counters.size(); c++) {
+            text += std::format("# HELP {0} {1}\n# TYPE {0} counter\n{0} {2}\n", COUNTERS[c].name, COUNTERS[c].help, counters[c]);
+        }
+        for (std::size_t h = 0; h < buckets.size(); h++) {
+            const char* name = HISTOGRAMS[h].name;
+            text += std::format("# HELP {0} {1}\n# TYPE {0} histogram\n", name, HISTOGRAMS[h].help);
+            uint64_t cumulative = 0;
+            for (std::size_t b = 0; b < MetricsShard::bucket_count; b++) {
+                cumulative += buckets[h][b];
+                if (b < MetricsShard::bucket_bounds.size())
+                    text += std::format("{}_bucket{{le=\"{}\"}} {}\n", name, MetricsShard::bucket_bounds[b] / 1e6, cumulative);
+                else
+                    text += std::format("{}_bucket{{le=\"+Inf\"}} {}\n", name, cumulative);
+            }
+            text += std::format("{}_sum {}\n{}_count {}\n", name, sums_us[h] / 1e6, name, cumulative);
+        }
+        if (opcodes_enabled) {
+            text += "# HELP chip8_opcode_executed_total Instructions executed by the interpreter, per opcode pattern.\n"
+                    "# TYPE chip8_opcode_executed_total counter\n";
+            for (const auto& [pattern, count] : opcodes) {
+                text += std::format("chip8_opcode_executed_total{{opcode=\"{}\"}} {}\n", pattern, count);
+            }
+        }
+        return text;
+    }
+
+    /**
+     * @brief Names the instruction counted in an opcode slot.
+     *
+     * A slot keeps the first nibble and the low byte of the opcode, which tells every
+     * CHIP-8, SCHIP and XO-CHIP instruction apart (0NNN with a nonzero X is counted as
+     * whatever its low byte looks like, e.g. 0NE0 as 00E0).
+     */
+    std::string_view Metrics::opcode_pattern(std::size_t slot) {
+        static constexpr std::string_view ALU[16] = {"8XY0", "8XY1", "8XY2", "8XY3", "8XY4", "8XY5", "8XY6", "8XY7",
+            "unknown", "unknown", "unknown", "unknown", "unknown", "unknown", "8XYE", "unknown"};
+        static constexpr std::string_view FIXED[16] = {"", "1NNN", "2NNN", "3XNN", "4XNN", "", "6XNN", "7XNN",
+            "", "9XY0", "ANNN", "BNNN", "CXNN", "DXYN", "", ""};
+
+        const std::size_t nibble = slot >> 8 & 0xF;
+        const uint8_t low = static_cast<uint8_t>(slot);
+        switch (nibble) {
+            case 0x0:
+                switch (low) {
+                    case 0xE0: return "00E0";
+                    case 0xEE: return "00EE";
+                    case 0xFB: return "00FB";
+                    case 0xFC: return "00FC";
+                    case 0xFD: return "00FD";
+                    case 0xFE: return "00FE";
+                    case 0xFF: return "00FF";
+                    default:
+                        if ((low & 0xF0) == 0xC0) return "00CN";
+                        if ((low & 0xF0) == 0xD0) return "00DN";
+                        return "0NNN";
+                }
+            case 0x5:
+                switch (low & 0xF) {
+                    case 0x0: return "5XY0";
+                    case 0x2: return "5XY2";
+                    case 0x3: return "5XY3";
+                    default: return "unknown";
+                }
+            case 0x8:
+                return ALU[low & 0xF];
+            case 0xE:
+                return low == 0x9E ? "EX9E" : low == 0xA1 ? "EXA1" : "unknown";
+            case 0xF:
+                switch (low) {
+                    case 0x00: return "F000";
+                    case 0x01: return "FN01";
+                    case 0x02: return "F002";
+                    case 0x07: return "FX07";
+                    case 0x0A: return "FX0A";
+                    case 0x15: return "FX15";
+                    case 0x18: return "FX18";
+                    case 0x1E: return "FX1E";
+                    case 0x29: return "FX29";
+                    case 0x30: return "FX30";
+                    case 0x33: return "FX33";
+                    case 0x3A: return "FX3A";
+                    case 0x55: return "FX55";
+                    case 0x65: return "FX65";
+                    case 0x75: return "FX75";
+                    case 0x85: return "FX85";
+                    default: return "unknown";
+                }
+            default:
+                return FIXED[nibble];
+        }
+    }
+
+} // Chip8
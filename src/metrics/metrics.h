@@ -0,0 +1,91 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace Chip8 {
+
+enum class Counter : uint8_t {
+    FRAMES_EMULATED,
+    INSTRUCTIONS_EXECUTED,
+    DEADLINE_MISSES,        // frames whose work took longer than the 60 Hz period
+    AUDIO_UNDERRUNS,
+    COUNT
+};
+
+enum class Histogram : uint8_t {
+    FRAME_WORK,             // emulate + render + present, before the pacing sleep
+    SLEEP_OVERSHOOT,        // how much later than asked the pacing sleep returned
+    COUNT
+};
+
+/**
+ * Counters of one writer thread.
+ *
+ * Only the owning thread writes, so an increment is a relaxed load and store of its
+ * own cache line (a plain add on x86/ARM, no lock prefix, no contention); readers sum
+ * every shard with relaxed loads. Totals read while a frame is running may be a few
+ * increments behind, never torn.
+ */
+class alignas(64) MetricsShard {
+public:
+    // Upper bucket bounds in microseconds, the last bucket is +Inf
+    static constexpr std::array<uint32_t, 10> bucket_bounds{50, 100, 250, 500, 1000, 2000, 4000, 8000, 16667, 33333};
+    static constexpr std::size_t bucket_count = bucket_bounds.size() + 1;
+
+    void add(Counter counter, uint64_t amount = 1) {
+        bump(counters_[static_cast<std::size_t>(counter)], amount);
+    }
+    void observe(Histogram histogram, std::chrono::microseconds value);
+
+    std::atomic<uint64_t>* enable_opcode_counts();  // Chip::opcode_slots counters, see Chip::opcode_counts
+
+private:
+    friend class Metrics;
+
+    struct HistogramData {
+        std::array<std::atomic<uint64_t>, bucket_count> buckets{};
+        std::atomic<uint64_t> sum_us{0};
+    };
+
+    static void bump(std::atomic<uint64_t>& value, uint64_t amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, static_cast<std::size_t>(Counter::COUNT)> counters_{};
+    std::array<HistogramData, static_cast<std::size_t>(Histogram::COUNT)> histograms_{};
+    std::unique_ptr<std::atomic<uint64_t>[]> opcodes_;     // nullptr until enabled (32 KB)
+};
+
+/**
+ * Process-wide metrics, aggregated from per-thread shards when read.
+ *
+ * Every thread that records asks for its own shard once (make_shard) and writes to it
+ * without synchronization; the mutex only guards the list of shards, so reading never
+ * blocks a writer. Shards live as long as the Metrics object.
+ */
+class Metrics {
+public:
+    MetricsShard& make_shard();
+
+    uint64_t total(Counter counter) const;
+    std::string prometheus_text() const;   // text exposition format 0.0.4
+
+    static std::string_view opcode_pattern(std::size_t slot);     // "DXYN", "FX1E", ...
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<MetricsShard> shards_;       // deque: shards never move once handed out
+};
+
+} // Chip8
+
+#endif //METRICS_H
@@ -0,0 +1,213 @@
+#include "metrics_exporter.h"
+
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#define CHIP8_METRICS_HTTP 1
+#endif
+
+#include "../log/log.h"
+
+namespace Chip8 {
+    namespace {
+        constexpr std::size_t MAX_REQUEST = 4096;
+    }
+
+    /**
+     * @brief Starts exporting.
+     *
+     * @param endpoint "<port>" or "tcp:<port>" for HTTP on 127.0.0.1, "file:<path>" for a file.
+     * @param interval How often the file is rewritten (file mode only).
+     * @throws std::runtime_error if the endpoint is malformed or the port cannot be bound.
+     */
+    MetricsExporter::MetricsExporter(const Metrics& metrics, const std::string& endpoint, std::chrono::seconds interval) :
+    metrics_(metrics),
+    interval_(interval)
+    {
+        if (endpoint.rfind("file:", 0) == 0) {
+            file_path_ = endpoint.substr(5);
+            if (file_path_.empty())
+                throw std::runtime_error("metrics file path is empty");
+            if (interval_.count() < 1)
+                throw std::runtime_error("metrics interval must be at least 1 second");
+            write_file();   // fail early on an unwritable path
+            worker_ = std::thread(&MetricsExporter::file_loop, this);
+            LOG_INFO(NET, "writing metrics to {} every {}s", file_path_, interval_.count());
+            return;
+        }
+
+        const std::string port_text = endpoint.rfind("tcp:", 0) == 0 ? endpoint.substr(4) : endpoint;
+        int port = 0;
+        try {
+            port = std::stoi(port_text);
+        }
+        catch (const std::exception&) {
+            port = 0;
+        }
+        if (port < 1 || port > 65535)
+            throw std::runtime_error("metrics endpoint must be <port>, tcp:<port> or file:<path>");
+
+#ifdef CHIP8_METRICS_HTTP
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // local scrapers only
+        int reuse = 1;
+        listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd_ >= 0)
+            setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (listen_fd_ < 0 || bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || listen(listen_fd_, 8) != 0 || pipe(wake_fds_) != 0) {
+            const std::string reason = std::strerror(errno);
+            if (listen_fd_ >= 0) close(listen_fd_);
+            throw std::runtime_error(std::format("cannot serve metrics on port {}: {}", port, reason));
+        }
+        fcntl(listen_fd_, F_SETFD, FD_CLOEXEC);
+
+        worker_ = std::thread(&MetricsExporter::http_loop, this);
+        LOG_INFO(NET, "serving metrics on http://127.0.0.1:{}/metrics", port);
+#else
+        throw std::runtime_error("the metrics HTTP endpoint needs POSIX sockets, use file:<path>");
+#endif
+    }
+
+    MetricsExporter::~MetricsExporter() {
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex_);
+            stopping_ = true;
+        }
+        stop_cv_.notify_all();
+#ifdef CHIP8_METRICS_HTTP
+        if (wake_fds_[1] >= 0) {
+            char byte = 0;
+            [[maybe_unused]] ssize_t n = write(wake_fds_[1], &byte, 1);
+        }
+#endif
+        if (worker_.joinable())
+            worker_.join();
+
+#ifdef CHIP8_METRICS_HTTP
+        if (listen_fd_ >= 0) {
+            close(listen_fd_);
+            close(wake_fds_[0]);
+            close(wake_fds_[1]);
+        }
+#endif
+        if (!file_path_.empty()) {
+            try {
+                write_file();   // final totals of the run
+            }
+            catch (const std::exception& e) {
+                LOG_WARN(NET, "{}", e.what());
+            }
+        }
+    }
+
+    void MetricsExporter::file_loop() {
+        std::unique_lock<std::mutex> lock(stop_mutex_);
+        while (!stop_cv_.wait_for(lock, interval_, [this] { return stopping_; })) {
+            lock.unlock();
+            try {
+                write_file();
+            }
+            catch (const std::exception& e) {
+                LOG_WARN(NET, "{}", e.what());
+            }
+            lock.lock();
+        }
+    }
+
+    /**
+     * @brief Writes the metrics next to the target and renames it over the old file.
+     *
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void MetricsExporter::write_file() const {
+        const std::string temporary = file_path_ + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::out | std::ios::trunc);
+            out << metrics_.prometheus_text();
+            if (!out)
+                throw std::runtime_error(std::format("cannot write metrics to {}", temporary));
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, file_path_, error);
+        if (error)
+            throw std::runtime_error(std::format("cannot replace {}: {}", file_path_, error.message()));
+    }
+
+#ifdef CHIP8_METRICS_HTTP
+    void MetricsExporter::http_loop() {
+        pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {wake_fds_[0], POLLIN, 0}};
+        while (true) {
+            if (poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                LOG_ERROR(NET, "metrics poll failed: {}", std::strerror(errno));
+                return;
+            }
+            if (fds[1].revents)
+                return;     // shutdown
+            if (fds[0].revents & POLLIN) {
+                int client = accept(listen_fd_, nullptr, nullptr);
+                if (client < 0) continue;
+                serve_client(client);
+                close(client);
+            }
+        }
+    }
+
+    /**
+     * @brief Answers one HTTP/1.x request and closes; a slow client times out after a second.
+     */
+    void MetricsExporter::serve_client(int fd) const {
+        timeval timeout{1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        std::string request;
+        char buffer[512];
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST) {
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0) break;
+            request.append(buffer, static_cast<std::size_t>(n));
+        }
+
+        std::string status = "200 OK";
+        std::string body;
+        if (request.rfind("GET /metrics", 0) == 0 && (request.size() == 12 || request[12] == ' ' || request[12] == '?'))
+            body = metrics_.prometheus_text();
+        else {
+            status = "404 Not Found";
+            body = "metrics are served at /metrics\n";
+        }
+
+        const std::string response = std::format("HTTP/1.1 {}\r\nContent-Type: text/plain; version=0.0.4\r\n"
+            "Content-Length: {}\r\nConnection: close\r\n\r\n{}", status, body.size(), body);
+        std::size_t sent = 0;
+        while (sent < response.size()) {
+#ifdef MSG_NOSIGNAL
+            ssize_t n = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+#else
+            ssize_t n = send(fd, response.data() + sent, response.size() - sent, 0);
+#endif
+            if (n <= 0) return;
+            sent += static_cast<std::size_t>(n);
+        }
+    }
+#else
+    void MetricsExporter::http_loop() {}
+    void MetricsExporter::serve_client(int) const {}
+#endif
+
+} // Chip8
@@ -0,0 +1,54 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "metrics.h"
+
+namespace Chip8 {
+
+/**
+ * Publishes Metrics::prometheus_text from a background thread, either
+ *
+ *  - over HTTP on 127.0.0.1:<port> (any GET /metrics, one scrape at a time), or
+ *  - as a file rewritten every interval (written aside and renamed over, so a
+ *    node_exporter textfile collector never reads half a file).
+ *
+ * The emulation thread is never involved: the text is built from the shards on the
+ * exporter thread when it is requested.
+ */
+class MetricsExporter {
+public:
+    MetricsExporter(const Metrics& metrics, const std::string& endpoint, std::chrono::seconds interval);
+    ~MetricsExporter();
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    static constexpr std::chrono::seconds default_interval{10};
+
+private:
+    void file_loop();
+    void write_file() const;
+    void http_loop();
+    void serve_client(int fd) const;
+
+    const Metrics& metrics_;
+    std::string file_path_;         // file mode when not empty
+    std::chrono::seconds interval_;
+    int listen_fd_{-1};
+    int wake_fds_[2]{-1, -1};       // pipe: shutdown of the HTTP thread
+
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+    bool stopping_{false};
+
+    std::thread worker_;
+};
+
+} // Chip8
+
+#endif //METRICS_EXPORTER_H
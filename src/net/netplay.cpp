@@ -0,0 +1,463 @@
+#include "netplay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define CHIP8_NETPLAY_UDP 1
+#endif
+
+#include "../hardware/state_hash.h"
+#include "../log/log.h"
+
+namespace Chip8 {
+    namespace {
+        constexpr uint16_t MAGIC = 0xC8A7;
+        constexpr uint32_t NO_HASH = UINT32_MAX;
+        constexpr std::size_t MAX_PACKET = 512;
+        constexpr std::chrono::milliseconds HELLO_INTERVAL{100};
+        constexpr uint32_t SYNC_COOLDOWN = 10;     // frames between two time-sync stalls
+
+        enum PacketType : uint8_t { HELLO = 1, INPUT = 2, BYE = 3 };
+
+        void put_u8(std::vector<uint8_t>& out, uint8_t value) {
+            out.push_back(value);
+        }
+
+        void put_u16(std::vector<uint8_t>& out, uint16_t value) {
+            out.push_back(static_cast<uint8_t>(value));
+            out.push_back(static_cast<uint8_t>(value >> 8));
+        }
+
+        void put_u32(std::vector<uint8_t>& out, uint32_t value) {
+            put_u16(out, static_cast<uint16_t>(value));
+            put_u16(out, static_cast<uint16_t>(value >> 16));
+        }
+
+        void put_u64(std::vector<uint8_t>& out, uint64_t value) {
+            put_u32(out, static_cast<uint32_t>(value));
+            put_u32(out, static_cast<uint32_t>(value >> 32));
+        }
+
+        uint16_t get_u16(const uint8_t* in) {
+            return static_cast<uint16_t>(in[0] | in[1] << 8);
+        }
+
+        uint32_t get_u32(const uint8_t* in) {
+            return get_u16(in) | static_cast<uint32_t>(get_u16(in + 2)) << 16;
+        }
+
+        uint64_t get_u64(const uint8_t* in) {
+            return get_u32(in) | static_cast<uint64_t>(get_u32(in + 4)) << 32;
+        }
+
+        std::vector<uint8_t> header(PacketType type) {
+            std::vector<uint8_t> out;
+            out.reserve(MAX_PACKET);
+            put_u16(out, MAGIC);
+            put_u8(out, type);
+            return out;
+        }
+    }
+
+    /**
+     * @brief Binds the local port; nothing is sent before the first send().
+     *
+     * @param sync_value Must equal the peer's, see Netplay::sync_value.
+     * @throws std::runtime_error if the options are out of range, the peer cannot be
+     * resolved or the port cannot be bound.
+     */
+    Netplay::Netplay(const NetplayOptions& options, uint64_t sync_value) :
+    options_(options),
+    sync_(sync_value),
+    started_(Clock::now())
+    {
+        if (options_.input_delay > max_input_delay)
+            throw std::runtime_error(std::format("netplay input delay must be between 0 and {} frames", max_input_delay));
+        if (options_.loss_percent > 100)
+            throw std::runtime_error("netplay packet loss must be between 0 and 100 percent");
+
+        // the first input_delay frames run without local keys
+        local_count_ = options_.input_delay;
+
+#ifdef CHIP8_NETPLAY_UDP
+        addrinfo hints{};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* peer = nullptr;
+        const std::string service = std::to_string(options_.peer_port);
+        if (int status = getaddrinfo(options_.peer_host.c_str(), service.c_str(), &hints, &peer); status != 0)
+            throw std::runtime_error(std::format("cannot resolve netplay peer {}: {}", options_.peer_host, gai_strerror(status)));
+        peer_address_.assign(reinterpret_cast<const uint8_t*>(peer->ai_addr),
+            reinterpret_cast<const uint8_t*>(peer->ai_addr) + peer->ai_addrlen);
+        freeaddrinfo(peer);
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(options_.local_port);
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        socket_fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        if (socket_fd_ < 0 || bind(socket_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            const std::string reason = std::strerror(errno);
+            if (socket_fd_ >= 0) close(socket_fd_);
+            throw std::runtime_error(std::format("cannot bind netplay port {}: {}", options_.local_port, reason));
+        }
+        fcntl(socket_fd_, F_SETFL, fcntl(socket_fd_, F_GETFL) | O_NONBLOCK);
+        fcntl(socket_fd_, F_SETFD, FD_CLOEXEC);
+
+        LOG_INFO(NET, "netplay on port {}, waiting for {}:{}", options_.local_port, options_.peer_host, options_.peer_port);
+#else
+        throw std::runtime_error("netplay needs POSIX sockets");
+#endif
+    }
+
+    /**
+     * @brief Tells the peer this player quit (past any artificial delay or loss) and closes.
+     */
+    Netplay::~Netplay() {
+        if (socket_fd_ < 0)
+            return;
+        if (connected_ && !peer_left_) {
+            const std::vector<uint8_t> bye = header(BYE);
+            send_now(bye);
+            send_now(bye);
+        }
+#ifdef CHIP8_NETPLAY_UDP
+        close(socket_fd_);
+#endif
+    }
+
+    /**
+     * @brief Mixes everything both machines must agree on into the value exchanged in HELLO.
+     *
+     * @param state_hash Chip::state_hash right after the ROM was loaded (ROM, fonts, seed).
+     */
+    uint64_t Netplay::sync_value(uint64_t state_hash, unsigned ipf, QuirkProfile quirks) {
+        return StateHash::mix(state_hash ^ StateHash::mix(static_cast<uint64_t>(ipf) << 8 | static_cast<uint8_t>(quirks)));
+    }
+
+    /**
+     * @brief Takes every packet that arrived since the last call; start of a host frame.
+     */
+    void Netplay::receive() {
+        flush_delayed();
+#ifdef CHIP8_NETPLAY_UDP
+        uint8_t buffer[MAX_PACKET];
+        while (true) {
+            sockaddr_in from{};
+            socklen_t from_size = sizeof(from);
+            ssize_t n = recvfrom(socket_fd_, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&from), &from_size);
+            if (n < 0)
+                break;      // EAGAIN: drained
+            const sockaddr_in& peer = *reinterpret_cast<const sockaddr_in*>(peer_address_.data());
+            if (from.sin_port != peer.sin_port || from.sin_addr.s_addr != peer.sin_addr.s_addr)
+                continue;   // not our peer
+            handle_packet(buffer, static_cast<std::size_t>(n));
+        }
+#endif
+        if (connected_ && !peer_left_ && Clock::now() - last_heard_ > peer_timeout) {
+            peer_left_ = true;
+            LOG_WARN(NET, "netplay peer stopped responding");
+        }
+    }
+
+    /**
+     * @brief Sends this frame's packet; end of a host frame, after any rollback.
+     */
+    void Netplay::send() {
+        flush_delayed();
+        if (finished())
+            return;
+        if (!connected_) {
+            if (Clock::now() - last_hello_ >= HELLO_INTERVAL) {
+                send_hello(false);
+                last_hello_ = Clock::now();
+            }
+            return;
+        }
+
+        compare_hashes();
+
+        // newest state hash that no rollback can change anymore
+        const HashSlot* final_hash = nullptr;
+        for (const HashSlot& slot : hashes_) {
+            if (slot.has_local && slot.frame < remote_count_ && (!final_hash || slot.frame > final_hash->frame))
+                final_hash = &slot;
+        }
+
+        const uint32_t first = std::max<uint32_t>(peer_ack_, local_count_ > max_masks_per_packet ? local_count_ - max_masks_per_packet : 0);
+        std::vector<uint8_t> packet = header(INPUT);
+        put_u32(packet, frame_);
+        put_u8(packet, static_cast<uint8_t>(static_cast<int8_t>(std::clamp(advantage(), -128, 127))));
+        put_u32(packet, millis());
+        put_u32(packet, peer_ping_);
+        put_u32(packet, remote_count_);
+        put_u32(packet, first);
+        put_u8(packet, static_cast<uint8_t>(local_count_ - first));
+        for (uint32_t frame = first; frame < local_count_; frame++) {
+            put_u16(packet, local_[frame % history]);
+        }
+        put_u32(packet, final_hash ? final_hash->frame : NO_HASH);
+        put_u64(packet, final_hash ? final_hash->local : 0);
+        send_packet(std::move(packet));
+    }
+
+    /**
+     * @brief First frame that ran with a remote prediction that turned out wrong, if any.
+     *
+     * The caller restores the state from before that frame and runs it and every frame
+     * up to frame() again, calling input() for each.
+     */
+    std::optional<uint32_t> Netplay::take_rollback() {
+        std::optional<uint32_t> from = rollback_;
+        rollback_.reset();
+        if (from) {
+            stats_.rollbacks++;
+            stats_.resimulated_frames += frame_ - *from;
+            stats_.max_rollback_depth = std::max(stats_.max_rollback_depth, frame_ - *from);
+        }
+        return from;
+    }
+
+    /**
+     * @brief Whether the next frame may run now: connected, within max_rollback of the
+     * remote keys, and not so far ahead of the peer that it should wait a frame.
+     */
+    bool Netplay::can_advance() {
+        if (!connected_ || finished())
+            return false;
+        if (frame_ >= remote_count_ + max_rollback) {
+            stats_.input_stalls++;
+            return false;
+        }
+        if (sync_cooldown_ > 0) {
+            sync_cooldown_--;
+            return true;
+        }
+        // both sides estimate how far ahead they are; half the difference is this side's lead
+        if ((advantage() - peer_advantage_) / 2 >= 1) {
+            sync_cooldown_ = SYNC_COOLDOWN;
+            stats_.sync_stalls++;
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief The local keys sampled for this frame; they count input_delay frames later.
+     * Once per frame that advances.
+     */
+    void Netplay::set_local_input(uint16_t keys) {
+        local_[local_count_ % history] = keys;
+        local_count_++;
+    }
+
+    /**
+     * @brief Keys the machine sees in frame: local OR remote, the remote part predicted
+     * (the last mask received) if it has not arrived yet.
+     */
+    uint16_t Netplay::input(uint32_t frame) {
+        uint16_t remote = 0;
+        if (frame < remote_count_)
+            remote = remote_[frame % history];
+        else if (remote_count_ > 0)
+            remote = remote_[(remote_count_ - 1) % history];
+        used_remote_[frame % history] = remote;
+        return local_[frame % history] | remote;
+    }
+
+    void Netplay::advance() {
+        frame_++;
+        stats_.frames++;
+    }
+
+    /**
+     * @brief State hash after frame ran; only every hash_interval-th frame is kept.
+     * Frames run again after a rollback simply record again.
+     */
+    void Netplay::record_hash(uint32_t frame, uint64_t hash) {
+        if (frame % hash_interval != 0)
+            return;
+        HashSlot& slot = hashes_[frame / hash_interval % hash_slots];
+        if (slot.frame != frame)
+            slot = HashSlot{frame};
+        slot.local = hash;
+        slot.has_local = true;
+    }
+
+    std::string Netplay::summary() const {
+        std::string sync = stats_.desync_frame ? std::format("DESYNC at frame {}", *stats_.desync_frame)
+            : std::format("in sync ({} checks)", stats_.hash_checks);
+        return std::format(">>> Netplay: {} frames, {} rollbacks ({} frames run again, deepest {}), {} input stalls, {} sync stalls\n"
+            ">>> Netplay: {} packets sent ({} dropped on purpose), rtt {} ms, {}\n",
+            stats_.frames, stats_.rollbacks, stats_.resimulated_frames, stats_.max_rollback_depth,
+            stats_.input_stalls, stats_.sync_stalls, stats_.packets_sent, stats_.packets_dropped,
+            stats_.rtt.count(), sync);
+    }
+
+    /**
+     * @brief Sends through the artificial loss and delay of the options.
+     */
+    void Netplay::send_packet(std::vector<uint8_t> bytes) {
+        stats_.packets_sent++;
+        if (options_.loss_percent > 0 && loss_rng_() % 100 < options_.loss_percent) {
+            stats_.packets_dropped++;
+            return;
+        }
+        if (options_.added_delay.count() > 0) {
+            delayed_.push_back(Delayed{Clock::now() + options_.added_delay, std::move(bytes)});
+            return;
+        }
+        send_now(bytes);
+    }
+
+    void Netplay::send_now(const std::vector<uint8_t>& bytes) {
+#ifdef CHIP8_NETPLAY_UDP
+        // lost like any datagram if the peer is not up yet; HELLO and INPUT are repeated
+        sendto(socket_fd_, bytes.data(), bytes.size(), 0,
+            reinterpret_cast<const sockaddr*>(peer_address_.data()), static_cast<socklen_t>(peer_address_.size()));
+#endif
+    }
+
+    /**
+     * @param answer Reply to the peer's HELLO; answers are not answered again.
+     */
+    void Netplay::send_hello(bool answer) {
+        std::vector<uint8_t> packet = header(HELLO);
+        put_u64(packet, sync_);
+        put_u8(packet, answer ? 1 : 0);
+        send_packet(std::move(packet));
+    }
+
+    void Netplay::flush_delayed() {
+        const Clock::time_point now = Clock::now();
+        while (!delayed_.empty() && delayed_.front().due <= now) {
+            send_now(delayed_.front().bytes);
+            delayed_.pop_front();
+        }
+    }
+
+    void Netplay::handle_packet(const uint8_t* data, std::size_t size) {
+        if (size < 3 || get_u16(data) != MAGIC || !error_.empty())
+            return;
+
+        switch (data[2]) {
+            case HELLO:
+                if (size < 12)
+                    return;
+                if (get_u64(data + 3) != sync_) {
+                    error_ = "the netplay peer runs another ROM, seed, IPF or quirk profile";
+                    LOG_ERROR(NET, "{}", error_);
+                    if (data[11] == 0)
+                        send_hello(true);   // so the peer finds out too
+                    return;
+                }
+                if (!connected_) {
+                    connected_ = true;
+                    LOG_INFO(NET, "netplay peer connected");
+                }
+                last_heard_ = Clock::now();
+                if (data[11] == 0)
+                    send_hello(true);
+                break;
+            case INPUT:
+                // the peer only sends input after it checked our HELLO
+                if (!connected_) {
+                    connected_ = true;
+                    LOG_INFO(NET, "netplay peer connected");
+                }
+                last_heard_ = Clock::now();
+                handle_input(data + 3, size - 3);
+                break;
+            case BYE:
+                if (!peer_left_)
+                    LOG_INFO(NET, "netplay peer quit");
+                peer_left_ = true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    void Netplay::handle_input(const uint8_t* data, std::size_t size) {
+        constexpr std::size_t fixed = 4 + 1 + 4 + 4 + 4 + 4 + 1;
+        if (size < fixed)
+            return;
+        const std::size_t count = data[fixed - 1];
+        if (size < fixed + count * 2 + 12)
+            return;
+
+        peer_frame_ = get_u32(data);
+        peer_advantage_ = static_cast<int8_t>(data[4]);
+        peer_ping_ = get_u32(data + 5);
+        if (uint32_t pong = get_u32(data + 9); pong != 0)
+            stats_.rtt = std::chrono::milliseconds{millis() - pong};
+        peer_ack_ = std::max(peer_ack_, std::min(get_u32(data + 13), local_count_));
+
+        // masks start at what we acknowledged, so they never leave a gap
+        const uint32_t first = get_u32(data + 17);
+        const uint8_t* masks = data + fixed;
+        for (std::size_t i = 0; i < count && first <= remote_count_; i++) {
+            const uint32_t frame = first + static_cast<uint32_t>(i);
+            if (frame < remote_count_)
+                continue;
+            const uint16_t mask = get_u16(masks + i * 2);
+            remote_[frame % history] = mask;
+            if (frame < frame_ && used_remote_[frame % history] != mask && (!rollback_ || frame < *rollback_))
+                rollback_ = frame;      // ran on a wrong prediction
+            remote_count_++;
+        }
+
+        const uint8_t* hash = masks + count * 2;
+        const uint32_t hash_frame = get_u32(hash);
+        if (hash_frame != NO_HASH && hash_frame % hash_interval == 0) {
+            HashSlot& slot = hashes_[hash_frame / hash_interval % hash_slots];
+            if (slot.frame != hash_frame) {
+                if (slot.frame != UINT32_MAX && slot.frame > hash_frame)
+                    return;     // long gone here
+                slot = HashSlot{hash_frame};
+            }
+            slot.remote = get_u64(hash + 4);
+            slot.has_remote = true;
+        }
+    }
+
+    /**
+     * @brief Compares the state hashes both sides have final values for.
+     */
+    void Netplay::compare_hashes() {
+        for (HashSlot& slot : hashes_) {
+            if (slot.checked || !slot.has_local || !slot.has_remote || slot.frame >= remote_count_)
+                continue;
+            slot.checked = true;
+            stats_.hash_checks++;
+            if (slot.local != slot.remote && !stats_.desync_frame) {
+                stats_.desync_frame = slot.frame;
+                LOG_ERROR(NET, "netplay desync: the machines differ after frame {}", slot.frame);
+            }
+        }
+    }
+
+    /**
+     * @brief Frames this side is ahead of the peer, counting the half round trip the
+     * peer's last frame number took to get here.
+     */
+    int Netplay::advantage() const {
+        const int64_t in_flight = stats_.rtt.count() * 60 / 2000;
+        return static_cast<int>(static_cast<int64_t>(frame_) - (static_cast<int64_t>(peer_frame_) + in_flight));
+    }
+
+    uint32_t Netplay::millis() const {
+        // never 0, which means no ping to answer
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - started_).count()) + 1;
+    }
+
+} // Chip8
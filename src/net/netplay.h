@@ -0,0 +1,169 @@
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../hardware/quirks.h"
+
+namespace Chip8 {
+
+struct NetplayOptions {
+    uint16_t local_port = 0;
+    std::string peer_host;
+    uint16_t peer_port = 0;
+    unsigned input_delay = 1;                       // frames local keys are held back before they count
+    std::chrono::milliseconds added_delay{0};       // testing: every packet sent is held this long
+    unsigned loss_percent = 0;                      // testing: share of packets sent that are dropped
+};
+
+/**
+ * Two-player rollback netplay over UDP.
+ *
+ * Both machines run the same ROM from the same state and feed every frame the OR of
+ * both players' 16-bit key masks, so they stay identical as long as the inputs do. The
+ * local mask of frame f is only known here, the remote one travels over the network:
+ *
+ *  - Local keys count input_delay frames late, which gives them that long to arrive.
+ *  - A frame whose remote keys have not arrived runs with a prediction (the last mask
+ *    received). When the real mask turns out different, take_rollback reports the
+ *    first wrong frame and the Platform restores its snapshot and runs the frames up to
+ *    now again, all within one host frame.
+ *  - The game stalls instead of predicting more than max_rollback frames ahead, and
+ *    the side that is ahead of the other drops a frame now and then to keep both
+ *    sides' predictions short.
+ *
+ * Every packet carries all local masks the peer has not acknowledged yet, so a lost
+ * packet is repaired by the next one. The state hash of every hash_interval-th frame is
+ * exchanged once both inputs of it are known, and a mismatch is reported as a desync.
+ *
+ * Packets are [magic u16][type u8][payload], little endian:
+ *
+ *  - HELLO [sync u64]: until the peer answers; both sides must agree on sync (ROM,
+ *    seed, IPF and quirks)
+ *  - INPUT [frame u32][advantage i8][ping u32][pong u32][ack u32][first u32][count u8]
+ *    [count x mask u16][hash frame u32][hash u64]
+ *  - BYE when a player quits
+ *
+ * Single-threaded: the emulation thread calls receive and send once per host frame.
+ */
+class Netplay {
+public:
+    static constexpr unsigned max_rollback = 8;            // frames run on a prediction before stalling
+    static constexpr unsigned max_input_delay = 8;
+    static constexpr uint32_t hash_interval = 30;           // frames between desync checks
+    static constexpr std::chrono::seconds peer_timeout{5};
+
+    struct Stats {
+        uint32_t frames = 0;
+        uint32_t rollbacks = 0;
+        uint32_t resimulated_frames = 0;
+        uint32_t max_rollback_depth = 0;
+        uint32_t input_stalls = 0;          // waited for remote keys (max_rollback reached)
+        uint32_t sync_stalls = 0;           // waited for the peer to catch up
+        uint32_t packets_sent = 0;
+        uint32_t packets_dropped = 0;       // by loss_percent
+        uint32_t hash_checks = 0;
+        std::optional<uint32_t> desync_frame;
+        std::chrono::milliseconds rtt{0};
+    };
+
+    Netplay(const NetplayOptions& options, uint64_t sync_value);
+    ~Netplay();
+    Netplay(const Netplay&) = delete;
+    Netplay& operator=(const Netplay&) = delete;
+
+    static uint64_t sync_value(uint64_t state_hash, unsigned ipf, QuirkProfile quirks);
+
+    void receive();
+    void send();
+
+    bool connected() const { return connected_; }
+    bool finished() const { return !error_.empty() || peer_left_; }
+    const std::string& error() const { return error_; }     // set when the peer is incompatible
+
+    uint32_t frame() const { return frame_; }               // next frame to run
+    std::optional<uint32_t> take_rollback();
+    bool can_advance();
+    void set_local_input(uint16_t keys);
+    uint16_t input(uint32_t frame);
+    void advance();
+    void record_hash(uint32_t frame, uint64_t hash);
+
+    const Stats& stats() const { return stats_; }
+    std::string summary() const;
+
+private:
+    static constexpr std::size_t history = 128;             // frames of input kept on each side
+    static constexpr std::size_t max_masks_per_packet = 64;
+    static constexpr std::size_t hash_slots = 16;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct HashSlot {
+        uint32_t frame = UINT32_MAX;
+        uint64_t local = 0;
+        uint64_t remote = 0;
+        bool has_local = false;
+        bool has_remote = false;
+        bool checked = false;
+    };
+
+    struct Delayed {
+        Clock::time_point due;
+        std::vector<uint8_t> bytes;
+    };
+
+    void send_packet(std::vector<uint8_t> bytes);
+    void send_now(const std::vector<uint8_t>& bytes);
+    void send_hello(bool answer);
+    void flush_delayed();
+    void handle_packet(const uint8_t* data, std::size_t size);
+    void handle_input(const uint8_t* data, std::size_t size);
+    void compare_hashes();
+    int advantage() const;
+    uint32_t millis() const;
+
+    const NetplayOptions options_;
+    const uint64_t sync_;
+    int socket_fd_{-1};
+    std::vector<uint8_t> peer_address_;                     // sockaddr of the peer
+    Clock::time_point started_;
+
+    bool connected_{false};
+    bool peer_left_{false};
+    std::string error_;
+    Clock::time_point last_heard_;
+    Clock::time_point last_hello_;
+
+    uint32_t frame_{0};
+    std::array<uint16_t, history> local_{};
+    uint32_t local_count_{0};                               // local masks known, frames [0, local_count_)
+    std::array<uint16_t, history> remote_{};
+    uint32_t remote_count_{0};                              // remote masks received, without gaps
+    std::array<uint16_t, history> used_remote_{};           // remote mask each frame last ran with
+    std::optional<uint32_t> rollback_;                      // first frame that ran with a wrong prediction
+    uint32_t peer_ack_{0};                                  // local masks the peer has
+
+    uint32_t peer_frame_{0};
+    int8_t peer_advantage_{0};
+    uint32_t peer_ping_{0};                                 // echoed back for the round trip time
+    uint32_t sync_cooldown_{0};
+
+    std::array<HashSlot, hash_slots> hashes_{};             // by frame / hash_interval
+
+    std::mt19937 loss_rng_{std::random_device{}()};
+    std::deque<Delayed> delayed_;
+
+    Stats stats_;
+};
+
+} // Chip8
+
+#endif //NETPLAY_H
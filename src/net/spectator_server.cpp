@@ -0,0 +1,427 @@
+#include "spectator_server.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define CHIP8_SPECTATOR_EPOLL 1
+#endif
+
+#include "../log/log.h"
+
+namespace Chip8 {
+    namespace {
+        constexpr uint32_t KEYS_PENDING = 1u << 16;
+        constexpr int MAX_EVENTS = 32;
+
+        void put_u16(uint8_t* out, uint16_t value) {
+            out[0] = static_cast<uint8_t>(value);
+            out[1] = static_cast<uint8_t>(value >> 8);
+        }
+
+        void put_u32(uint8_t* out, uint32_t value) {
+            put_u16(out, static_cast<uint16_t>(value));
+            put_u16(out + 2, static_cast<uint16_t>(value >> 16));
+        }
+    }
+
+    /**
+     * @brief Packs the framebuffer row-major, 4 pixels per byte, first pixel in bits 7-6.
+     */
+    void SpectatorServer::pack(const Chip::Gfx& gfx, PackedFrame& out) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x += 4) {
+                out[(y * width + x) / 4] = static_cast<uint8_t>(
+                    (gfx[x][y] & 0x3u) << 6 | (gfx[x + 1][y] & 0x3u) << 4 |
+                    (gfx[x + 2][y] & 0x3u) << 2 | (gfx[x + 3][y] & 0x3u));
+            }
+        }
+    }
+
+    /**
+     * @brief Run-length codes the XOR of two packed frames as [skip][count][bytes] tokens.
+     *
+     * Skips and literal runs longer than 255 bytes are split into several tokens.
+     *
+     * @param payload Replaced with the encoded delta (empty if the frames are equal).
+     */
+    void SpectatorServer::encode_delta(const PackedFrame& from, const PackedFrame& to, std::vector<uint8_t>& payload) {
+        payload.clear();
+        std::size_t i = 0;
+        while (true) {
+            std::size_t skip = 0;
+            while (i < packed_size && from[i] == to[i]) {
+                i++;
+                skip++;
+            }
+            if (i == packed_size)
+                return;     // trailing unchanged bytes need no token
+
+            while (skip > 255) {
+                payload.insert(payload.end(), {255, 0});
+                skip -= 255;
+            }
+
+            std::size_t start = i;
+            while (i < packed_size && from[i] != to[i] && i - start < 255) {
+                i++;
+            }
+            payload.push_back(static_cast<uint8_t>(skip));
+            payload.push_back(static_cast<uint8_t>(i - start));
+            for (std::size_t k = start; k < i; k++) {
+                payload.push_back(from[k] ^ to[k]);
+            }
+        }
+    }
+
+#ifdef CHIP8_SPECTATOR_EPOLL
+    /**
+     * @brief Opens the listening socket and starts the server thread.
+     *
+     * @param endpoint     "<port>" or "tcp:<port>" for 127.0.0.1, "unix:<path>" for a Unix socket.
+     * @param accept_input Let one viewer drive the keypad.
+     * @throws std::runtime_error if the endpoint is malformed or cannot be bound.
+     */
+    SpectatorServer::SpectatorServer(const std::string& endpoint, bool accept_input) : accept_input_(accept_input) {
+        if (endpoint.rfind("unix:", 0) == 0) {
+            unix_path_ = endpoint.substr(5);
+            sockaddr_un address{};
+            if (unix_path_.empty() || unix_path_.size() >= sizeof(address.sun_path))
+                throw std::runtime_error("spectator socket path is empty or too long");
+
+            struct stat existing{};
+            if (stat(unix_path_.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode))
+                unlink(unix_path_.c_str());     // left behind by an earlier run
+
+            address.sun_family = AF_UNIX;
+            std::memcpy(address.sun_path, unix_path_.c_str(), unix_path_.size());
+            listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (listen_fd_ < 0 || bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                if (listen_fd_ >= 0) close(listen_fd_);
+                throw std::runtime_error(std::format("cannot bind spectator socket {}: {}", unix_path_, std::strerror(errno)));
+            }
+        }
+        else {
+            const std::string port_text = endpoint.rfind("tcp:", 0) == 0 ? endpoint.substr(4) : endpoint;
+            int port = 0;
+            try {
+                port = std::stoi(port_text);
+            }
+            catch (const std::exception&) {
+                port = 0;
+            }
+            if (port < 1 || port > 65535)
+                throw std::runtime_error("spectator endpoint must be <port>, tcp:<port> or unix:<path>");
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(port));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);   // local viewers only
+            int reuse = 1;
+            listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (listen_fd_ >= 0)
+                setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if (listen_fd_ < 0 || bind(listen_fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                if (listen_fd_ >= 0) close(listen_fd_);
+                throw std::runtime_error(std::format("cannot bind spectator port {}: {}", port, std::strerror(errno)));
+            }
+        }
+
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (listen(listen_fd_, 16) != 0 || epoll_fd_ < 0 || wake_fd_ < 0) {
+            if (epoll_fd_ >= 0) close(epoll_fd_);
+            if (wake_fd_ >= 0) close(wake_fd_);
+            close(listen_fd_);
+            throw std::runtime_error(std::format("cannot start spectator server: {}", std::strerror(errno)));
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = listen_fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &event);
+        event.data.fd = wake_fd_;
+        epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &event);
+
+        worker_ = std::thread(&SpectatorServer::worker_loop, this);
+        LOG_INFO(NET, "serving spectators on {}", unix_path_.empty() ? "127.0.0.1:" + endpoint.substr(endpoint.find(':') + 1) : unix_path_);
+    }
+
+    SpectatorServer::~SpectatorServer() {
+        stopping_.store(true, std::memory_order_release);
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = write(wake_fd_, &one, sizeof(one));
+        if (worker_.joinable())
+            worker_.join();
+
+        for (const Viewer& viewer : viewers_) {
+            close(viewer.fd);
+        }
+        close(wake_fd_);
+        close(epoll_fd_);
+        close(listen_fd_);
+        if (!unix_path_.empty())
+            unlink(unix_path_.c_str());
+    }
+
+    /**
+     * @brief Hands the frame to the server thread if it changed since the last call.
+     *
+     * Called once per frame by the emulation thread; costs a pack and a compare, plus a
+     * short lock and an eventfd write when something changed.
+     */
+    void SpectatorServer::publish(const Chip::Gfx& gfx) {
+        frame_++;
+        PackedFrame packed;
+        pack(gfx, packed);
+        if (published_any_ && packed == published_)
+            return;
+        published_ = packed;
+        published_any_ = true;
+
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex_);
+            latest_ = packed;
+            latest_frame_ = frame_;
+        }
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t n = write(wake_fd_, &one, sizeof(one));
+    }
+
+    std::size_t SpectatorServer::viewers() const {
+        return viewer_count_.load(std::memory_order_relaxed);
+    }
+
+    void SpectatorServer::worker_loop() {
+        epoll_event events[MAX_EVENTS];
+        while (!stopping_.load(std::memory_order_acquire)) {
+            int count = epoll_wait(epoll_fd_, events, MAX_EVENTS, -1);
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                LOG_ERROR(NET, "epoll_wait failed: {}", std::strerror(errno));
+                return;
+            }
+
+            for (int e = 0; e < count; e++) {
+                const int fd = events[e].data.fd;
+                if (fd == listen_fd_) {
+                    accept_viewers();
+                    continue;
+                }
+                if (fd == wake_fd_) {
+                    uint64_t wakeups;
+                    [[maybe_unused]] ssize_t n = read(wake_fd_, &wakeups, sizeof(wakeups));
+                    if (stopping_.load(std::memory_order_acquire))
+                        return;
+                    broadcast();
+                    continue;
+                }
+
+                auto viewer = std::find_if(viewers_.begin(), viewers_.end(), [fd](const Viewer& v) { return v.fd == fd; });
+                if (viewer == viewers_.end())
+                    continue;   // dropped earlier in this batch
+                if (events[e].events & (EPOLLHUP | EPOLLERR)) {
+                    drop_viewer(fd);
+                    continue;
+                }
+                if (events[e].events & EPOLLIN) {
+                    read_viewer(*viewer);
+                    viewer = std::find_if(viewers_.begin(), viewers_.end(), [fd](const Viewer& v) { return v.fd == fd; });
+                    if (viewer == viewers_.end())
+                        continue;
+                }
+                if ((events[e].events & EPOLLOUT) && !flush_viewer(*viewer))
+                    drop_viewer(fd);
+            }
+        }
+    }
+
+    void SpectatorServer::accept_viewers() {
+        while (true) {
+            int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return;     // EAGAIN: backlog drained
+            if (viewers_.size() >= max_viewers) {
+                LOG_WARN(NET, "spectator limit of {} reached, refusing a viewer", max_viewers);
+                close(fd);
+                continue;
+            }
+
+            int no_delay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));    // fails harmlessly on Unix sockets
+
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event);
+
+            viewers_.push_back(Viewer{fd});
+            viewer_count_.store(viewers_.size(), std::memory_order_relaxed);
+            LOG_INFO(NET, "spectator connected ({} watching)", viewers_.size());
+
+            queue_message(viewers_.back(), KEYFRAME, sent_frame_, sent_.data(), sent_.size());
+            if (!flush_viewer(viewers_.back()))
+                drop_viewer(fd);
+        }
+    }
+
+    /**
+     * @brief Encodes the newest published frame against the last one sent and queues
+     * it for every viewer.
+     */
+    void SpectatorServer::broadcast() {
+        PackedFrame frame;
+        uint32_t frame_number;
+        {
+            std::lock_guard<std::mutex> lock(frame_mutex_);
+            frame = latest_;
+            frame_number = latest_frame_;
+        }
+
+        encode_delta(sent_, frame, delta_);
+        sent_ = frame;
+        sent_frame_ = frame_number;
+        if (delta_.empty())
+            return;
+
+        std::vector<int> lagging;
+        for (Viewer& viewer : viewers_) {
+            queue_message(viewer, DELTA, frame_number, delta_.data(), delta_.size());
+            if (viewer.out.size() - viewer.out_sent > max_backlog || !flush_viewer(viewer))
+                lagging.push_back(viewer.fd);
+        }
+        for (int fd : lagging) {
+            LOG_WARN(NET, "dropping a spectator that fell behind");
+            drop_viewer(fd);
+        }
+    }
+
+    /**
+     * @brief Reads key masks from a viewer; only the controller's are kept.
+     */
+    void SpectatorServer::read_viewer(Viewer& viewer) {
+        uint8_t buffer[256];
+        while (true) {
+            ssize_t n = recv(viewer.fd, buffer, sizeof(buffer), 0);
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                drop_viewer(viewer.fd);
+                return;
+            }
+            if (n < 0)
+                return;
+            if (!accept_input_)
+                continue;
+
+            if (controller_fd_ < 0) {
+                controller_fd_ = viewer.fd;
+                LOG_INFO(NET, "a spectator took control of the keypad");
+            }
+            if (viewer.fd != controller_fd_)
+                continue;
+
+            for (ssize_t i = 0; i < n; i++) {
+                if (!viewer.has_partial_input) {
+                    viewer.partial_input[0] = buffer[i];
+                    viewer.has_partial_input = true;
+                    continue;
+                }
+                viewer.has_partial_input = false;
+                const uint16_t mask = static_cast<uint16_t>(viewer.partial_input[0] | buffer[i] << 8);
+                key_state_.store(mask | KEYS_PENDING, std::memory_order_release);
+            }
+        }
+    }
+
+    /**
+     * @brief Sends as much of the viewer's queue as the socket takes.
+     *
+     * @return false if the connection failed.
+     */
+    bool SpectatorServer::flush_viewer(Viewer& viewer) {
+        while (viewer.out_sent < viewer.out.size()) {
+            ssize_t n = send(viewer.fd, viewer.out.data() + viewer.out_sent,
+                             viewer.out.size() - viewer.out_sent, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+                break;
+            }
+            viewer.out_sent += static_cast<std::size_t>(n);
+        }
+
+        if (viewer.out_sent == viewer.out.size()) {
+            viewer.out.clear();
+            viewer.out_sent = 0;
+        }
+
+        // only wait for EPOLLOUT while something is stuck in the queue
+        const bool want_write = !viewer.out.empty();
+        if (want_write != viewer.want_write) {
+            epoll_event event{};
+            event.events = EPOLLIN | (want_write ? EPOLLOUT : 0u);
+            event.data.fd = viewer.fd;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, viewer.fd, &event);
+            viewer.want_write = want_write;
+        }
+        return true;
+    }
+
+    void SpectatorServer::queue_message(Viewer& viewer, MessageType type, uint32_t frame,
+                                        const uint8_t* payload, std::size_t size) {
+        uint8_t header[header_size];
+        header[0] = type;
+        put_u32(header + 1, frame);
+        put_u16(header + 5, static_cast<uint16_t>(size));
+        viewer.out.insert(viewer.out.end(), header, header + header_size);
+        viewer.out.insert(viewer.out.end(), payload, payload + size);
+    }
+
+    void SpectatorServer::drop_viewer(int fd) {
+        auto viewer = std::find_if(viewers_.begin(), viewers_.end(), [fd](const Viewer& v) { return v.fd == fd; });
+        if (viewer == viewers_.end())
+            return;
+
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        viewers_.erase(viewer);
+        viewer_count_.store(viewers_.size(), std::memory_order_relaxed);
+
+        if (fd == controller_fd_) {
+            controller_fd_ = -1;
+            key_state_.store(KEYS_PENDING, std::memory_order_release);     // release whatever it held
+            LOG_INFO(NET, "the controlling spectator left");
+        }
+        LOG_INFO(NET, "spectator disconnected ({} watching)", viewers_.size());
+    }
+#else
+    SpectatorServer::SpectatorServer(const std::string&, bool accept_input) : accept_input_(accept_input) {
+        throw std::runtime_error("the spectator server needs Linux (epoll)");
+    }
+
+    SpectatorServer::~SpectatorServer() = default;
+    void SpectatorServer::publish(const Chip::Gfx&) {}
+    std::size_t SpectatorServer::viewers() const { return 0; }
+#endif
+
+    /**
+     * @brief The controller's key mask, if it sent a new one since the last call.
+     */
+    std::optional<uint16_t> SpectatorServer::take_key_mask() {
+        uint32_t state = key_state_.fetch_and(~KEYS_PENDING, std::memory_order_acq_rel);
+        if (!(state & KEYS_PENDING))
+            return std::nullopt;
+        return static_cast<uint16_t>(state);
+    }
+
+} // Chip8
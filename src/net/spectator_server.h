@@ -0,0 +1,111 @@
+#ifndef SPECTATOR_SERVER_H
+#define SPECTATOR_SERVER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../hardware/chip.h"
+
+namespace Chip8 {
+
+/**
+ * Streams the framebuffer to local viewers over TCP (127.0.0.1) or a Unix socket.
+ *
+ * Every message is [type u8][frame u32][payload length u16][payload], little endian.
+ * Frames are packed row-major, 4 pixels per byte, first pixel in the top bits, each
+ * pixel its 2-bit plane mask (512 bytes):
+ *
+ *  - KEYFRAME carries the packed frame as is. Each viewer gets one when it connects.
+ *  - DELTA carries the XOR of the new packed frame against the previous one, as
+ *    [skip u8][count u8][count XOR bytes] tokens: skip unchanged bytes, then XOR
+ *    count bytes into the frame. Unchanged frames are not sent at all.
+ *
+ * With input enabled, the first viewer that sends something becomes the controller
+ * until it disconnects; its messages are 16-bit key masks (bit k = key k held).
+ * Everyone else's input is ignored.
+ *
+ * The emulation thread only packs and compares the frame (publish) and reads the
+ * controller's last key mask (take_key_mask). An epoll worker thread does all socket
+ * work, encodes every delta once and fans it out; viewers that fall more than
+ * max_backlog bytes behind are dropped instead of slowing anyone else down.
+ */
+class SpectatorServer {
+public:
+    static constexpr int width = 64;
+    static constexpr int height = 32;
+    static constexpr std::size_t packed_size = width * height / 4;
+    static constexpr std::size_t max_viewers = 64;
+    static constexpr std::size_t max_backlog = 64 * 1024;
+    static constexpr std::size_t header_size = 7;
+
+    enum MessageType : uint8_t { KEYFRAME = 1, DELTA = 2 };
+    using PackedFrame = std::array<uint8_t, packed_size>;
+
+    SpectatorServer(const std::string& endpoint, bool accept_input);
+    ~SpectatorServer();
+    SpectatorServer(const SpectatorServer&) = delete;
+    SpectatorServer& operator=(const SpectatorServer&) = delete;
+
+    void publish(const Chip::Gfx& gfx);
+    std::optional<uint16_t> take_key_mask();   // controller's keys, if they changed
+    std::size_t viewers() const;
+
+    static void pack(const Chip::Gfx& gfx, PackedFrame& out);
+    static void encode_delta(const PackedFrame& from, const PackedFrame& to, std::vector<uint8_t>& payload);
+
+private:
+    struct Viewer {
+        int fd{-1};
+        std::vector<uint8_t> out{};   // bytes not yet accepted by the socket
+        std::size_t out_sent{0};
+        bool want_write{false};
+        uint8_t partial_input[2]{};
+        bool has_partial_input{false};
+    };
+
+    void worker_loop();
+    void accept_viewers();
+    void broadcast();
+    void read_viewer(Viewer& viewer);
+    bool flush_viewer(Viewer& viewer);
+    void queue_message(Viewer& viewer, MessageType type, uint32_t frame, const uint8_t* payload, std::size_t size);
+    void drop_viewer(int fd);
+
+    std::string unix_path_;     // removed again on shutdown
+    bool accept_input_;
+    int listen_fd_{-1};
+    int epoll_fd_{-1};
+    int wake_fd_{-1};           // eventfd: new frame or shutdown
+
+    // emulation thread only
+    PackedFrame published_{};
+    uint32_t frame_{0};
+    bool published_any_{false};
+
+    // shared with the worker
+    mutable std::mutex frame_mutex_;
+    PackedFrame latest_{};
+    uint32_t latest_frame_{0};
+    std::atomic<bool> stopping_{false};
+    std::atomic<uint32_t> key_state_{0};      // mask | (1 << 16) when not yet taken
+    std::atomic<std::size_t> viewer_count_{0};
+
+    // worker only
+    std::vector<Viewer> viewers_;
+    int controller_fd_{-1};
+    PackedFrame sent_{};
+    uint32_t sent_frame_{0};
+    std::vector<uint8_t> delta_;
+
+    std::thread worker_;
+};
+
+} // Chip8
+
+#endif //SPECTATOR_SERVER_H
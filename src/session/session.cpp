@@ -0,0 +1,117 @@
+#include "session.h"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#include "../aot/aot_runtime.h"
+#include "../database/sha1.h"
+#include "../log/log.h"
+
+namespace Chip8 {
+    /**
+     * @brief Prepares a session on an already running Chip and Platform.
+     *
+     * The ROM database is loaded once here, not on every load.
+     *
+     * @param db_path programs.json of the ROM database (a missing file just disables lookups).
+     * @param options CLI overrides applied to every ROM.
+     */
+    Session::Session(std::shared_ptr<Chip> chip, Platform& platform, const std::string& db_path, SessionOptions options) :
+    chip_(std::move(chip)),
+    platform_(platform),
+    database_(db_path),
+    options_(std::move(options))
+    {
+        database_loaded_ = database_.load();
+    }
+
+    /**
+     * @brief IPF controller for a resolved IPF: IPS target, adaptive range or fixed.
+     */
+    IpfController Session::make_ipf_controller(int ipf, const SessionOptions& options) {
+        if (options.target_ips)
+            return IpfController::ips(*options.target_ips, 60);
+        if (options.ipf_range)
+            return IpfController::adaptive(ipf, options.ipf_range->first, options.ipf_range->second);
+        return IpfController::fixed(ipf);
+    }
+
+    /**
+     * @brief Reads a ROM file and switches the machine to it.
+     *
+     * @throws std::runtime_error if the file cannot be read or does not fit in memory.
+     */
+    LoadedRom Session::load(const std::string& path) {
+        std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+            throw std::runtime_error(std::format("{} could not be opened", path));
+
+        std::streamoff size = file.tellg();
+        if (size < 0 || static_cast<std::size_t>(size) > Chip::max_rom_size)
+            throw std::runtime_error(std::format("{} does not fit in XO-CHIP memory", path));
+
+        std::vector<uint8_t> rom(static_cast<std::size_t>(size));
+        file.seekg(0, std::ios::beg);
+        if (!file.read(reinterpret_cast<char*>(rom.data()), size))
+            throw std::runtime_error(std::format("{} could not be read", path));
+        return load(rom, path);
+    }
+
+    /**
+     * @brief Switches the machine to a ROM image, keeping every host resource open.
+     *
+     * Settings are resolved like at startup: the ROM database first, CLI options on top.
+     * The platform drops the previous ROM's key bindings, recompiled code and sound, the
+     * Chip is reset in place, and recompiled code is attached again if it is for this ROM.
+     *
+     * @param rom  ROM bytes.
+     * @param path Shown in messages only.
+     * @throws std::runtime_error if the ROM does not fit in memory.
+     */
+    LoadedRom Session::load(const std::vector<uint8_t>& rom, const std::string& path) {
+        std::chrono::time_point start = std::chrono::steady_clock::now();
+        if (rom.size() > Chip::max_rom_size)
+            throw std::runtime_error(std::format("{} does not fit in XO-CHIP memory", path));
+
+        const Sha1Digest digest = sha1(rom.data(), rom.size());
+        LoadedRom loaded{path, sha1_to_hex(digest), std::nullopt, options_.default_ipf, QuirkProfile::SCHIP, false, {}};
+        if (database_loaded_)
+            loaded.settings = database_.lookup(digest);
+
+        if (loaded.settings && loaded.settings->ipf > 0)
+            loaded.ipf = std::min<int>(loaded.settings->ipf, options_.max_ipf);
+        if (loaded.settings)
+            loaded.quirks = loaded.settings->quirks;
+        if (options_.ipf)
+            loaded.ipf = *options_.ipf;
+        if (options_.quirks)
+            loaded.quirks = *options_.quirks;
+
+        platform_.reset_for_new_rom();
+        chip_->reset();
+        chip_->set_quirk_profile(loaded.quirks);
+        chip_->load_rom(rom.data(), rom.size());
+
+        platform_.set_ipf_controller(make_ipf_controller(loaded.ipf, options_));
+        if (loaded.settings)
+            platform_.add_rom_key_bindings(loaded.settings->keys);
+
+        const Aot::Program* program = Aot::compiled_program();
+        if (options_.allow_aot && program && program->rom_sha1 == loaded.sha1 && program->quirks == loaded.quirks) {
+            platform_.attach_aot(program);
+            loaded.recompiled = true;
+        }
+
+        loaded.load_time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+        LOG_INFO(PLATFORM, "loaded {} ({}, ipf {}, {}) in {:.3f} ms", path,
+            loaded.settings ? loaded.settings->title : "not in database", loaded.ipf,
+            quirk_profile_name(loaded.quirks), loaded.load_time.count() / 1000.0);
+
+        current_ = loaded;
+        return loaded;
+    }
+
+} // Chip8
@@ -0,0 +1,73 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../Platform.h"
+#include "../database/rom_database.h"
+#include "../hardware/chip.h"
+#include "../timing/ipf_controller.h"
+
+namespace Chip8 {
+
+/**
+ * Command line choices that win over the ROM database for every ROM of a session.
+ */
+struct SessionOptions {
+    int default_ipf = 10;                           // when neither the CLI nor the database sets it
+    int max_ipf = 1000;
+    std::optional<int> ipf;
+    std::optional<QuirkProfile> quirks;
+    std::optional<std::pair<int, int>> ipf_range;   // adaptive IPF bounds
+    std::optional<int> target_ips;
+    bool allow_aot = true;                          // false while tracing or debugging
+};
+
+/**
+ * What a ROM was resolved to when it was loaded.
+ */
+struct LoadedRom {
+    std::string path;
+    std::string sha1;                   // hex
+    std::optional<RomSettings> settings;
+    int ipf;
+    QuirkProfile quirks;
+    bool recompiled;                    // runs through the linked-in AOT program
+    std::chrono::microseconds load_time;
+};
+
+/**
+ * Loads ROMs into a running Chip and Platform, one after another.
+ *
+ * The window, renderer, textures and the audio device belong to the Platform and are
+ * never touched; the Chip is reset in place. Switching games is therefore a file read,
+ * a SHA-1, a database lookup and a 64 KB reset.
+ */
+class Session {
+public:
+    Session(std::shared_ptr<Chip> chip, Platform& platform, const std::string& db_path, SessionOptions options);
+
+    LoadedRom load(const std::string& path);
+    LoadedRom load(const std::vector<uint8_t>& rom, const std::string& path);
+    const std::optional<LoadedRom>& current() const { return current_; }
+
+    static IpfController make_ipf_controller(int ipf, const SessionOptions& options);
+
+private:
+    std::shared_ptr<Chip> chip_;
+    Platform& platform_;
+    RomDatabase database_;
+    bool database_loaded_;
+    SessionOptions options_;
+    std::optional<LoadedRom> current_;
+};
+
+} // Chip8
+
+#endif //SESSION_H
@@ -0,0 +1,103 @@
+#include "ipf_controller.h"
+
+#include <algorithm>
+
+namespace Chip8 {
+    IpfController::IpfController(Mode mode, unsigned ipf, unsigned min_ipf, unsigned max_ipf) :
+    mode_(mode),
+    ipf_(ipf),
+    base_ipf_(ipf),
+    min_ipf_(min_ipf),
+    max_ipf_(max_ipf)
+    {
+    }
+
+    IpfController IpfController::fixed(unsigned ipf) {
+        return IpfController(Mode::FIXED, ipf, ipf, ipf);
+    }
+
+    IpfController IpfController::adaptive(unsigned ipf, unsigned min_ipf, unsigned max_ipf) {
+        return IpfController(Mode::ADAPTIVE, std::clamp(ipf, min_ipf, max_ipf), min_ipf, max_ipf);
+    }
+
+    /**
+     * @param instructions_per_second Target rate, e.g. 700 for COSMAC VIP-like speed.
+     * @param frame_hz Frames per second the budgets are spread over.
+     */
+    IpfController IpfController::ips(unsigned instructions_per_second, unsigned frame_hz) {
+        IpfController controller(Mode::IPS, instructions_per_second / frame_hz, 0, instructions_per_second);
+        controller.ips_ = instructions_per_second;
+        controller.frame_hz_ = frame_hz;
+        return controller;
+    }
+
+    /**
+     * @brief Instructions to run in the frame that is about to start.
+     */
+    unsigned IpfController::next_budget() {
+        if (mode_ == Mode::IPS) {
+            remainder_ += ips_;
+            ipf_ = remainder_ / frame_hz_;
+            remainder_ %= frame_hz_;
+        }
+        return ipf_;
+    }
+
+    /**
+     * @brief Feeds back how the frame went; ADAPTIVE decides every WINDOW_FRAMES frames.
+     */
+    void IpfController::end_frame(const FrameReport& report) {
+        if (mode_ != Mode::ADAPTIVE) return;
+
+        // The host falling behind is handled right away, the ROM pattern per window
+        if (report.host_load > HIGH_LOAD) {
+            ipf_ = std::max(min_ipf_, ipf_ * 3 / 4);
+            frames_ = synced_frames_ = starved_frames_ = peak_work_ = 0;
+            peak_load_ = 0.0;
+            return;
+        }
+        if (report.stalled) return;
+
+        frames_++;
+        peak_load_ = std::max(peak_load_, report.host_load);
+        if (report.timer_polls > 0) {
+            unsigned spin = report.timer_polls * SPIN_LOOP_LENGTH;
+            synced_frames_++;
+            timer_paced_ = true;
+            peak_work_ = std::max(peak_work_, report.budget > spin ? report.budget - spin : 1u);
+        }
+        else if (report.timer_sets > 0 && timer_paced_) {
+            // armed the timer but never got back to waiting on it
+            starved_frames_++;
+            peak_work_ = std::max(peak_work_, report.budget);
+        }
+        // frames that neither wait on nor arm the timer say nothing about pacing
+
+        if (frames_ >= WINDOW_FRAMES) decide();
+    }
+
+    void IpfController::decide() {
+        unsigned target = ipf_;
+        if (!timer_paced_) {
+            target = base_ipf_;                             // free-running: IPF is its speed
+        }
+        else if (synced_frames_ == 0 && starved_frames_ == 0) {
+            target = ipf_;                                  // not using the timer right now
+        }
+        else if (starved_frames_ > 0) {
+            starved_ipf_ = std::max(starved_ipf_, ipf_);
+            target = ipf_ + ipf_ / 4 + 1;                   // lagging behind its own timer
+        }
+        else {
+            // trim the spinning, at most by half per window and never back to a starving IPF
+            target = std::max({peak_work_ + peak_work_ / 2 + 1, ipf_ / 2, starved_ipf_ + starved_ipf_ / 4 + 1});
+            target = std::min(target, ipf_);
+        }
+
+        if (target > ipf_ && peak_load_ >= LOW_LOAD) target = ipf_;    // no headroom to grow
+        ipf_ = std::clamp(target, min_ipf_, max_ipf_);
+
+        frames_ = synced_frames_ = starved_frames_ = peak_work_ = 0;
+        peak_load_ = 0.0;
+    }
+} // Chip8
@@ -0,0 +1,83 @@
+#ifndef IPF_CONTROLLER_H
+#define IPF_CONTROLLER_H
+
+#include <cstdint>
+
+namespace Chip8 {
+
+/**
+ * What happened during one frame, as far as speed tuning is concerned.
+ */
+struct FrameReport {
+    unsigned budget;            // instructions the frame was allowed to run
+    uint32_t timer_polls;       // FX07 reads that found the delay timer still running
+    uint32_t timer_sets;        // FX15 writes
+    bool stalled;               // parked on FX0A or in the debugger, nothing to learn
+    double host_load;           // busy time / frame period, 0 when frames are not paced
+};
+
+/**
+ * Decides how many instructions each frame runs.
+ *
+ * FIXED runs the configured IPF. IPS spreads an instructions-per-second target over
+ * 60 Hz frames, carrying the remainder so the long-term rate is exact. ADAPTIVE starts
+ * at the configured IPF and moves within [min, max]:
+ *
+ *  - ROMs that pace themselves on the delay timer (FX07 spin loops) get enough budget
+ *    for their busiest recent frame plus a margin, and more whenever a frame arms the
+ *    timer (FX15) but runs out of budget before waiting on it. Their speed does not
+ *    depend on IPF.
+ *  - ROMs that never wait on the timer are speed-sensitive and stay at the configured
+ *    IPF.
+ *  - Either kind is throttled when the host cannot finish a frame within its period.
+ *
+ * Only timer polls feed the ROM side, so headless runs (host_load 0) stay deterministic.
+ */
+class IpfController {
+public:
+    enum class Mode { FIXED, ADAPTIVE, IPS };
+
+    static IpfController fixed(unsigned ipf);
+    static IpfController adaptive(unsigned ipf, unsigned min_ipf, unsigned max_ipf);
+    static IpfController ips(unsigned instructions_per_second, unsigned frame_hz);
+
+    unsigned next_budget();
+    void end_frame(const FrameReport& report);
+
+    Mode mode() const { return mode_; }
+    unsigned ipf() const { return ipf_; }
+
+private:
+    static constexpr unsigned WINDOW_FRAMES = 30;       // frames per adaptive decision
+    static constexpr unsigned SPIN_LOOP_LENGTH = 3;     // FX07, 3X00, 1NNN
+    static constexpr double HIGH_LOAD = 0.9;            // back off above this share of the period
+    static constexpr double LOW_LOAD = 0.6;             // only speed up below it
+
+    IpfController(Mode mode, unsigned ipf, unsigned min_ipf, unsigned max_ipf);
+    void decide();
+
+    Mode mode_;
+    unsigned ipf_;
+    unsigned base_ipf_;         // configured IPF, where free-running ROMs stay
+    unsigned min_ipf_;
+    unsigned max_ipf_;
+
+    // IPS mode
+    unsigned ips_{0};
+    unsigned frame_hz_{60};
+    unsigned remainder_{0};
+
+    // current adaptive window
+    unsigned frames_{0};
+    unsigned synced_frames_{0};     // frames that spun on the delay timer
+    unsigned starved_frames_{0};    // frames that armed the timer but ran out of budget first
+    unsigned peak_work_{0};         // most instructions a frame needed before its wait
+    double peak_load_{0.0};
+
+    bool timer_paced_{false};       // the ROM has been seen spinning on the delay timer (sticky)
+    unsigned starved_ipf_{0};       // highest IPF a timer-paced frame ran out of budget at
+};
+
+} // Chip8
+
+#endif //IPF_CONTROLLER_H
@@ -0,0 +1,213 @@
+#include "latency_probe.h"
+
+#include <algorithm>
+#include <format>
+#include <random>
+
+#include <SDL_events.h>
+
+#include "../log/log.h"
+
+namespace Chip8 {
+    namespace {
+        constexpr std::chrono::milliseconds HOLD{100};          // key down this long per press
+        constexpr std::chrono::milliseconds MIN_GAP{250};       // between resolved presses
+        constexpr std::chrono::milliseconds MAX_GAP{400};       // random: lands at every frame phase
+
+        double ms(std::chrono::steady_clock::duration duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+
+        /**
+         * @brief Nearest-rank percentile of sorted values.
+         */
+        double percentile(const std::vector<double>& sorted, double p) {
+            if (sorted.empty()) return 0.0;
+            std::size_t rank = static_cast<std::size_t>(p / 100.0 * static_cast<double>(sorted.size()) + 0.999999);
+            return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+        }
+    }
+
+    /**
+     * @param chip8_key        CHIP-8 key to press (0x0-0xF).
+     * @param samples          Presses to measure before finished() turns true.
+     * @param lookahead_frames How far the counterfactual runs; presses without a visible
+     *                         effect by then are counted but not measured.
+     */
+    LatencyProbe::LatencyProbe(uint8_t chip8_key, unsigned samples, unsigned lookahead_frames) :
+    chip8_key_(chip8_key),
+    target_samples_(samples),
+    lookahead_frames_(lookahead_frames)
+    {
+        samples_.reserve(samples);
+    }
+
+    LatencyProbe::~LatencyProbe() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        if (injector_.joinable())
+            injector_.join();
+    }
+
+    /**
+     * @brief Starts injecting presses of host_key, the host key mapped to chip8_key.
+     */
+    void LatencyProbe::start(SDL_Keycode host_key) {
+        host_key_ = host_key;
+        injector_ = std::thread(&LatencyProbe::injector_loop, this);
+    }
+
+    void LatencyProbe::injector_loop() {
+        std::mt19937 rng(std::random_device{}());
+        std::uniform_int_distribution<int> gap_us(MIN_GAP.count() * 1000, MAX_GAP.count() * 1000);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stopping_) {
+            if (cv_.wait_for(lock, std::chrono::microseconds{gap_us(rng)}, [this] { return stopping_; }))
+                return;
+
+            pending_ = true;
+            injected_at_ = Clock::now();
+            push_key(SDL_KEYDOWN);
+            if (cv_.wait_for(lock, HOLD, [this] { return stopping_; }))
+                return;
+            push_key(SDL_KEYUP);
+
+            // next press only once this one is measured, so samples never overlap
+            cv_.wait(lock, [this] { return stopping_ || !pending_; });
+        }
+    }
+
+    void LatencyProbe::push_key(uint32_t type) {
+        SDL_Event event{};
+        event.type = type;
+        event.key.type = type;
+        event.key.state = type == SDL_KEYDOWN ? SDL_PRESSED : SDL_RELEASED;
+        event.key.keysym.sym = host_key_;
+        if (SDL_PushEvent(&event) < 0)
+            LOG_WARN(PLATFORM, "latency probe could not push a key event: {}", SDL_GetError());
+    }
+
+    /**
+     * @brief Whether a key down dequeued by read_input is the probe's press.
+     */
+    bool LatencyProbe::is_probe_press(SDL_Keycode key) const {
+        if (key != host_key_ || state_ != State::IDLE)
+            return false;
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_;
+    }
+
+    /**
+     * @brief read_input dequeued the press; the Platform fills expected_hashes() next.
+     */
+    void LatencyProbe::on_seen() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            current_.injected = injected_at_;
+        }
+        current_.seen = Clock::now();
+        position_ = 0;
+        state_ = State::TRACKING;
+    }
+
+    void LatencyProbe::discard() {
+        finish_sample(false);
+    }
+
+    /**
+     * @brief Compares the next instruction slot of the real run with the counterfactual.
+     *
+     * @return true on the first slot that differs (the press became visible).
+     */
+    bool LatencyProbe::check(uint64_t framebuffer_hash) {
+        if (state_ != State::TRACKING)
+            return false;
+        if (position_ >= expected_.size()) {
+            finish_sample(false);
+            return false;
+        }
+        if (expected_[position_++] == framebuffer_hash)
+            return false;
+        current_.drawn = Clock::now();
+        state_ = State::DRAWN;
+        return true;
+    }
+
+    /**
+     * @brief Like check, for run-ahead frames: slot counts from the real run's position
+     * and nothing advances unless the press shows up there first.
+     */
+    bool LatencyProbe::check_ahead(std::size_t slot, uint64_t framebuffer_hash) {
+        if (state_ != State::TRACKING || position_ + slot >= expected_.size()
+            || expected_[position_ + slot] == framebuffer_hash)
+            return false;
+        current_.drawn = Clock::now();
+        state_ = State::DRAWN;
+        return true;
+    }
+
+    /**
+     * @brief A frame was presented; completes the sample if it shows the press.
+     */
+    void LatencyProbe::on_present() {
+        if (state_ != State::DRAWN)
+            return;
+        current_.presented = Clock::now();
+        finish_sample(true);
+    }
+
+    void LatencyProbe::finish_sample(bool visible) {
+        if (visible)
+            samples_.push_back(current_);
+        else
+            invisible_++;
+        state_ = State::IDLE;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ = false;
+        }
+        cv_.notify_all();
+    }
+
+    bool LatencyProbe::finished() const {
+        return samples_.size() >= target_samples_;
+    }
+
+    /**
+     * @brief Percentile table of every stage, in milliseconds.
+     */
+    std::string LatencyProbe::report() const {
+        struct Stage {
+            const char* name;
+            Clock::time_point Sample::*from;
+            Clock::time_point Sample::*to;
+        };
+        constexpr Stage STAGES[] = {
+            {"event queue (inject -> seen)", &Sample::injected, &Sample::seen},
+            {"emulation (seen -> drawn)", &Sample::seen, &Sample::drawn},
+            {"display (drawn -> presented)", &Sample::drawn, &Sample::presented},
+            {"input to photon", &Sample::injected, &Sample::presented},
+        };
+
+        std::string text = std::format(">>> Input latency, key {:X}: {} samples, {} presses without visible effect within {} frames\n",
+            chip8_key_, samples_.size(), invisible_, lookahead_frames_);
+        text += std::format("    {:<30} {:>8} {:>8} {:>8} {:>8}  (ms)\n", "", "p50", "p90", "p99", "max");
+        for (const Stage& stage : STAGES) {
+            std::vector<double> values;
+            values.reserve(samples_.size());
+            for (const Sample& sample : samples_) {
+                values.push_back(ms(sample.*stage.to - sample.*stage.from));
+            }
+            std::sort(values.begin(), values.end());
+            text += std::format("    {:<30} {:>8.2f} {:>8.2f} {:>8.2f} {:>8.2f}\n", stage.name,
+                percentile(values, 50), percentile(values, 90), percentile(values, 99),
+                values.empty() ? 0.0 : values.back());
+        }
+        return text;
+    }
+
+} // Chip8
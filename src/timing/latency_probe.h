@@ -0,0 +1,100 @@
+#ifndef LATENCY_PROBE_H
+#define LATENCY_PROBE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SDL_keyboard.h>
+
+namespace Chip8 {
+
+/**
+ * Input-to-photon latency harness.
+ *
+ * A background thread pushes synthetic key presses into the SDL event queue at random
+ * phases relative to the frame, so they travel the same path as real keys (the
+ * per-instruction SDL_PollEvent in Platform::read_input). For each press:
+ *
+ *  - injected: SDL_PushEvent was called
+ *  - seen:     read_input dequeued it and set the key
+ *  - drawn:    the first instruction whose framebuffer differs from a counterfactual
+ *              run of the same machine without the press (the first DXYN the key
+ *              actually affected, not just the next draw)
+ *  - presented: the frame showing it was handed to the display (present returned)
+ *
+ * The counterfactual is filled by the Platform when the key is seen: it checkpoints the
+ * Chip, runs lookahead_frames frames with the key up recording the framebuffer hash
+ * after every instruction slot, and rolls back. The real run is then compared slot by
+ * slot. This needs a fixed IPF and no other input while probing.
+ */
+class LatencyProbe {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Sample {
+        Clock::time_point injected;
+        Clock::time_point seen;
+        Clock::time_point drawn;
+        Clock::time_point presented;
+    };
+
+    LatencyProbe(uint8_t chip8_key, unsigned samples, unsigned lookahead_frames = 30);
+    ~LatencyProbe();
+    LatencyProbe(const LatencyProbe&) = delete;
+    LatencyProbe& operator=(const LatencyProbe&) = delete;
+
+    void start(SDL_Keycode host_key);  // SDL must be up: pushes events from its own thread
+
+    uint8_t chip8_key() const { return chip8_key_; }
+    unsigned lookahead_frames() const { return lookahead_frames_; }
+
+    // emulation thread
+    bool is_probe_press(SDL_Keycode key) const;
+    void on_seen();
+    void discard();                     // seen where it cannot be tracked (no ROM, debugger)
+    std::vector<uint64_t>& expected_hashes() { return expected_; }
+    bool tracking() const { return state_ == State::TRACKING; }
+    bool check(uint64_t framebuffer_hash);
+    bool check_ahead(std::size_t slot, uint64_t framebuffer_hash);
+    void on_present();
+    bool finished() const;
+
+    std::string report() const;
+
+private:
+    enum class State { IDLE, INJECTED, TRACKING, DRAWN };
+
+    void injector_loop();
+    void push_key(uint32_t type);
+    void finish_sample(bool visible);
+
+    const uint8_t chip8_key_;
+    const unsigned target_samples_;
+    const unsigned lookahead_frames_;
+    SDL_Keycode host_key_{SDLK_UNKNOWN};
+
+    // emulation thread only
+    State state_{State::IDLE};
+    Sample current_{};
+    std::vector<uint64_t> expected_;    // counterfactual framebuffer hash per instruction slot
+    std::size_t position_{0};
+    std::vector<Sample> samples_;
+    unsigned invisible_{0};             // presses with no effect within lookahead_frames
+
+    // shared with the injector
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool pending_{false};               // a press is in flight, not yet resolved
+    Clock::time_point injected_at_;
+    bool stopping_{false};
+    std::thread injector_;
+};
+
+} // Chip8
+
+#endif //LATENCY_PROBE_H
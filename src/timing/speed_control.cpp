@@ -0,0 +1,97 @@
+#include "speed_control.h"
+
+#include <algorithm>
+#include <format>
+
+namespace Chip8 {
+    /**
+     * @brief Parses a CLI speed: a multiplier with an optional trailing x, or "unlimited".
+     *
+     * @return std::nullopt if the text is not a multiplier within [min, max].
+     */
+    std::optional<SpeedControl> SpeedControl::parse(const std::string& text) {
+        SpeedControl speed;
+        if (text == "unlimited" || text == "max") {
+            speed.set_unlimited();
+            return speed;
+        }
+
+        std::string number = text;
+        if (!number.empty() && (number.back() == 'x' || number.back() == 'X'))
+            number.pop_back();
+        try {
+            std::size_t used = 0;
+            double multiplier = std::stod(number, &used);
+            if (used != number.size() || !(multiplier >= min_multiplier && multiplier <= max_multiplier))
+                return std::nullopt;
+            speed.set(multiplier);
+            return speed;
+        }
+        catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+
+    void SpeedControl::set(double multiplier) {
+        multiplier_ = std::clamp(multiplier, min_multiplier, max_multiplier);
+        unlimited_ = false;
+        owed_ = 0.0;
+    }
+
+    void SpeedControl::set_unlimited() {
+        unlimited_ = true;
+        owed_ = 0.0;
+    }
+
+    /**
+     * @brief Next step up the ladder; past the top is unlimited.
+     */
+    void SpeedControl::faster() {
+        if (unlimited_) return;
+        auto next = std::upper_bound(steps.begin(), steps.end(), multiplier_);
+        if (next == steps.end())
+            set_unlimited();
+        else
+            set(*next);
+    }
+
+    /**
+     * @brief Next step down the ladder; unlimited drops to the top step.
+     */
+    void SpeedControl::slower() {
+        if (unlimited_) {
+            set(steps.back());
+            return;
+        }
+        auto below = std::lower_bound(steps.begin(), steps.end(), multiplier_);
+        if (below != steps.begin())
+            set(*(below - 1));
+    }
+
+    std::string SpeedControl::name() const {
+        return unlimited_ ? "unlimited" : std::format("{:g}x", multiplier_);
+    }
+
+    /**
+     * @brief Emulated frames the next host frame runs: the multiplier, with fractions
+     * carried over so 1.5x alternates 1 and 2. At most 1 below 1x (the tick is stretched instead).
+     */
+    int SpeedControl::frames_this_tick() {
+        if (multiplier_ <= 1.0)
+            return 1;
+        owed_ += multiplier_;
+        const int frames = static_cast<int>(owed_);
+        owed_ -= frames;
+        return frames;
+    }
+
+    /**
+     * @brief Wall-clock length of a host frame: the frame period, stretched below 1x.
+     */
+    std::chrono::microseconds SpeedControl::tick_period(std::chrono::microseconds frame_period) const {
+        if (unlimited_ || multiplier_ >= 1.0)
+            return frame_period;
+        return std::chrono::microseconds{static_cast<int64_t>(frame_period.count() / multiplier_)};
+    }
+
+} // Chip8
@@ -0,0 +1,49 @@
+#ifndef SPEED_CONTROL_H
+#define SPEED_CONTROL_H
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <string>
+
+namespace Chip8 {
+
+/**
+ * Emulation speed relative to real time, independent of IPF.
+ *
+ * Speed changes how many emulated frames run per wall-clock second, never what a frame
+ * is: every emulated frame still runs its IPF budget and ticks the timers once, so the
+ * game sees the same 60 Hz it always does. Above 1x several frames are emulated per
+ * host frame and only the last one is drawn; below 1x the host frame is stretched.
+ * Unlimited emulates as many frames as fit in one display refresh.
+ */
+class SpeedControl {
+public:
+    static constexpr double min_multiplier = 0.25;
+    static constexpr double max_multiplier = 16.0;
+    static constexpr std::array<double, 7> steps{0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0};    // hotkey ladder
+
+    static std::optional<SpeedControl> parse(const std::string& text);     // "2", "0.5x", "unlimited"
+
+    void set(double multiplier);        // clamped to [min, max]
+    void set_unlimited();
+    void faster();
+    void slower();
+
+    bool unlimited() const { return unlimited_; }
+    bool normal() const { return !unlimited_ && multiplier_ == 1.0; }
+    double multiplier() const { return multiplier_; }
+    std::string name() const;
+
+    int frames_this_tick();     // emulated frames for the next host frame (not for unlimited)
+    std::chrono::microseconds tick_period(std::chrono::microseconds frame_period) const;
+
+private:
+    double multiplier_{1.0};
+    bool unlimited_{false};
+    double owed_{0.0};          // fractional frames carried between host frames (e.g. 1.5x)
+};
+
+} // Chip8
+
+#endif //SPEED_CONTROL_H
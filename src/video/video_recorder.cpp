@@ -0,0 +1,395 @@
+#include "video_recorder.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+namespace Chip8 {
+    namespace {
+        std::ofstream open_output(const std::string& path) {
+            std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!out.is_open())
+                throw std::runtime_error(std::format("Could not open {} for video recording", path));
+            return out;
+        }
+
+        uint8_t red(uint32_t argb)   { return (argb >> 16) & 0xFFu; }
+        uint8_t green(uint32_t argb) { return (argb >> 8) & 0xFFu; }
+        uint8_t blue(uint32_t argb)  { return argb & 0xFFu; }
+
+        /**
+         * YUV4MPEG2 stream, 4:4:4 so single pixels keep their color after scaling.
+         * A repeated frame reuses the already converted planes.
+         */
+        class Y4mEncoder final : public FrameEncoder {
+        public:
+            Y4mEncoder(const std::string& path, int width, int height, const Compositor::Palette& palette)
+                : out_(open_output(path)), planes_(static_cast<std::size_t>(width) * height * 3) {
+                for (std::size_t i = 0; i < palette.size(); i++) {
+                    // BT.601 limited range
+                    double r = red(palette[i]), g = green(palette[i]), b = blue(palette[i]);
+                    yuv_[i][0] = static_cast<uint8_t>(16.5 + (65.481 * r + 128.553 * g + 24.966 * b) / 255.0);
+                    yuv_[i][1] = static_cast<uint8_t>(128.5 + (-37.797 * r - 74.203 * g + 112.0 * b) / 255.0);
+                    yuv_[i][2] = static_cast<uint8_t>(128.5 + (112.0 * r - 93.786 * g - 18.214 * b) / 255.0);
+                }
+                out_ << std::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C444\n", width, height, VideoRecorder::frame_rate);
+            }
+
+            void write(const std::vector<uint8_t>& indices, uint32_t frames) override {
+                const std::size_t plane_size = indices.size();
+                for (std::size_t i = 0; i < plane_size; i++) {
+                    const std::array<uint8_t, 3>& color = yuv_[indices[i]];
+                    planes_[i] = color[0];
+                    planes_[plane_size + i] = color[1];
+                    planes_[2 * plane_size + i] = color[2];
+                }
+                for (uint32_t f = 0; f < frames; f++) {
+                    out_ << "FRAME\n";
+                    out_.write(reinterpret_cast<const char*>(planes_.data()), static_cast<std::streamsize>(planes_.size()));
+                }
+            }
+
+            void finish() override { out_.flush(); }
+
+        private:
+            std::ofstream out_;
+            std::array<std::array<uint8_t, 3>, 4> yuv_{};
+            std::vector<uint8_t> planes_;
+        };
+
+        /**
+         * Headerless rgb24 frames at 60 Hz.
+         */
+        class RawEncoder final : public FrameEncoder {
+        public:
+            RawEncoder(const std::string& path, int width, int height, const Compositor::Palette& palette)
+                : out_(open_output(path)), palette_(palette), rgb_(static_cast<std::size_t>(width) * height * 3) {}
+
+            void write(const std::vector<uint8_t>& indices, uint32_t frames) override {
+                for (std::size_t i = 0; i < indices.size(); i++) {
+                    uint32_t color = palette_[indices[i]];
+                    rgb_[i * 3] = red(color);
+                    rgb_[i * 3 + 1] = green(color);
+                    rgb_[i * 3 + 2] = blue(color);
+                }
+                for (uint32_t f = 0; f < frames; f++) {
+                    out_.write(reinterpret_cast<const char*>(rgb_.data()), static_cast<std::streamsize>(rgb_.size()));
+                }
+            }
+
+            void finish() override { out_.flush(); }
+
+        private:
+            std::ofstream out_;
+            Compositor::Palette palette_;
+            std::vector<uint8_t> rgb_;
+        };
+
+        /**
+         * Animated GIF89a with a global 4-color table and LZW-coded frames.
+         *
+         * GIF delays are in 1/100 s and viewers slow down anything under 2/100 s, so a
+         * frame shorter than that is replaced by the next one, which inherits its start
+         * time. Total duration stays exact; the effective rate is capped at 50 fps.
+         */
+        class GifEncoder final : public FrameEncoder {
+        public:
+            GifEncoder(const std::string& path, int width, int height, const Compositor::Palette& palette)
+                : out_(open_output(path)), width_(width), height_(height) {
+                out_.write("GIF89a", 6);
+                write_u16(width);
+                write_u16(height);
+                out_.put(static_cast<char>(0xF1));  // global color table, 8-bit color resolution, 4 entries
+                out_.put(0);                        // background color index
+                out_.put(0);                        // square pixels
+                for (uint32_t color : palette) {
+                    out_.put(static_cast<char>(red(color)));
+                    out_.put(static_cast<char>(green(color)));
+                    out_.put(static_cast<char>(blue(color)));
+                }
+                // NETSCAPE2.0 application extension: loop forever
+                const char loop[] = {'\x21', '\xFF', '\x0B', 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E',
+                                     '2', '.', '0', '\x03', '\x01', '\x00', '\x00', '\x00'};
+                out_.write(loop, sizeof(loop));
+            }
+
+            void write(const std::vector<uint8_t>& indices, uint32_t frames) override {
+                if (has_pending_) {
+                    uint32_t delay = centiseconds(ticks_) - centiseconds(pending_start_);
+                    if (delay >= min_delay) {
+                        write_image(pending_, delay);
+                        pending_start_ = ticks_;
+                    }
+                }
+                else {
+                    pending_start_ = ticks_;
+                }
+                pending_ = indices;
+                has_pending_ = true;
+                ticks_ += frames;
+            }
+
+            void finish() override {
+                if (has_pending_) {
+                    uint32_t delay = centiseconds(ticks_) - centiseconds(pending_start_);
+                    write_image(pending_, std::max(delay, min_delay));
+                    has_pending_ = false;
+                }
+                out_.put(0x3B); // trailer
+                out_.flush();
+            }
+
+        private:
+            static constexpr uint32_t min_delay = 2;
+            static constexpr int min_code_size = 2;     // 4 colors
+            static constexpr int max_code = 4095;
+
+            static uint32_t centiseconds(uint64_t ticks) {
+                return static_cast<uint32_t>((ticks * 100 + VideoRecorder::frame_rate / 2) / VideoRecorder::frame_rate);
+            }
+
+            void write_u16(uint32_t value) {
+                out_.put(static_cast<char>(value & 0xFFu));
+                out_.put(static_cast<char>((value >> 8) & 0xFFu));
+            }
+
+            void write_image(const std::vector<uint8_t>& indices, uint32_t delay) {
+                // graphic control extension: no disposal, no transparency
+                out_.put(0x21);
+                out_.put(static_cast<char>(0xF9));
+                out_.put(4);
+                out_.put(0);
+                write_u16(std::min<uint32_t>(delay, 0xFFFF));
+                out_.put(0);
+                out_.put(0);
+
+                // image descriptor covering the whole screen, global palette
+                out_.put(0x2C);
+                write_u16(0);
+                write_u16(0);
+                write_u16(width_);
+                write_u16(height_);
+                out_.put(0);
+
+                out_.put(min_code_size);
+                lzw_encode(indices);
+                out_.put(0);    // end of image data
+            }
+
+            void put_code(int code, int code_size) {
+                bit_buffer_ |= static_cast<uint32_t>(code) << bit_count_;
+                bit_count_ += code_size;
+                while (bit_count_ >= 8) {
+                    put_byte(static_cast<uint8_t>(bit_buffer_ & 0xFFu));
+                    bit_buffer_ >>= 8;
+                    bit_count_ -= 8;
+                }
+            }
+
+            void put_byte(uint8_t byte) {
+                block_[block_size_++] = byte;
+                if (block_size_ == 255) flush_block();
+            }
+
+            void flush_block() {
+                if (block_size_ == 0) return;
+                out_.put(static_cast<char>(block_size_));
+                out_.write(reinterpret_cast<const char*>(block_.data()), block_size_);
+                block_size_ = 0;
+            }
+
+            void lzw_encode(const std::vector<uint8_t>& indices) {
+                const int clear_code = 1 << min_code_size;
+                int code_size = min_code_size + 1;
+                int last_code = clear_code + 1;         // end-of-information, new codes follow
+                for (auto& entry : dictionary_) entry.fill(0);
+
+                bit_buffer_ = 0;
+                bit_count_ = 0;
+                put_code(clear_code, code_size);
+
+                int current = -1;
+                for (uint8_t index : indices) {
+                    if (current < 0) {
+                        current = index;
+                    }
+                    else if (dictionary_[current][index] != 0) {
+                        current = dictionary_[current][index];
+                    }
+                    else {
+                        put_code(current, code_size);
+                        dictionary_[current][index] = static_cast<uint16_t>(++last_code);
+                        if (last_code >= (1 << code_size)) code_size++;
+                        if (last_code == max_code) {
+                            put_code(clear_code, code_size);
+                            for (auto& entry : dictionary_) entry.fill(0);
+                            code_size = min_code_size + 1;
+                            last_code = clear_code + 1;
+                        }
+                        current = index;
+                    }
+                }
+                put_code(current, code_size);
+                put_code(clear_code, code_size);
+                put_code(clear_code + 1, min_code_size + 1);
+                if (bit_count_ > 0) put_byte(static_cast<uint8_t>(bit_buffer_ & 0xFFu));
+                flush_block();
+            }
+
+            std::ofstream out_;
+            int width_;
+            int height_;
+
+            uint64_t ticks_{0};             // 60 Hz frames written so far
+            std::vector<uint8_t> pending_;
+            uint64_t pending_start_{0};
+            bool has_pending_{false};
+
+            std::array<std::array<uint16_t, 4>, max_code + 1> dictionary_{}; // code -> next code per color
+            uint32_t bit_buffer_{0};
+            int bit_count_{0};
+            std::array<uint8_t, 255> block_{};
+            int block_size_{0};
+        };
+    }
+
+    /**
+     * @brief Picks the container from the file extension (.y4m, .raw/.rgb, .gif).
+     */
+    std::optional<VideoFormat> video_format_from_path(const std::string& path) {
+        std::string::size_type dot = path.rfind('.');
+        if (dot == std::string::npos) return std::nullopt;
+        std::string extension = path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        if (extension == "y4m") return VideoFormat::Y4M;
+        if (extension == "raw" || extension == "rgb") return VideoFormat::RAW;
+        if (extension == "gif") return VideoFormat::GIF;
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Opens the output file and starts the encoder thread.
+     *
+     * @param path Output file.
+     * @param format Container to write.
+     * @param scale Integer upscale applied to the 64x32 framebuffer.
+     * @param palette Colors of the four plane combinations.
+     * @throws std::runtime_error if the file cannot be opened or scale is out of range.
+     */
+    VideoRecorder::VideoRecorder(const std::string& path, VideoFormat format, int scale,
+        const Compositor::Palette& palette) : scale_(scale) {
+        if (scale < 1 || scale > 32)
+            throw std::runtime_error("video scale must be between 1 and 32");
+
+        const int width = Compositor::width * scale;
+        const int height = Compositor::height * scale;
+        switch (format) {
+            case VideoFormat::Y4M:
+                encoder_ = std::make_unique<Y4mEncoder>(path, width, height, palette);
+                break;
+            case VideoFormat::RAW:
+                encoder_ = std::make_unique<RawEncoder>(path, width, height, palette);
+                break;
+            case VideoFormat::GIF:
+                encoder_ = std::make_unique<GifEncoder>(path, width, height, palette);
+                break;
+        }
+        worker_ = std::thread(&VideoRecorder::worker_loop, this);
+    }
+
+    VideoRecorder::~VideoRecorder() {
+        finish();
+    }
+
+    /**
+     * @brief Records the current framebuffer as the next 60 Hz frame.
+     *
+     * Called from the emulation thread; an unchanged framebuffer only bumps a counter.
+     *
+     * @param gfx Framebuffer of the chip.
+     */
+    void VideoRecorder::push_frame(const Chip::Gfx& gfx) {
+        frames_recorded_++;
+        if (pending_ && *pending_ == gfx) {
+            pending_repeat_++;
+            return;
+        }
+        flush_pending();
+        pending_ = gfx;
+        pending_repeat_ = 1;
+    }
+
+    /**
+     * @brief Queues the pending frame, waiting only if the queue is full.
+     */
+    void VideoRecorder::flush_pending() {
+        if (!pending_) return;
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        queue_cv_.wait(lock, [this] { return queue_.size() < max_queued_frames; });
+        queue_.push_back({*pending_, pending_repeat_});
+        pending_.reset();
+        lock.unlock();
+        queue_cv_.notify_all();
+    }
+
+    /**
+     * @brief Drains the queue, closes the container and joins the worker. Idempotent.
+     */
+    void VideoRecorder::finish() {
+        if (!worker_.joinable()) return;
+        flush_pending();
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            stopping_ = true;
+        }
+        queue_cv_.notify_all();
+        worker_.join();
+        encoder_->finish();
+    }
+
+    uint64_t VideoRecorder::frames_recorded() const {
+        return frames_recorded_;
+    }
+
+    uint64_t VideoRecorder::frames_encoded() const {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        return frames_encoded_;
+    }
+
+    /**
+     * @brief Worker thread: scales each queued framebuffer to palette indices and encodes it.
+     */
+    void VideoRecorder::worker_loop() {
+        const int width = Compositor::width * scale_;
+        std::vector<uint8_t> indices(static_cast<std::size_t>(width) * Compositor::height * scale_);
+
+        while (true) {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return !queue_.empty() || stopping_; });
+            if (queue_.empty()) return;     // stopping and drained
+            QueuedFrame frame = queue_.front();
+            queue_.pop_front();
+            lock.unlock();
+            queue_cv_.notify_all();         // room for the emulation thread
+
+            for (int y = 0; y < Compositor::height; y++) {
+                uint8_t* row = indices.data() + static_cast<std::size_t>(y) * scale_ * width;
+                for (int x = 0; x < Compositor::width; x++) {
+                    std::memset(row + x * scale_, frame.gfx[x][y] & 0x3u, scale_);
+                }
+                for (int copy = 1; copy < scale_; copy++) {
+                    std::memcpy(row + copy * width, row, width);
+                }
+            }
+            encoder_->write(indices, frame.repeat);
+
+            lock.lock();
+            frames_encoded_ += frame.repeat;
+        }
+    }
+} // Chip8
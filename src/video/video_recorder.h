@@ -0,0 +1,95 @@
+#ifndef VIDEO_RECORDER_H
+#define VIDEO_RECORDER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../gui/compositor.h"
+#include "../hardware/chip.h"
+
+namespace Chip8 {
+
+enum class VideoFormat : uint8_t {
+    Y4M,    // YUV4MPEG2 4:4:4, streams straight into ffmpeg
+    RAW,    // headerless rgb24 frames (ffmpeg -f rawvideo -pix_fmt rgb24)
+    GIF     // animated GIF with the 4-color palette, like the demos in src/public
+};
+
+std::optional<VideoFormat> video_format_from_path(const std::string& path);
+
+/**
+ * Encodes palette-index frames into one container format.
+ * Runs on the recorder's worker thread only.
+ */
+class FrameEncoder {
+public:
+    virtual ~FrameEncoder() = default;
+    /**
+     * @param indices Row-major palette indices (0-3), width * height of the source.
+     * @param frames  Number of 60 Hz frames this image stays on screen.
+     */
+    virtual void write(const std::vector<uint8_t>& indices, uint32_t frames) = 0;
+    virtual void finish() = 0;
+};
+
+/**
+ * Records the framebuffer once per emulated frame to a video file.
+ *
+ * The emulation thread only compares the new framebuffer against the previous one
+ * (2 KB) and queues it when it changed; identical frames just extend the duration of
+ * the queued one. Scaling, color conversion and encoding happen on a worker thread.
+ * The queue is bounded, so the emulator only waits if the encoder falls far behind.
+ */
+class VideoRecorder {
+public:
+    static constexpr int frame_rate = 60;
+    static constexpr std::size_t max_queued_frames = 1024;
+
+    VideoRecorder(const std::string& path, VideoFormat format, int scale,
+        const Compositor::Palette& palette = Compositor::default_palette);
+    ~VideoRecorder();
+
+    void push_frame(const Chip::Gfx& gfx);
+    void finish();
+
+    uint64_t frames_recorded() const;
+    uint64_t frames_encoded() const;
+
+private:
+    struct QueuedFrame {
+        Chip::Gfx gfx;
+        uint32_t repeat;
+    };
+
+    void flush_pending();
+    void worker_loop();
+
+    std::unique_ptr<FrameEncoder> encoder_;
+    int scale_;
+
+    // emulation thread only
+    std::optional<Chip::Gfx> pending_;
+    uint32_t pending_repeat_{0};
+    uint64_t frames_recorded_{0};
+
+    // shared with the worker
+    mutable std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<QueuedFrame> queue_;
+    bool stopping_{false};
+    uint64_t frames_encoded_{0};
+
+    std::thread worker_;
+};
+
+} // Chip8
+
+#endif //VIDEO_RECORDER_H
@@ -0,0 +1,413 @@
+/**
+ * @file chip8_recompile.cpp
+ * @brief Ahead-of-time recompiler: turns a CHIP-8 ROM into C++ for the Aot runtime.
+ *
+ * Usage: chip8_recompile <rom> <output.cpp> [--quirks vip|schip|xochip]
+ *
+ * The ROM is disassembled by following control flow from 0x200 (jumps, calls, both
+ * sides of every skip, the instruction after a call). Contiguous discovered
+ * instructions become one C++ function with a label per instruction, so jumps and
+ * loops inside it are plain gotos. Simple opcodes are emitted inline against the Chip
+ * state with the same arithmetic as Instructions<Quirks>; drawing, memory block
+ * transfers, audio and undefined opcodes call the interpreter for that
+ * one instruction, which keeps the result bit-exact. Indirect jumps (BNNN, 00EE) leave
+ * the function and are resolved at run time; addresses never discovered run on the
+ * interpreter. Stores that land on compiled code switch the program to the interpreter.
+ *
+ * Build the emulator with -DCHIP8_AOT_SOURCE=<output.cpp> to link the result in.
+ */
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../src/database/sha1.h"
+#include "../src/hardware/chip.h"
+#include "../src/hardware/quirks.h"
+
+namespace {
+    constexpr uint16_t ROM_START = Chip8::Chip::rom_start_addr;
+    constexpr std::size_t MAX_RUN_LENGTH = 1024;    // instructions per generated function
+
+    struct QuirkFlags {
+        bool shift_uses_vy;
+        bool jump_uses_vx;
+        bool logic_resets_vf;
+        bool xo_chip_opcodes;
+    };
+
+    template<typename Quirks>
+    constexpr QuirkFlags flags_of() {
+        return {Quirks::shift_uses_vy, Quirks::jump_uses_vx, Quirks::logic_resets_vf, Quirks::xo_chip_opcodes};
+    }
+
+    QuirkFlags quirk_flags(Chip8::QuirkProfile profile) {
+        switch (profile) {
+            case Chip8::QuirkProfile::VIP: return flags_of<Chip8::VipQuirks>();
+            case Chip8::QuirkProfile::SCHIP: return flags_of<Chip8::SchipQuirks>();
+            case Chip8::QuirkProfile::XOCHIP: return flags_of<Chip8::XoChipQuirks>();
+        }
+        return flags_of<Chip8::SchipQuirks>();
+    }
+
+    const char* profile_enum(Chip8::QuirkProfile profile) {
+        switch (profile) {
+            case Chip8::QuirkProfile::VIP: return "Chip8::QuirkProfile::VIP";
+            case Chip8::QuirkProfile::SCHIP: return "Chip8::QuirkProfile::SCHIP";
+            case Chip8::QuirkProfile::XOCHIP: return "Chip8::QuirkProfile::XOCHIP";
+        }
+        return "Chip8::QuirkProfile::SCHIP";
+    }
+
+    enum class Flow {
+        Next,       // falls through to the next instruction
+        Skip,       // conditional skip: next or the one after
+        Jump,       // 1NNN
+        Call,       // 2NNN
+        Return,     // 00EE
+        Indirect,   // BNNN
+        Wait        // FX0A: leave so the runtime can stop on the key wait
+    };
+
+    struct Instruction {
+        uint16_t opcode;
+        uint16_t length;    // 4 for F000 NNNN
+        Flow flow;
+        uint16_t target;    // jump/call target or skip destination
+    };
+
+    class Recompiler {
+    public:
+        Recompiler(std::vector<uint8_t> rom, Chip8::QuirkProfile profile)
+            : rom_(std::move(rom)), profile_(profile), quirks_(quirk_flags(profile)) {}
+
+        void discover();
+        std::string generate() const;
+        std::size_t instruction_count() const { return code_.size(); }
+
+    private:
+        bool in_rom(uint32_t addr, uint32_t length) const {
+            return addr >= ROM_START && addr + length <= ROM_START + rom_.size();
+        }
+        uint16_t word(uint16_t addr) const {
+            return static_cast<uint16_t>((rom_[addr - ROM_START] << 8) | rom_[addr - ROM_START + 1]);
+        }
+        Instruction decode(uint16_t addr) const;
+        std::string emit(uint16_t addr, const Instruction& instr, const std::set<uint16_t>& run) const;
+        std::string transfer(uint32_t target, const std::set<uint16_t>& run) const;
+
+        std::vector<uint8_t> rom_;
+        Chip8::QuirkProfile profile_;
+        QuirkFlags quirks_;
+        std::map<uint16_t, Instruction> code_;
+    };
+
+    Instruction Recompiler::decode(uint16_t addr) const {
+        const uint16_t op = word(addr);
+        const uint16_t nnn = op & 0x0FFFu;
+        Instruction instr{op, 2, Flow::Next, 0};
+
+        auto skip_target = [&] {
+            uint32_t next = addr + 2u;
+            uint16_t next_length = (quirks_.xo_chip_opcodes && in_rom(next, 2)
+                && word(static_cast<uint16_t>(next)) == 0xF000u) ? 4 : 2;
+            return static_cast<uint16_t>(next + next_length);
+        };
+
+        switch (op >> 12) {
+            case 0x0:
+                if ((op & 0xFu) == 0xEu) instr.flow = Flow::Return;   // dispatched on the low nibble
+                break;
+            case 0x1:
+                instr.flow = Flow::Jump;
+                instr.target = nnn;
+                break;
+            case 0x2:
+                instr.flow = Flow::Call;
+                instr.target = nnn;
+                break;
+            case 0x3: case 0x4: case 0x9:
+                instr.flow = Flow::Skip;
+                instr.target = skip_target();
+                break;
+            case 0x5:
+                if ((op & 0xFu) == 0x0u) {
+                    instr.flow = Flow::Skip;
+                    instr.target = skip_target();
+                }
+                break;
+            case 0xB:
+                instr.flow = Flow::Indirect;
+                break;
+            case 0xE:
+                if ((op & 0xFu) == 0x1u || (op & 0xFu) == 0xEu) {
+                    instr.flow = Flow::Skip;
+                    instr.target = skip_target();
+                }
+                break;
+            case 0xF:
+                if (op == 0xF000u && quirks_.xo_chip_opcodes) instr.length = 4;
+                if ((op & 0xFFu) == 0x0Au) instr.flow = Flow::Wait;
+                break;
+            default:
+                break;
+        }
+        return instr;
+    }
+
+    void Recompiler::discover() {
+        std::deque<uint32_t> worklist{ROM_START};
+        while (!worklist.empty()) {
+            uint32_t addr = worklist.front();
+            worklist.pop_front();
+            if (!in_rom(addr, 2) || code_.contains(static_cast<uint16_t>(addr))) continue;
+
+            Instruction instr = decode(static_cast<uint16_t>(addr));
+            if (!in_rom(addr, instr.length)) continue;
+            code_.emplace(static_cast<uint16_t>(addr), instr);
+
+            switch (instr.flow) {
+                case Flow::Next:
+                case Flow::Wait:
+                    worklist.push_back(addr + instr.length);
+                    break;
+                case Flow::Skip:
+                    worklist.push_back(addr + 2);
+                    worklist.push_back(instr.target);
+                    break;
+                case Flow::Jump:
+                    worklist.push_back(instr.target);
+                    break;
+                case Flow::Call:
+                    worklist.push_back(instr.target);
+                    worklist.push_back(addr + 2);     // where 00EE comes back to
+                    break;
+                case Flow::Return:
+                case Flow::Indirect:
+                    break;
+            }
+        }
+    }
+
+    /**
+     * @brief Code that continues at target: a goto inside the run, otherwise a return to the runtime.
+     */
+    std::string Recompiler::transfer(uint32_t target, const std::set<uint16_t>& run) const {
+        if (target <= 0xFFFFu && run.contains(static_cast<uint16_t>(target)))
+            return std::format("goto i_{:04X};", target);
+        return std::format("CHIP8_AOT_EXIT(0x{:04X});", target & 0xFFFFu);
+    }
+
+    std::string Recompiler::emit(uint16_t addr, const Instruction& instr, const std::set<uint16_t>& run) const {
+        const uint16_t op = instr.opcode;
+        const unsigned x = (op >> 8) & 0xFu;
+        const unsigned y = (op >> 4) & 0xFu;
+        const unsigned n = op & 0xFu;
+        const unsigned nn = op & 0xFFu;
+        const unsigned nnn = op & 0xFFFu;
+        const uint32_t next = addr + instr.length;
+
+        // one instruction on the interpreter, PC set as it expects
+        const std::string interpret = std::format(
+            "c.program_ctr = 0x{:04X}; c.instr_dispatcher->interpret_opcode(0x{:04X});", addr, op);
+        // same, for stores that may overwrite compiled code
+        auto interpret_store = [&](const std::string& length) {
+            return std::format("{{ uint16_t i = c.index_reg; {} if (Chip8::Aot::touches_code(PROGRAM, i, {})) "
+                "CHIP8_AOT_INVALIDATE(0x{:04X}); }}", interpret, length, next & 0xFFFFu);
+        };
+        auto skip_if = [&](const std::string& condition) {
+            return std::format("if ({}) {}", condition, transfer(instr.target, run));
+        };
+
+        switch (op >> 12) {
+            case 0x0:
+                if (n == 0xE)
+                    return std::format("c.program_ctr = 0x{:04X}; "
+                        "c.program_ctr = static_cast<uint16_t>(Chip8::MemoryAccess::pop(c, 0x00EE) + 2); "
+                        "budget = left; return true;", addr);
+                return interpret;                                       // 00E0 and undefined
+            case 0x1:
+                return transfer(nnn, run);
+            case 0x2:
+                return std::format("c.program_ctr = 0x{:04X}; Chip8::MemoryAccess::push(c, 0x{:04X}, 0x{:04X}); {}",
+                    addr, op, addr, transfer(nnn, run));
+            case 0x3:
+                return skip_if(std::format("V[{}] == 0x{:02X}", x, nn));
+            case 0x4:
+                return skip_if(std::format("V[{}] != 0x{:02X}", x, nn));
+            case 0x5:
+                if (n == 0x0) return skip_if(std::format("V[{}] == V[{}]", x, y));
+                if (n == 0x2 && quirks_.xo_chip_opcodes) return interpret_store(std::format("{}", (x > y ? x - y : y - x) + 1));
+                return interpret;                                       // 5XY3, undefined
+            case 0x6:
+                return std::format("V[{}] = 0x{:02X};", x, nn);
+            case 0x7:
+                return std::format("V[{}] = static_cast<uint8_t>(V[{}] + 0x{:02X});", x, x, nn);
+            case 0x8: {
+                const std::string reset_vf = quirks_.logic_resets_vf ? " V[15] = 0;" : "";
+                const unsigned src = quirks_.shift_uses_vy ? y : x;
+                switch (n) {
+                    case 0x0: return std::format("V[{}] = V[{}];", x, y);
+                    case 0x1: return std::format("V[{}] = static_cast<uint8_t>(V[{}] | V[{}]);{}", x, x, y, reset_vf);
+                    case 0x2: return std::format("V[{}] = static_cast<uint8_t>(V[{}] & V[{}]);{}", x, x, y, reset_vf);
+                    case 0x3: return std::format("V[{}] = static_cast<uint8_t>(V[{}] ^ V[{}]);{}", x, x, y, reset_vf);
+                    case 0x4: return std::format("{{ uint16_t s = V[{}] + V[{}]; V[{}] = s & 0xFFu; V[15] = s > 255; }}", x, y, x);
+                    case 0x5: return std::format("{{ uint8_t vx = V[{}], vy = V[{}]; V[{}] = static_cast<uint8_t>(vx - vy); V[15] = vx >= vy; }}", x, y, x);
+                    case 0x6: return std::format("{{ uint8_t v = V[{}]; V[{}] = v >> 1; V[15] = v & 0x1u; }}", src, x);
+                    case 0x7: return std::format("{{ uint8_t vx = V[{}], vy = V[{}]; V[{}] = static_cast<uint8_t>(vy - vx); V[15] = vy >= vx; }}", x, y, x);
+                    case 0xE: return std::format("{{ uint8_t v = V[{}]; V[{}] = static_cast<uint8_t>(v << 1); V[15] = v >> 7; }}", src, x);
+                    default: return interpret;
+                }
+            }
+            case 0x9:
+                return skip_if(std::format("V[{}] != V[{}]", x, y));
+            case 0xA:
+                return std::format("c.index_reg = 0x{:03X};", nnn);
+            case 0xB:
+                return std::format("CHIP8_AOT_EXIT(0x{:03X} + V[{}]);", nnn, quirks_.jump_uses_vx ? x : 0);
+            case 0xC:
+                return std::format("V[{}] = static_cast<uint8_t>(c.get_random_number() & 0x{:02X});", x, nn);
+            case 0xD:
+                return interpret;
+            case 0xE:
+                if (n == 0xE) return skip_if(std::format("c.is_key_pressed(V[{}])", x));
+                if (n == 0x1) return skip_if(std::format("!c.is_key_pressed(V[{}])", x));
+                return interpret;
+            case 0xF:
+                if (!quirks_.xo_chip_opcodes && (nn == 0x00 || nn == 0x01 || nn == 0x02 || nn == 0x3A))
+                    return interpret;                                   // undefined outside XO-CHIP
+                if (op == 0xF000u)
+                    return std::format("c.index_reg = 0x{:04X};", word(static_cast<uint16_t>(addr + 2)));
+                switch (nn) {
+                    case 0x01: return std::format("c.plane_mask = 0x{:X};", x & 0x3u);
+                    case 0x07: return std::format("V[{}] = c.delay_timer; c.delay_timer_polls += (c.delay_timer != 0);", x);
+                    case 0x0A: return std::format("c.set_waiting_register({}); CHIP8_AOT_EXIT(0x{:04X});", x, next & 0xFFFFu);
+                    case 0x15: return std::format("c.delay_timer = V[{}]; c.delay_timer_sets++;", x);
+                    case 0x18: return std::format("c.sound_timer = V[{}];", x);
+                    case 0x1E: return std::format("c.index_reg += V[{}];", x);
+                    case 0x29: return std::format("c.index_reg = static_cast<uint16_t>(c.font_start_address + V[{}] * 5);", x);
+                    case 0x33: return interpret_store("3");
+                    case 0x55: return interpret_store(std::format("{}", x + 1));
+                    default: return interpret;                          // F002, FX3A, FX65, undefined
+                }
+            default:
+                return interpret;
+        }
+    }
+
+    std::string Recompiler::generate() const {
+        // contiguous runs of discovered instructions, capped in length
+        std::vector<std::vector<uint16_t>> runs;
+        uint32_t expected = 0;
+        for (const auto& [addr, instr] : code_) {
+            if (runs.empty() || addr != expected || runs.back().size() >= MAX_RUN_LENGTH)
+                runs.emplace_back();
+            runs.back().push_back(addr);
+            expected = addr + instr.length;
+        }
+
+        std::string out;
+        out += "// Generated by chip8_recompile. Do not edit.\n";
+        out += std::format("// {} instructions in {} runs, quirks {}\n\n", code_.size(), runs.size(),
+            Chip8::quirk_profile_name(profile_));
+        out += "#include \"aot/aot_runtime.h\"\n\nnamespace {\n";
+
+        // code map: one bit per byte covered by a compiled instruction, plus (XO-CHIP) the word
+        // after each skip, whose F000 check was resolved at compile time
+        std::vector<uint64_t> code_map;
+        for (const auto& [addr, instr] : code_) {
+            const uint32_t end = addr + instr.length
+                + (instr.flow == Flow::Skip && quirks_.xo_chip_opcodes ? 2u : 0u);
+            for (uint32_t byte = addr; byte < end && byte < Chip8::Chip::memory_size; byte++) {
+                if (code_map.size() <= (byte >> 6)) code_map.resize((byte >> 6) + 1, 0);
+                code_map[byte >> 6] |= uint64_t{1} << (byte & 63u);
+            }
+        }
+        out += "    constexpr uint64_t CODE_MAP[] = {";
+        for (std::size_t i = 0; i < code_map.size(); i++) {
+            out += (i % 4 == 0) ? "\n        " : " ";
+            out += std::format("0x{:016X}ull,", code_map[i]);
+        }
+        out += "\n    };\n\n";
+
+        out += "    Chip8::Aot::BlockFn lookup(uint16_t pc);\n\n";
+        const std::string sha = Chip8::sha1_to_hex(Chip8::sha1(rom_.data(), rom_.size()));
+        out += std::format("    const Chip8::Aot::Program PROGRAM{{\"{}\", {}, lookup, CODE_MAP, {}}};\n\n",
+            sha, profile_enum(profile_), code_map.size());
+
+        for (const std::vector<uint16_t>& run : runs) {
+            const std::set<uint16_t> labels(run.begin(), run.end());
+            out += std::format("    bool run_{:04X}(Chip8::Chip& c, int& budget) {{\n", run.front());
+            out += "        std::array<uint8_t, 16>& V = c.registers;\n";
+            out += "        int left = budget;\n";
+            out += "        switch (c.program_ctr) {\n";
+            for (uint16_t addr : run) out += std::format("            case 0x{:04X}: goto i_{:04X};\n", addr, addr);
+            out += "            default: return true;\n        }\n";
+            for (uint16_t addr : run) {
+                const Instruction& instr = code_.at(addr);
+                out += std::format("    i_{:04X}: CHIP8_AOT_STEP(0x{:04X});    // {:04X}\n", addr, addr, instr.opcode);
+                out += "        " + emit(addr, instr, labels) + "\n";
+            }
+            const Instruction& last = code_.at(run.back());
+            out += std::format("        CHIP8_AOT_EXIT(0x{:04X});\n    }}\n\n", (run.back() + last.length) & 0xFFFFu);
+        }
+
+        out += "    Chip8::Aot::BlockFn lookup(uint16_t pc) {\n        switch (pc) {\n";
+        for (const std::vector<uint16_t>& run : runs) {
+            for (uint16_t addr : run) out += std::format("            case 0x{:04X}:\n", addr);
+            out += std::format("                return run_{:04X};\n", run.front());
+        }
+        out += "            default:\n                return nullptr;\n        }\n    }\n}\n\n";
+        out += "const Chip8::Aot::Program* Chip8::Aot::compiled_program() {\n    return &PROGRAM;\n}\n";
+        return out;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3 && argc != 5) {
+        std::cerr << "Usage: " << argv[0] << " <rom> <output.cpp> [--quirks vip|schip|xochip]" << std::endl;
+        return 1;
+    }
+
+    Chip8::QuirkProfile profile = Chip8::QuirkProfile::SCHIP;
+    if (argc == 5) {
+        std::optional<Chip8::QuirkProfile> parsed = Chip8::parse_quirk_profile(argv[4]);
+        if (std::string(argv[3]) != "--quirks" || !parsed) {
+            std::cerr << "Error: --quirks must be one of vip, schip, xochip" << std::endl;
+            return 1;
+        }
+        profile = *parsed;
+    }
+
+    std::ifstream rom_file(argv[1], std::ios::in | std::ios::binary);
+    if (!rom_file.is_open()) {
+        std::cerr << "Error: could not open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(rom_file)), std::istreambuf_iterator<char>());
+    if (rom.empty() || rom.size() > Chip8::Chip::max_rom_size) {
+        std::cerr << "Error: ROM is empty or does not fit in memory" << std::endl;
+        return 1;
+    }
+
+    Recompiler recompiler(std::move(rom), profile);
+    recompiler.discover();
+
+    std::ofstream out(argv[2], std::ios::out | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Error: could not open " << argv[2] << std::endl;
+        return 1;
+    }
+    out << recompiler.generate();
+    std::cout << std::format("Compiled {} instructions of {} to {}", recompiler.instruction_count(), argv[1], argv[2]) << std::endl;
+    return 0;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file trace_decode.cpp
+ * @brief Prints an execution trace written by TraceBuffer (--trace, F12 or crash dump).
+ *
+ * Usage: chip8_trace_decode <trace file> [last N records]
+ */
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/hardware/trace_buffer.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <trace file> [last N records]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream file(argv[1], std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: could not open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    Chip8::TraceHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || std::memcmp(header.magic, "C8TR", 4) != 0) {
+        std::cerr << "Error: not a CHIP-8 trace file" << std::endl;
+        return 1;
+    }
+    if (header.byte_order != Chip8::TraceBuffer::BYTE_ORDER_MARK) {
+        std::cerr << "Error: trace was written on a machine with a different byte order" << std::endl;
+        return 1;
+    }
+    if (header.version != Chip8::TraceBuffer::FORMAT_VERSION) {
+        std::cerr << "Error: unsupported trace version " << header.version << std::endl;
+        return 1;
+    }
+
+    std::vector<Chip8::TraceRecord> records(header.count);
+    file.read(reinterpret_cast<char*>(records.data()),
+        static_cast<std::streamsize>(records.size() * sizeof(Chip8::TraceRecord)));
+    records.resize(static_cast<std::size_t>(file.gcount()) / sizeof(Chip8::TraceRecord));  // truncated dump
+
+    std::size_t skip = 0;
+    if (argc == 3) {
+        std::size_t last = std::stoul(argv[2]);
+        if (last < records.size()) skip = records.size() - last;
+    }
+
+    const uint64_t first_sequence = header.total - header.count;
+    std::printf("%llu instructions traced, %zu in file\n",
+        static_cast<unsigned long long>(header.total), records.size());
+    std::printf("%12s  %-6s %-6s %-6s %-7s %s\n", "#", "PC", "OP", "I", "VX", "VF");
+    for (std::size_t i = skip; i < records.size(); i++) {
+        const Chip8::TraceRecord& record = records[i];
+        std::printf("%12llu  %04X   %04X   %04X   V%X=%02X  %02X\n",
+            static_cast<unsigned long long>(first_sequence + i), record.pc, record.opcode, record.index_reg,
+            (record.opcode >> 8) & 0xFu, record.vx, record.vf);
+    }
+    return 0;
+}